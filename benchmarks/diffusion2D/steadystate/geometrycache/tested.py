@@ -0,0 +1,36 @@
+
+import os, shutil
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+# Matrices assembled with geometric factors taken from the geometry cache are compared
+# with matrices assembled without the cache.
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ "etype", 2, 2, 3, 2, 20, 30, "TOTAL_FETI", "geometry cache" ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+@istest
+def by():
+    for etype in [ "SQUARE4", "SQUARE8", "TRIANGLE3", "TRIANGLE6" ]:
+        yield run, etype
+
+def run(etype):
+    ESPRESOTest.args[0] = etype
+
+    uncached = os.path.join(ESPRESOTest.path, "results", "uncached")
+    shutil.rmtree(uncached, ignore_errors=True)
+
+    ESPRESOTest.args[8] = 0
+    ESPRESOTest.run()
+    shutil.copytree(os.path.join(ESPRESOTest.path, "results", "last", "debug"), uncached)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), uncached)
+
+    ESPRESOTest.args[8] = 16
+    ESPRESOTest.run()
+    ESPRESOTest.compare_matrices(uncached, os.path.join(ESPRESOTest.path, "results", "last", "debug"))
+    ESPRESOTest.compare(os.path.join("results", "uncached", "espreso.emr"))
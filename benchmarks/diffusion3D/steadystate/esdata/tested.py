@@ -0,0 +1,73 @@
+
+import os, shutil
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ "WORKBENCH", "FALSE", "method" ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+def workbench(file, n):
+    # the cube [0, 1]^3 discretized by n^3 SOLID185 elements with node components TOP (z = 1) and BOTTOM (z = 0)
+    def node(x, y, z):
+        return 1 + x + y * (n + 1) + z * (n + 1) * (n + 1)
+
+    def cmblock(name, nodes):
+        cdb.write("CMBLOCK,{0},NODE,{1:9d}\n".format(name, len(nodes)))
+        cdb.write("(8i10)\n")
+        for i in range(0, len(nodes), 8):
+            cdb.write("".join("{0:10d}".format(id) for id in nodes[i:i + 8]) + "\n")
+
+    with open(file, "w") as cdb:
+        cdb.write("ET,1,185\n")
+        cdb.write("NBLOCK,6,SOLID,{0:9d},{0:9d}\n".format((n + 1) ** 3))
+        cdb.write("(3i9,6e21.13e3)\n")
+        for z in range(n + 1):
+            for y in range(n + 1):
+                for x in range(n + 1):
+                    cdb.write("{0:9d}{1:9d}{2:9d}{3:21.13E}{4:21.13E}{5:21.13E}\n".format(node(x, y, z), 0, 0, float(x) / n, float(y) / n, float(z) / n))
+        cdb.write("N,R5.3,LOC,{0:9d},\n".format(-1))
+
+        cdb.write("EBLOCK,19,SOLID,{0:9d},{0:9d}\n".format(n ** 3))
+        cdb.write("(19i9)\n")
+        for z in range(n):
+            for y in range(n):
+                for x in range(n):
+                    nodes = [
+                        node(x, y, z), node(x + 1, y, z), node(x + 1, y + 1, z), node(x, y + 1, z),
+                        node(x, y, z + 1), node(x + 1, y, z + 1), node(x + 1, y + 1, z + 1), node(x, y + 1, z + 1) ]
+                    # material, type, real, section, esys, birth, solidref, shape, nodes, unused, id
+                    values = [ 1, 1, 1, 1, 0, 0, 0, 0, 8, 0, 1 + x + y * n + z * n * n ] + nodes
+                    cdb.write("".join("{0:9d}".format(value) for value in values) + "\n")
+        cdb.write("{0:9d}\n".format(-1))
+
+        cmblock("BOTTOM", [ node(x, y, 0) for y in range(n + 1) for x in range(n + 1) ])
+        cmblock("TOP", [ node(x, y, n) for y in range(n + 1) for x in range(n + 1) ])
+
+@istest
+def by():
+    for method in [ "TOTAL_FETI", "HYBRID_FETI" ]:
+        yield run, method
+
+def run(method):
+    results = os.path.join(ESPRESOTest.path, "results")
+    if not os.path.exists(results):
+        os.makedirs(results)
+    workbench(os.path.join(results, "mesh.cdb"), 12)
+
+    ESPRESOTest.args = [ "WORKBENCH", "FALSE", method ]
+    ESPRESOTest.run()
+    shutil.copy(os.path.join(results, "last", "espreso.emr"), os.path.join(results, "workbench.emr"))
+
+    ESPRESOTest.args = [ "WORKBENCH", "TRUE", method ]
+    ESPRESOTest.run()
+    shutil.copy(os.path.join(results, "last", "espreso.esdata"), os.path.join(results, "mesh.esdata"))
+
+    ESPRESOTest.args = [ "ESDATA", "FALSE", method ]
+    ESPRESOTest.run()
+    ESPRESOTest.compare(os.path.join("results", "workbench.emr"))
+    ESPRESOTest.report("espreso.time.xml")
@@ -0,0 +1,38 @@
+
+import os, shutil
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+# Matrices assembled with geometric factors taken from the geometry cache are compared
+# with matrices assembled without the cache.
+# The mesh is morphed before the first assembly, hence the cache has to be filled from
+# the morphed coordinates (the morphing increases NodeStore::coordinatesVersion).
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ "etype", 2, 2, 1, 1, 2, 4, 8, 4, 4, "geometry cache" ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+@istest
+def by():
+    for etype in [ "HEXA8", "TETRA4", "HEXA20", "TETRA10" ]:
+        yield run, etype
+
+def run(etype):
+    ESPRESOTest.args[0] = etype
+
+    uncached = os.path.join(ESPRESOTest.path, "results", "uncached")
+    shutil.rmtree(uncached, ignore_errors=True)
+
+    ESPRESOTest.args[10] = 0
+    ESPRESOTest.run()
+    shutil.copytree(os.path.join(ESPRESOTest.path, "results", "last", "debug"), uncached)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), uncached)
+
+    ESPRESOTest.args[10] = 16
+    ESPRESOTest.run()
+    ESPRESOTest.compare_matrices(uncached, os.path.join(ESPRESOTest.path, "results", "last", "debug"))
+    ESPRESOTest.compare(os.path.join("results", "uncached", "espreso.emr"))
@@ -0,0 +1,39 @@
+
+import os, shutil
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+# Matrices assembled by the general element kernel are compared with matrices
+# assembled by kernels for fixed element sizes (batches of elements in SIMD lanes).
+# A domain has 27 elements (162 tetrahedrons), hence the last batch is not full.
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ "etype", 2, 2, 1, 1, 2, 2, 3, 3, 3, "fixed kernels", "geometry cache" ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+@istest
+def by():
+    for etype in [ "TETRA4", "TETRA10", "HEXA8", "HEXA20" ]:
+        for cache in [ 0, 16 ]:
+            yield run, etype, cache
+
+def run(etype, cache):
+    ESPRESOTest.args[0] = etype
+    ESPRESOTest.args[11] = cache
+
+    general = os.path.join(ESPRESOTest.path, "results", "general")
+    shutil.rmtree(general, ignore_errors=True)
+
+    ESPRESOTest.args[10] = "FALSE"
+    ESPRESOTest.run()
+    shutil.copytree(os.path.join(ESPRESOTest.path, "results", "last", "debug"), general)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), general)
+
+    ESPRESOTest.args[10] = "TRUE"
+    ESPRESOTest.run()
+    ESPRESOTest.compare_matrices(general, os.path.join(ESPRESOTest.path, "results", "last", "debug"))
+    ESPRESOTest.compare(os.path.join("results", "general", "espreso.emr"))
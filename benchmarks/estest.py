@@ -1,5 +1,5 @@
 
-import shutil, os, subprocess, copy
+import shutil, os, re, subprocess, copy
 
 try:
     import requests, git
@@ -93,6 +93,57 @@ class ESPRESOTest:
             for column, (value1, value2) in enumerate(zip(row1, row2)):
                 compare(value1, value2)
 
+    @staticmethod
+    def compare_matrices(preset, current):
+        # compare matrices and vectors printed by PRINT_MATRICES into directories 'preset' and 'current'
+        def compare_file(file1, file2):
+            if not os.path.exists(file2):
+                ESPRESOTest.raise_error("missing matrix: {0}".format(file2))
+
+            lines1 = [ line.split() for line in open(file1, "r").readlines() if len(line.strip()) ]
+            lines2 = [ line.split() for line in open(file2, "r").readlines() if len(line.strip()) ]
+
+            # sparse matrices: 'rows cols nnz' followed by 'row col value', vectors: values
+            indices1, values1, indices2, values2 = [], [], [], []
+            for lines, indices, values in [ (lines1, indices1, values1), (lines2, indices2, values2) ]:
+                sparse = os.path.basename(file1)[0] in "KM"
+                for i, line in enumerate(lines):
+                    if sparse:
+                        indices.extend(line[:3] if i == 0 else line[:2])
+                        values.extend(map(float, [] if i == 0 else line[2:]))
+                    else:
+                        values.extend(map(float, line))
+
+            if indices1 != indices2 or len(values1) != len(values2):
+                ESPRESOTest.raise_error("various patterns of matrices:\n  {0}\n  {1}".format(file1, file2))
+
+            scale = max(map(abs, values1) + [ 1e-300 ])
+            for v1, v2 in zip(values1, values2):
+                if abs(v1 - v2) > 1e-10 * scale:
+                    ESPRESOTest.raise_error("various matrices:\n  {0}\n  {1}\n  preset={2} != current={3}".format(file1, file2, v1, v2))
+
+        matrices = re.compile("^[KMRf][0-9]+\.txt$")
+        files = 0
+        for root, dirs, names in os.walk(preset):
+            for name in filter(matrices.match, names):
+                files += 1
+                compare_file(os.path.join(root, name), os.path.join(current, os.path.relpath(root, preset), name))
+        if files == 0:
+            ESPRESOTest.raise_error("no assembled matrices stored")
+
+    @staticmethod
+    def iterations():
+        # each solve prints the header 'iter |r| r e time[s]' followed by lines of iterations
+        log = os.path.join(ESPRESOTest.path, "results", "last", ESPRESOTest.ecf.replace(".ecf", ".log"))
+        iterations = []
+        for line in open(log, "r").readlines():
+            values = line.split()
+            if values[:2] == [ "iter", "|r|" ]:
+                iterations.append(0)
+            elif len(iterations) and len(values) > 2 and values[0].isdigit():
+                iterations[-1] = int(values[0])
+        return iterations
+
     @staticmethod
     def report(timereport):
         if not ESPRESOTest.has_snailwatch():
@@ -0,0 +1,72 @@
+import os, re, copy
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+# The system stored by the FETI solver (STORE_INSTANCE) is solved again by espreso-feti-bench.
+# The bench has to converge in the same number of iterations to the stored solution (checked by the bench).
+# With more right-hand sides, the bench solves them at once and compares solutions with single solves.
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ "method", "B0 type", "store instance" ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+@istest
+def by():
+    for method, B0_type in [ ("TOTAL_FETI", "KERNELS"), ("HYBRID_FETI", "CORNERS"), ("HYBRID_FETI", "KERNELS") ]:
+        yield run, method, B0_type
+        yield multiple_rhs, method, B0_type, 4
+    yield mismatch, "TOTAL_FETI", "KERNELS", "HYBRID_FETI", "KERNELS", "METHOD"
+    yield mismatch, "HYBRID_FETI", "CORNERS", "HYBRID_FETI", "KERNELS", "B0_TYPE"
+
+def store(method, B0_type):
+    ESPRESOTest.args[0] = method
+    ESPRESOTest.args[1] = B0_type
+    ESPRESOTest.args[2] = "TRUE"
+    ESPRESOTest.run()
+    ESPRESOTest.args[2] = "FALSE"
+    return os.path.join(os.path.realpath(os.path.join(ESPRESOTest.path, "results", "last")), "instance")
+
+def feti_bench(snapshot, *args):
+    program = copy.deepcopy(ESPRESOTest.mpirun)
+    program.append(str(ESPRESOTest.processes))
+    program.append(os.path.join(ESPRESOTest.root, "bin", "espreso-feti-bench"))
+    program.append(snapshot)
+    program.extend(map(str, args))
+    program.extend([ "-c", os.path.join(ESPRESOTest.path, ESPRESOTest.ecf) ])
+    program.extend(map(str, ESPRESOTest.args))
+    return ESPRESOTest.run_program(program)
+
+def run(method, B0_type):
+    snapshot = store(method, B0_type)
+    iterations = ESPRESOTest.iterations()[-1]
+
+    output, error = feti_bench(snapshot, 2)
+    if error != "":
+        ESPRESOTest.raise_error(error)
+    runs = [ int(count) for count in re.findall("Run [0-9]+: update .* s, ([0-9]+) iterations", output) ]
+    if runs != [ iterations, iterations ]:
+        ESPRESOTest.raise_error("iterations of the stored run: {0}, espreso-feti-bench: {1}".format(iterations, runs))
+    if len(re.findall("difference to the stored solution", output)) != 2:
+        ESPRESOTest.raise_error("the solution of the stored run was not compared")
+
+def mismatch(method, B0_type, bench_method, bench_B0_type, option):
+    snapshot = store(method, B0_type)
+
+    ESPRESOTest.args[0] = bench_method
+    ESPRESOTest.args[1] = bench_B0_type
+    output, error = feti_bench(snapshot)
+    if "Set the same {0}".format(option) not in error:
+        ESPRESOTest.raise_error("espreso-feti-bench accepted a snapshot stored with different {0}".format(option))
+
+def multiple_rhs(method, B0_type, rhs):
+    snapshot = store(method, B0_type)
+
+    output, error = feti_bench(snapshot, 1, rhs)
+    if error != "":
+        ESPRESOTest.raise_error(error)
+    if not re.search("{0} RHS: at once .* s, max relative difference of solutions".format(rhs), output):
+        ESPRESOTest.raise_error("espreso-feti-bench did not solve {0} right-hand sides at once".format(rhs))
@@ -6,7 +6,7 @@ from estest import ESPRESOTest
 
 def setup():
     ESPRESOTest.path = os.path.dirname(__file__)
-    ESPRESOTest.args = [ "TOTAL_FETI", "cgsolver", "preconditioner", "regularization" ]
+    ESPRESOTest.args = [ "TOTAL_FETI", "cgsolver", "preconditioner", "regularization", "KERNELS", "coarse problem", "dirichlet mode" ]
 
 def teardown():
     ESPRESOTest.clean()
@@ -14,12 +14,19 @@ def teardown():
 @istest
 def by():
     for cgsolver in [ "PCG", "pipePCG", "orthogonalPCG", "GMRES", "BICGSTAB" ]:
-        for preconditioner in [ "NONE", "LUMPED", "WEIGHT_FUNCTION", "DIRICHLET" ]:
-            for regularization in [ "ANALYTIC", "ALGEBRAIC" ]:
-                yield run, cgsolver, preconditioner, regularization
+        for coarse_problem in [ "INVERSE", "THREE_LEVEL" ]:
+            for preconditioner in [ "NONE", "LUMPED", "WEIGHT_FUNCTION", "DIRICHLET" ]:
+                for regularization in [ "ANALYTIC", "ALGEBRAIC" ]:
+                    if preconditioner == "DIRICHLET":
+                        for dirichlet_mode in [ "EXPLICIT", "IMPLICIT" ]:
+                            yield run, cgsolver, preconditioner, regularization, coarse_problem, dirichlet_mode
+                    else:
+                        yield run, cgsolver, preconditioner, regularization, coarse_problem, "EXPLICIT"
 
-def run(cgsolver, preconditioner, regularization):
+def run(cgsolver, preconditioner, regularization, coarse_problem, dirichlet_mode):
     ESPRESOTest.args[1] = cgsolver
     ESPRESOTest.args[2] = preconditioner
     ESPRESOTest.args[3] = regularization
+    ESPRESOTest.args[5] = coarse_problem
+    ESPRESOTest.args[6] = dirichlet_mode
     ESPRESOTest.run()
@@ -1,12 +1,12 @@
 
-import os
+import os, shutil
 from nose.tools import istest
 
 from estest import ESPRESOTest
 
 def setup():
     ESPRESOTest.path = os.path.dirname(__file__)
-    ESPRESOTest.args = [ "TOTAL_FETI", "cgsolver", "preconditioner", "ALGEBRAIC" ]
+    ESPRESOTest.args = [ "TOTAL_FETI", "cgsolver", "preconditioner", "ALGEBRAIC", "KERNELS", "coarse problem" ]
 
 def teardown():
     ESPRESOTest.clean()
@@ -17,7 +17,22 @@ def by():
         for preconditioner in [ "NONE", "LUMPED", "WEIGHT_FUNCTION", "DIRICHLET" ]:
             yield run, cgsolver, preconditioner
 
+# THREE_LEVEL has to converge as INVERSE (the explicit inverse is used for unsymmetric systems)
 def run(cgsolver, preconditioner):
     ESPRESOTest.args[1] = cgsolver
     ESPRESOTest.args[2] = preconditioner
+
+    inverse = os.path.join(ESPRESOTest.path, "results", "inverse")
+    shutil.rmtree(inverse, ignore_errors=True)
+
+    ESPRESOTest.args[5] = "INVERSE"
+    ESPRESOTest.run()
+    iterations = ESPRESOTest.iterations()
+    os.makedirs(inverse)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), inverse)
+
+    ESPRESOTest.args[5] = "THREE_LEVEL"
     ESPRESOTest.run()
+    if ESPRESOTest.iterations() != iterations:
+        ESPRESOTest.raise_error("various iterations: INVERSE={0}, THREE_LEVEL={1}".format(iterations, ESPRESOTest.iterations()))
+    ESPRESOTest.compare(os.path.join("results", "inverse", "espreso.emr"))
@@ -1,12 +1,11 @@
-
-import os
+import os, shutil
 from nose.tools import istest
 
 from estest import ESPRESOTest
 
 def setup():
     ESPRESOTest.path = os.path.dirname(__file__)
-    ESPRESOTest.args = [ "method", "cgsolver", "preconditioner", "ALGEBRAIC", "B0 type" ]
+    ESPRESOTest.args = [ "method", "cgsolver", "preconditioner", "ALGEBRAIC", "B0 type", "coarse problem" ]
 
 def teardown():
     ESPRESOTest.clean()
@@ -19,9 +18,24 @@ def by():
             for B0_type in [ "CORNERS", "KERNELS" ]:
                 yield run, "HYBRID_FETI", cgsolver, preconditioner, B0_type
 
+# THREE_LEVEL has to converge as INVERSE (the explicit inverse is used for unsymmetric systems)
 def run(method, cgsolver, preconditioner, B0_type):
     ESPRESOTest.args[0] = method
     ESPRESOTest.args[1] = cgsolver
     ESPRESOTest.args[2] = preconditioner
     ESPRESOTest.args[4] = B0_type
+
+    inverse = os.path.join(ESPRESOTest.path, "results", "inverse")
+    shutil.rmtree(inverse, ignore_errors=True)
+
+    ESPRESOTest.args[5] = "INVERSE"
+    ESPRESOTest.run()
+    iterations = ESPRESOTest.iterations()
+    os.makedirs(inverse)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), inverse)
+
+    ESPRESOTest.args[5] = "THREE_LEVEL"
     ESPRESOTest.run()
+    if ESPRESOTest.iterations() != iterations:
+        ESPRESOTest.raise_error("various iterations: INVERSE={0}, THREE_LEVEL={1}".format(iterations, ESPRESOTest.iterations()))
+    ESPRESOTest.compare(os.path.join("results", "inverse", "espreso.emr"))
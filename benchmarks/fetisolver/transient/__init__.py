@@ -0,0 +1,8 @@
+
+from estest import ESPRESOTest
+
+def setup():
+    ESPRESOTest.processes = 4
+    ESPRESOTest.env["OMP_NUM_THREADS"] = "4"
+    ESPRESOTest.env["SOLVER_NUM_THREADS"] = "4"
+    ESPRESOTest.env["PAR_NUM_THREADS"] = "4"
\ No newline at end of file
@@ -0,0 +1,101 @@
+import os, re, shutil
+from nose.tools import istest
+
+from estest import ESPRESOTest
+
+# Time steps are chosen by the automatic time stepping. Long initial steps are rejected,
+# hence the operator is changed several times within the load step.
+
+def setup():
+    ESPRESOTest.path = os.path.dirname(__file__)
+    ESPRESOTest.args = [ 0, "PCG", "FALSE", 0 ]
+
+def teardown():
+    ESPRESOTest.clean()
+
+def reference(args):
+    # results of the solver with default settings
+    reference = os.path.join(ESPRESOTest.path, "results", "reference")
+    shutil.rmtree(reference, ignore_errors=True)
+
+    ESPRESOTest.args = args
+    ESPRESOTest.run()
+    os.makedirs(reference)
+    shutil.copy(os.path.join(ESPRESOTest.path, "results", "last", "espreso.emr"), reference)
+    return os.path.join("results", "reference", "espreso.emr")
+
+# Directions of previous time steps are recycled by PCG, also with the changed operator.
+
+@istest
+def recycling():
+    for recycling_size in [ 1, 5, 20 ]:
+        yield run_recycling, recycling_size
+
+def run_recycling(recycling_size):
+    emr = reference([ 0, "PCG", "FALSE", 0 ])
+
+    ESPRESOTest.args = [ recycling_size, "PCG", "FALSE", 0 ]
+    ESPRESOTest.run()
+    ESPRESOTest.compare(emr)
+
+# The dual solver of each time step (except the first one) starts from the solution
+# of the previous step. Results have to be the same as results of cold starts.
+
+@istest
+def warmstart():
+    for cgsolver in [ "PCG", "pipePCG" ]:
+        yield run_warmstart, cgsolver
+
+def run_warmstart(cgsolver):
+    emr = reference([ 0, cgsolver, "FALSE", 0 ])
+
+    ESPRESOTest.args = [ 0, cgsolver, "TRUE", 0 ]
+    ESPRESOTest.run()
+    ESPRESOTest.compare(emr)
+
+    warmstart = re.compile("Warm start of the dual solver: ([0-9]+) iterations, (-?[0-9]+) iterations saved")
+    log = os.path.join(ESPRESOTest.path, "results", "last", "espreso.log")
+    saved = [ int(match.group(2)) for match in map(warmstart.search, open(log, "r").readlines()) if match ]
+    if len(saved) == 0:
+        ESPRESOTest.raise_error("no warm started solve")
+    if sum(saved) <= 0:
+        ESPRESOTest.raise_error("warm start saved {0} iterations".format(sum(saved)))
+
+# Operators of rejected steps are restored when the step is increased back. Time steps of operators
+# assembled without the cache are replayed by a cache of the solver size (the current operator and
+# CACHED_OPERATORS recently used ones) and the predicted sequence of assembled and restored operators
+# is compared with the solver log.
+
+@istest
+def cachedoperators():
+    for cached in [ 1, 2, 5 ]:
+        yield run_cachedoperators, cached
+
+def operators():
+    event = re.compile("(ASSEMBLE|REUSE) OPERATOR OF TIME STEP \\((.*)\\)")
+    log = os.path.join(ESPRESOTest.path, "results", "last", "espreso.log")
+    return [ match.groups() for match in map(event.search, open(log, "r").readlines()) if match ]
+
+def run_cachedoperators(cached):
+    emr = reference([ 0, "PCG", "FALSE", 0 ])
+    if len([ event for event, step in operators() if event != "ASSEMBLE" ]):
+        ESPRESOTest.raise_error("an operator is restored without the cache")
+    steps = [ step for event, step in operators() ]
+    if len([ step for i, step in enumerate(steps) if step in steps[:i] ]) == 0:
+        ESPRESOTest.raise_error("no time step is repeated: {0}".format(", ".join(steps)))
+
+    cache, expected = [], []
+    for step in steps:
+        if step in cache:
+            expected.append(("REUSE", step))
+            cache.remove(step)
+        else:
+            expected.append(("ASSEMBLE", step))
+        cache = [ step ] + cache[:cached]
+
+    ESPRESOTest.args = [ 0, "PCG", "FALSE", cached ]
+    ESPRESOTest.run()
+    ESPRESOTest.compare(emr)
+    if operators() != expected:
+        ESPRESOTest.raise_error("operators:\n  {0}\nexpected:\n  {1}".format(
+            ", ".join(map(" ".join, operators())), ", ".join(map(" ".join, expected))))
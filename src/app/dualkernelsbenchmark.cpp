@@ -0,0 +1,135 @@
+
+
+#include "../solver/specific/dualkernels.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+using namespace espreso;
+
+// Compares vector operations of one dual CG iteration implemented by separate loops
+// (as they were in IterSolverBase::Solve_RegCG) with the fused kernels.
+// Operations with the operator, the projector and the preconditioner are not included.
+//
+// usage: espreso-dual-kernels-benchmark [iterations] [size ...]
+
+static double separate(size_t size, const std::vector<eslocal> &filter, std::vector<double> &x, std::vector<double> &r,
+		std::vector<double> &w, std::vector<double> &wp, std::vector<double> &y, std::vector<double> &yp,
+		std::vector<double> &p, std::vector<double> &Ap)
+{
+	#pragma omp parallel for
+	for (size_t i = 0; i < size; i++) {
+		wp[i] = w[i];
+		yp[i] = y[i];
+	}
+
+	double yw = 0, ywp = 0;
+	for (size_t i = 0; i < size; i++) {
+		yw += y[i] * w[i] * filter[i];
+	}
+	for (size_t i = 0; i < size; i++) {
+		ywp += yp[i] * wp[i] * filter[i];
+	}
+	double beta = yw / ywp;
+
+	#pragma omp parallel for
+	for (size_t i = 0; i < size; i++) {
+		p[i] = y[i] + beta * p[i];
+	}
+
+	double pAp = 0;
+	for (size_t i = 0; i < size; i++) {
+		pAp += p[i] * Ap[i] * filter[i];
+	}
+	yw = 0;
+	for (size_t i = 0; i < size; i++) {
+		yw += y[i] * w[i] * filter[i];
+	}
+	double alpha = yw / pAp;
+
+	#pragma omp parallel for
+	for (size_t i = 0; i < size; i++) {
+		x[i] = x[i] + alpha * p[i];
+		r[i] = r[i] - alpha * Ap[i];
+	}
+
+	double norm = 0;
+	for (size_t i = 0; i < size; i++) {
+		norm += w[i] * w[i] * filter[i];
+	}
+	return std::sqrt(norm);
+}
+
+static double fused(size_t size, const std::vector<double> &mask, std::vector<double> &x, std::vector<double> &r,
+		std::vector<double> &w, std::vector<double> &y, std::vector<double> &p, std::vector<double> &Ap, double &ywp)
+{
+	double yw, ww;
+	dualDotAndNorm(size, mask.data(), y.data(), w.data(), yw, ww);
+	dualXPBY(size, y.data(), yw / ywp, p.data());
+	ywp = yw;
+
+	double pAp = dualDot(size, mask.data(), p.data(), Ap.data());
+	dualUpdate(size, yw / pAp, p.data(), Ap.data(), x.data(), r.data());
+	return std::sqrt(ww);
+}
+
+int main(int argc, char **argv)
+{
+	size_t iterations = argc > 1 ? std::atol(argv[1]) : 20;
+
+	std::vector<size_t> sizes = { 100000, 1000000, 10000000 };
+	if (argc > 2) {
+		sizes.clear();
+		for (int i = 2; i < argc; i++) {
+			sizes.push_back(std::atol(argv[i]));
+		}
+	}
+
+	printf("%12s %14s %14s %8s %12s\n", "SIZE", "SEPARATE [s]", "FUSED [s]", "SPEEDUP", "MAX. DIFF");
+	for (size_t s = 0; s < sizes.size(); s++) {
+		size_t size = sizes[s];
+
+		std::vector<eslocal> filter(size);
+		std::vector<double> mask(size), w(size), y(size), Ap(size);
+		for (size_t i = 0; i < size; i++) {
+			filter[i] = std::rand() % 4 ? 1 : 0; // about 1/4 of lambdas is owned by neighbours
+			mask[i] = filter[i];
+			w[i] = (double)std::rand() / RAND_MAX;
+			y[i] = w[i] + 0.1 * (double)std::rand() / RAND_MAX;
+			Ap[i] = 2 * y[i];
+		}
+		std::vector<double> wp(size), yp(size), p1(size), p2(size), x1(size), x2(size), r1(size), r2(size);
+		double ywp = 0;
+		for (size_t i = 0; i < size; i++) {
+			ywp += y[i] * w[i] * filter[i];
+		}
+
+		// vectors w, y are kept constant, hence both variants compute the same beta
+		double norm1 = 0, norm2 = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (size_t it = 0; it < iterations; it++) {
+			norm1 = separate(size, filter, x1, r1, w, wp, y, yp, p1, Ap);
+		}
+		double tseparate = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		for (size_t it = 0; it < iterations; it++) {
+			norm2 = fused(size, mask, x2, r2, w, y, p2, Ap, ywp);
+		}
+		double tfused = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		double diff = std::fabs(norm1 - norm2);
+		for (size_t i = 0; i < size; i++) {
+			diff = std::max(diff, std::fabs(x1[i] - x2[i]) / (1 + std::fabs(x1[i])));
+			diff = std::max(diff, std::fabs(r1[i] - r2[i]) / (1 + std::fabs(r1[i])));
+		}
+
+		printf("%12lu %14.6f %14.6f %8.2f %12.3e\n", size, tseparate, tfused, tseparate / tfused, diff);
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+
+#include "../basis/expression/expression.h"
+#include "../basis/expression/compiledexpression.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <string>
+
+using namespace espreso;
+
+// Compares exprtk evaluation (one point per call) with the bytecode evaluation (arrays of points)
+// on expressions used in benchmarks.
+//
+// usage: espreso-expression-benchmark [points] [expression ...]
+
+int main(int argc, char **argv)
+{
+	size_t points = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+	std::vector<std::string> expressions = {
+			"10 - 20 * X",
+			"250 + 100 - Y * 100",
+			"300 - 400 * (0.25 - (0.5 - Y)^2)",
+			"1200 - 1200 * Z",
+			"500 + 100 * TIME",
+			"2 + 5 * (TEMPERATURE/50) * (TEMPERATURE/50)",
+			"2 + 5 * (TEMPERATURE/50) * (TEMPERATURE/50) / 10",
+			"sin(Y * PI / 4)",
+			"X - 300 * sin(Y * PI) - 200 * X",
+			"160 * sin(Y * PI / 2)"
+	};
+	if (argc > 2) {
+		expressions.assign(argv + 2, argv + argc);
+	}
+
+	std::vector<std::string> variables = { "X", "Y", "Z", "TEMPERATURE", "TIME" };
+	std::vector<double> coordinates(3 * points), temperature(points), time(1, 0.5);
+	for (size_t i = 0; i < points; i++) {
+		coordinates[3 * i + 0] = (double)std::rand() / RAND_MAX;
+		coordinates[3 * i + 1] = (double)std::rand() / RAND_MAX;
+		coordinates[3 * i + 2] = (double)std::rand() / RAND_MAX;
+		temperature[i] = 273.15 + 100 * (double)std::rand() / RAND_MAX;
+	}
+
+	const double *values[5] = { coordinates.data(), coordinates.data() + 1, coordinates.data() + 2, temperature.data(), time.data() };
+	eslocal increments[5] = { 3, 3, 3, 1, 0 };
+
+	std::vector<double> exprtk(points), bytecode(points);
+
+	printf("%-50s %12s %12s %8s %12s\n", "EXPRESSION", "EXPRTK [s]", "BYTECODE [s]", "SPEEDUP", "MAX. DIFF");
+	for (size_t e = 0; e < expressions.size(); e++) {
+		Expression expression(expressions[e], variables);
+		CompiledExpression compiled(expressions[e], variables);
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < points; i++) {
+			expression.values[0] = coordinates[3 * i + 0];
+			expression.values[1] = coordinates[3 * i + 1];
+			expression.values[2] = coordinates[3 * i + 2];
+			expression.values[3] = temperature[i];
+			expression.values[4] = time[0];
+			exprtk[i] = expression.evaluate();
+		}
+		double texprtk = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (!compiled.compiled()) {
+			printf("%-50s %12.6f %12s\n", expressions[e].c_str(), texprtk, "unsupported");
+			continue;
+		}
+
+		start = std::chrono::steady_clock::now();
+		compiled.evaluate(points, values, increments, bytecode.data());
+		double tbytecode = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		double diff = 0;
+		for (size_t i = 0; i < points; i++) {
+			diff = std::max(diff, std::fabs(exprtk[i] - bytecode[i]));
+		}
+
+		printf("%-50s %12.6f %12.6f %8.2f %12.3e\n", expressions[e].c_str(), texprtk, tbytecode, texprtk / tbytecode, diff);
+	}
+
+	return 0;
+}
@@ -19,6 +19,7 @@
 #include "../../mesh/preprocessing/meshpreprocessing.h"
 #include "../../output/result/resultstore.h"
 #include "../../output/data/espresobinaryformat.h"
+#include "../../basis/logging/timetrace.h"
 #include "../../solver/generic/FETISolver.h"
 
 
@@ -97,6 +98,7 @@ void ESPRESO::run(int *argc, char ***argv)
 		}
 	}
 	ResultStore::destroyAsynchronizedStore();
+	TimeTrace::finish(Logging::outputRoot());
 }
 
 Factory::Factory(const ECFRoot &configuration, Mesh &mesh, ResultStore &store)
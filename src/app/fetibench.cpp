@@ -0,0 +1,189 @@
+
+#include "mpi.h"
+
+#include "../assembler/instance.h"
+#include "../basis/logging/logging.h"
+#include "../basis/logging/timeeval.h"
+#include "../basis/logging/timetrace.h"
+#include "../config/ecf/root.h"
+#include "../config/ecf/environment.h"
+#include "../solver/generic/FETISolver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace espreso;
+
+// Solves a system stored by the FETI solver with 'store_instance' set to true.
+// The snapshot is restored on the same number of processes, hence neither mesh nor assembler is needed.
+// Options of the FETI solver are taken from the first load step of the physics in the configuration file.
+// Options that change the stored data (METHOD, B0_TYPE) have to be the same as in the stored run.
+//
+// If the snapshot contains the solution of the stored run, solutions of all runs are compared with it.
+//
+// If RHS > 1, the system is also solved with RHS right-hand sides at once (FETISolver::solve(f, solutions))
+// and the solutions are compared with RHS single solves. The first right-hand side is the stored one,
+// the others are its multiples with a deterministic perturbation.
+//
+// usage: espreso-feti-bench SNAPSHOT [REPETITIONS [RHS]] [ESPRESO OPTIONS]
+//        e.g. mpirun -n 4 espreso-feti-bench results/espreso/.../instance 5 -c solver.ecf
+
+static const FETISolverConfiguration& fetiConfiguration(const ECFRoot &configuration)
+{
+	switch (configuration.physics) {
+	case PHYSICS::HEAT_TRANSFER_2D:
+		return configuration.heat_transfer_2d.load_steps_settings.at(1).feti;
+	case PHYSICS::HEAT_TRANSFER_3D:
+		return configuration.heat_transfer_3d.load_steps_settings.at(1).feti;
+	case PHYSICS::STRUCTURAL_MECHANICS_2D:
+		return configuration.structural_mechanics_2d.load_steps_settings.at(1).feti;
+	case PHYSICS::STRUCTURAL_MECHANICS_3D:
+		return configuration.structural_mechanics_3d.load_steps_settings.at(1).feti;
+	default:
+		ESINFO(GLOBAL_ERROR) << "Not supported physics.";
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	if (argc < 2) {
+		if (rank == 0) {
+			printf("usage: espreso-feti-bench SNAPSHOT [REPETITIONS [RHS]] [ESPRESO OPTIONS]\n");
+		}
+		MPI_Finalize();
+		return 0;
+	}
+
+	// the snapshot, repetitions, and right-hand sides are not passed to the configuration reader
+	std::string snapshot = argv[1];
+	int shift = 1;
+	size_t repetitions = 1, rhs = 1;
+	if (argc > 2 && std::atol(argv[2]) > 0) {
+		repetitions = std::atol(argv[2]);
+		shift = 2;
+		if (argc > 3 && std::atol(argv[3]) > 0) {
+			rhs = std::atol(argv[3]);
+			shift = 3;
+		}
+	}
+	argv[shift] = argv[0];
+	argc -= shift;
+	argv += shift;
+
+	ECFRoot configuration(&argc, &argv);
+	Instance *instance = Instance::loadSnapshot(snapshot, fetiConfiguration(configuration));
+	FETISolver solver(instance, fetiConfiguration(configuration));
+	solver.configuration.store_instance = false;
+
+	Matrices matrices =
+			Matrices::K | Matrices::N | Matrices::f |
+			Matrices::B0 | Matrices::B1 | Matrices::B1c | Matrices::B1duplicity;
+
+	std::vector<std::vector<double> > stored;
+	bool compare = Instance::loadSnapshotSolution(snapshot, stored);
+
+	// maximal difference of solutions relative to the maximal value of the reference
+	auto difference = [] (const std::vector<std::vector<double> > &reference, const std::vector<std::vector<double> > &solution) {
+		double difference = 0, norm = 0, gdifference, gnorm;
+		for (size_t d = 0; d < reference.size(); d++) {
+			for (size_t i = 0; i < reference[d].size(); i++) {
+				difference = std::max(difference, std::fabs(reference[d][i] - solution[d][i]));
+				norm = std::max(norm, std::fabs(reference[d][i]));
+			}
+		}
+		MPI_Allreduce(&difference, &gdifference, 1, MPI_DOUBLE, MPI_MAX, environment->MPICommunicator);
+		MPI_Allreduce(&norm, &gnorm, 1, MPI_DOUBLE, MPI_MAX, environment->MPICommunicator);
+		return gnorm > 0 ? gdifference / gnorm : gdifference;
+	};
+
+	TimeEval timing("FETI solver benchmark");
+	TimeEvent update("Update (preprocessing, factorization)"), solve("Solve");
+
+	ESINFO(OVERVIEW) << "Solve instance '" << snapshot << "' " << repetitions << " times.";
+	for (size_t r = 0; r < repetitions; r++) {
+		update.startWithBarrier();
+		solver.update(matrices);
+		update.endWithBarrier();
+
+		solve.startWithBarrier();
+		solver.solve();
+		solve.endWithBarrier();
+
+		ESINFO(OVERVIEW)
+				<< "Run " << r + 1 << ": update " << update.getLastStat() << " s, solve "
+				<< solve.getLastStat() << " s, " << solver.iterations() << " iterations.";
+
+		if (compare) {
+			double relative = difference(stored, instance->primalSolution);
+			ESINFO(OVERVIEW) << "Run " << r + 1 << ": max relative difference to the stored solution " << relative << ".";
+			if (relative > 100 * solver.configuration.precision) {
+				ESINFO(ERROR) << "The solution differs from the solution of the stored run.";
+			}
+		}
+	}
+
+	timing.addEvent(update);
+	timing.addEvent(solve);
+
+	if (rhs > 1) {
+		std::vector<std::vector<std::vector<double> > > f(rhs, instance->f), multi, single(rhs);
+		for (size_t k = 1; k < rhs; k++) {
+			for (size_t d = 0; d < f[k].size(); d++) {
+				for (size_t i = 0; i < f[k][d].size(); i++) {
+					f[k][d][i] = (1 + k) * instance->f[d][i] + k * std::cos(i + k * d + rank);
+				}
+			}
+		}
+
+		TimeEvent multiSolve("Solve multiple RHS"), singleSolve("Solve RHS one by one");
+
+		std::vector<std::vector<std::vector<double> > > multiF = f;
+		multiSolve.startWithBarrier();
+		solver.solve(multiF, multi);
+		multiSolve.endWithBarrier();
+
+		singleSolve.startWithBarrier();
+		for (size_t k = 0; k < rhs; k++) {
+			instance->f = f[k];
+			solver.solve();
+			single[k] = instance->primalSolution;
+		}
+		singleSolve.endWithBarrier();
+		instance->f = f[0];
+
+		double relative = 0;
+		for (size_t k = 0; k < rhs; k++) {
+			relative = std::max(relative, difference(single[k], multi[k]));
+		}
+
+		ESINFO(OVERVIEW)
+				<< rhs << " RHS: at once " << multiSolve.getLastStat() << " s, one by one "
+				<< singleSolve.getLastStat() << " s, max relative difference of solutions " << relative << ".";
+
+		timing.addEvent(multiSolve);
+		timing.addEvent(singleSolve);
+
+		// both solves stop at the same precision (single solutions are also rounded to it)
+		if (relative > 100 * solver.configuration.precision) {
+			ESINFO(ERROR) << "Solutions of multiple right-hand sides differ from solutions of single right-hand sides.";
+		}
+	}
+	timing.printStatsMPI();
+	solver.timeEvalMain.printStatsMPI();
+
+	delete instance;
+	TimeTrace::finish(Logging::outputRoot());
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Finalize();
+	return 0;
+}
@@ -1,18 +1,30 @@
 
 #include "instance.h"
 
+#include "mpi.h"
+
 #include "../mesh/mesh.h"
 #include "../mesh/store/elementstore.h"
 #include "../solver/generic/SparseMatrix.h"
 #include "../basis/logging/logging.h"
+#include "../config/ecf/environment.h"
+#include "../config/ecf/solver/feti.h"
+
+#include <cstdlib>
 
 using namespace espreso;
 
 Instance::Instance(const Mesh &mesh)
-: domains(mesh.elements->ndomains),
+: Instance(mesh.elements->ndomains, mesh.neighbours)
+{
+	clustersMap = mesh.elements->clusters;
+}
+
+Instance::Instance(size_t domains, const std::vector<int> &neighbours)
+: domains(domains),
   domainDOFCount(_domainDOFCount),
-  neighbours(mesh.neighbours),
-  clustersMap(mesh.elements->clusters),
+  neighbours(neighbours),
+  clustersMap(domains, 0),
   origK(_origK), K(_K),
   origKN1(_origKN1), origKN2(_origKN2), origRegMat(_origRegMat),
   N1(_N1), N2(_N2), RegMat(_RegMat),
@@ -265,5 +277,258 @@ Instance::~Instance()
 
 }
 
+namespace {
+
+// the snapshot file starts by the header; data follow in the order of 'storeSnapshot'
+struct SnapshotHeader {
+	char magic[16];
+	int version, eslocalSize, esglobalSize, processes;
+	size_t domains;
+	// options of the FETI solver that were used to compute kernels and B0
+	int method, B0type, regularization;
+};
+
+const char snapshotMagic[16] = "ESPRESOINSTANCE";
+const int snapshotVersion = 2;
+
+const char* methodName[] = { "TOTAL_FETI", "HYBRID_FETI" };
+const char* B0typeName[] = { "CORNERS", "KERNELS" };
+const char* regularizationName[] = { "ANALYTIC", "ALGEBRAIC" };
+
+std::string snapshotFile(const std::string &directory, int rank)
+{
+	return directory + "/instance." + std::to_string(rank) + ".bin";
+}
+
+std::string solutionFile(const std::string &directory, int rank)
+{
+	return directory + "/solution." + std::to_string(rank) + ".bin";
+}
+
+template <typename TType>
+void write(std::ofstream &os, const std::vector<TType> &data)
+{
+	size_t size = data.size();
+	os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
+	os.write(reinterpret_cast<const char*>(data.data()), size * sizeof(TType));
+}
 
+template <typename TType>
+void write(std::ofstream &os, const std::vector<std::vector<TType> > &data)
+{
+	size_t size = data.size();
+	os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
+	for (size_t i = 0; i < data.size(); i++) {
+		write(os, data[i]);
+	}
+}
+
+void write(std::ofstream &os, const std::vector<SparseMatrix> &data)
+{
+	size_t size = data.size();
+	os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
+	for (size_t i = 0; i < data.size(); i++) {
+		int mtype = static_cast<int>(data[i].mtype);
+		os.write(reinterpret_cast<const char*>(&data[i].rows), sizeof(eslocal));
+		os.write(reinterpret_cast<const char*>(&data[i].cols), sizeof(eslocal));
+		os.write(reinterpret_cast<const char*>(&data[i].nnz), sizeof(eslocal));
+		os.write(&data[i].type, sizeof(char));
+		os.write(reinterpret_cast<const char*>(&mtype), sizeof(int));
+		write(os, data[i].I_row_indices);
+		write(os, data[i].J_col_indices);
+		write(os, data[i].V_values);
+		write(os, data[i].CSR_I_row_indices);
+		write(os, data[i].CSR_J_col_indices);
+		write(os, data[i].CSR_V_values);
+		write(os, data[i].dense_values);
+	}
+}
+
+template <typename TType>
+void read(std::ifstream &is, std::vector<TType> &data)
+{
+	size_t size;
+	is.read(reinterpret_cast<char*>(&size), sizeof(size_t));
+	data.resize(size);
+	is.read(reinterpret_cast<char*>(data.data()), size * sizeof(TType));
+}
+
+template <typename TType>
+void read(std::ifstream &is, std::vector<std::vector<TType> > &data)
+{
+	size_t size;
+	is.read(reinterpret_cast<char*>(&size), sizeof(size_t));
+	data.resize(size);
+	for (size_t i = 0; i < data.size(); i++) {
+		read(is, data[i]);
+	}
+}
+
+void read(std::ifstream &is, std::vector<SparseMatrix> &data)
+{
+	size_t size;
+	is.read(reinterpret_cast<char*>(&size), sizeof(size_t));
+	data.resize(size);
+	for (size_t i = 0; i < data.size(); i++) {
+		int mtype;
+		is.read(reinterpret_cast<char*>(&data[i].rows), sizeof(eslocal));
+		is.read(reinterpret_cast<char*>(&data[i].cols), sizeof(eslocal));
+		is.read(reinterpret_cast<char*>(&data[i].nnz), sizeof(eslocal));
+		is.read(&data[i].type, sizeof(char));
+		is.read(reinterpret_cast<char*>(&mtype), sizeof(int));
+		data[i].mtype = static_cast<MatrixType>(mtype);
+		read(is, data[i].I_row_indices);
+		read(is, data[i].J_col_indices);
+		read(is, data[i].V_values);
+		read(is, data[i].CSR_I_row_indices);
+		read(is, data[i].CSR_J_col_indices);
+		read(is, data[i].CSR_V_values);
+		read(is, data[i].dense_values);
+	}
+}
+
+}
+
+void Instance::storeSnapshot(const std::string &directory, const FETISolverConfiguration &configuration) const
+{
+	std::string mkdir = "mkdir -p " + directory;
+	if (system(mkdir.c_str())) {
+		ESINFO(ERROR) << "Cannot create directory '" << directory << "' for the instance snapshot.";
+	}
+
+	std::ofstream os(snapshotFile(directory, environment->MPIrank), std::ofstream::binary);
+	if (!os.is_open()) {
+		ESINFO(ERROR) << "Cannot create file '" << snapshotFile(directory, environment->MPIrank) << "'.";
+	}
+
+	SnapshotHeader header;
+	std::copy(snapshotMagic, snapshotMagic + 16, header.magic);
+	header.version = snapshotVersion;
+	header.eslocalSize = sizeof(eslocal);
+	header.esglobalSize = sizeof(esglobal);
+	header.processes = environment->MPIsize;
+	header.domains = domains;
+	header.method = static_cast<int>(configuration.method);
+	header.B0type = static_cast<int>(configuration.B0_type);
+	header.regularization = static_cast<int>(configuration.regularization);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+
+	write(os, neighbours);
+	write(os, clustersMap);
+	write(os, domainDOFCount);
+
+	write(os, K);
+	write(os, N1);
+	write(os, N2);
+	write(os, RegMat);
+	write(os, origKN1);
+	write(os, origKN2);
+	write(os, f);
+
+	write(os, B0);
+	write(os, B0subdomainsMap);
+	write(os, B1);
+	write(os, B1subdomainsMap);
+	write(os, B1clustersMap);
+	write(os, B1c);
+	write(os, LB);
+	write(os, B1duplicity);
+
+	ESINFO(PROGRESS2) << "Instance snapshot stored to '" << directory << "'.";
+}
+
+Instance* Instance::loadSnapshot(const std::string &directory, const FETISolverConfiguration &configuration)
+{
+	std::ifstream is(snapshotFile(directory, environment->MPIrank), std::ifstream::binary);
+	if (!is.is_open()) {
+		ESINFO(GLOBAL_ERROR) << "Cannot open file '" << snapshotFile(directory, environment->MPIrank) << "'.";
+	}
+
+	SnapshotHeader header;
+	is.read(reinterpret_cast<char*>(&header), sizeof(SnapshotHeader));
+	if (!is.good() || !std::equal(snapshotMagic, snapshotMagic + 16, header.magic) || header.version != snapshotVersion) {
+		ESINFO(GLOBAL_ERROR) << "File '" << snapshotFile(directory, environment->MPIrank) << "' is not an instance snapshot.";
+	}
+	if (header.eslocalSize != sizeof(eslocal) || header.esglobalSize != sizeof(esglobal)) {
+		ESINFO(GLOBAL_ERROR) << "Instance snapshot was stored with different sizes of integers (eslocal: " << header.eslocalSize << ", esglobal: " << header.esglobalSize << ").";
+	}
+	if (header.processes != environment->MPIsize) {
+		ESINFO(GLOBAL_ERROR) << "Instance snapshot was stored by " << header.processes << " processes. Run it on the same number of processes.";
+	}
+	// kernels and B0 are not recomputed, hence options that change them have to be the same
+	if (header.method != static_cast<int>(configuration.method)) {
+		ESINFO(GLOBAL_ERROR) << "Instance snapshot was stored with METHOD " << methodName[header.method] << ". Set the same METHOD.";
+	}
+	if (configuration.method == FETI_METHOD::HYBRID_FETI && header.B0type != static_cast<int>(configuration.B0_type)) {
+		ESINFO(GLOBAL_ERROR) << "Instance snapshot was stored with B0_TYPE " << B0typeName[header.B0type] << ". Set the same B0_TYPE.";
+	}
+	if (header.regularization != static_cast<int>(configuration.regularization)) {
+		ESINFO(ALWAYS_ON_ROOT) << Info::TextColor::YELLOW
+				<< "Instance snapshot was stored with REGULARIZATION " << regularizationName[header.regularization]
+				<< ". Kernels of the snapshot are used instead of REGULARIZATION " << regularizationName[static_cast<int>(configuration.regularization)] << ".";
+	}
+
+	std::vector<int> neighbours;
+	read(is, neighbours);
+
+	Instance *instance = new Instance(header.domains, neighbours);
+	read(is, instance->clustersMap);
+	read(is, instance->domainDOFCount);
+
+	read(is, instance->K);
+	read(is, instance->N1);
+	read(is, instance->N2);
+	read(is, instance->RegMat);
+	read(is, instance->origKN1);
+	read(is, instance->origKN2);
+	read(is, instance->f);
+
+	read(is, instance->B0);
+	read(is, instance->B0subdomainsMap);
+	read(is, instance->B1);
+	read(is, instance->B1subdomainsMap);
+	read(is, instance->B1clustersMap);
+	read(is, instance->B1c);
+	read(is, instance->LB);
+	read(is, instance->B1duplicity);
+
+	if (!is.good()) {
+		ESINFO(GLOBAL_ERROR) << "Instance snapshot '" << snapshotFile(directory, environment->MPIrank) << "' is corrupted.";
+	}
+
+	instance->primalSolution.resize(instance->domains);
+	for (size_t d = 0; d < instance->domains; d++) {
+		instance->primalSolution[d].resize(instance->domainDOFCount[d]);
+	}
+
+	// kernels and B0 are already part of the snapshot
+	instance->computeKernelsCallback = [] (FETI_REGULARIZATION regularization, size_t scSize, bool ortogonalCluster) {};
+	instance->computeKernelsFromOrigKCallback = [] (FETI_REGULARIZATION regularization, size_t scSize, bool ortogonalCluster) {};
+	instance->computeKernelCallback = [] (FETI_REGULARIZATION regularization, size_t scSize, size_t domain, bool ortogonalCluster) {};
+	instance->computeKernelFromOrigKCallback = [] (FETI_REGULARIZATION regularization, size_t scSize, size_t domain, bool ortogonalCluster) {};
+	instance->assembleB0Callback = [] (FETI_B0_TYPE type, const std::vector<SparseMatrix> &kernels) {};
+
+	return instance;
+}
+
+void Instance::storeSnapshotSolution(const std::string &directory) const
+{
+	std::ofstream os(solutionFile(directory, environment->MPIrank), std::ofstream::binary);
+	if (!os.is_open()) {
+		ESINFO(ERROR) << "Cannot create file '" << solutionFile(directory, environment->MPIrank) << "'.";
+	}
+	write(os, primalSolution);
+}
+
+bool Instance::loadSnapshotSolution(const std::string &directory, std::vector<std::vector<double> > &solution)
+{
+	std::ifstream is(solutionFile(directory, environment->MPIrank), std::ifstream::binary);
+	int loaded = is.is_open(), allloaded;
+	if (loaded) {
+		read(is, solution);
+		loaded = is.good();
+	}
+	MPI_Allreduce(&loaded, &allloaded, 1, MPI_INT, MPI_MIN, environment->MPICommunicator);
+	return allloaded;
+}
 
@@ -3,6 +3,7 @@
 #define SRC_ASSEMBLER_INSTANCE_H_
 
 #include <cstddef>
+#include <string>
 #include <vector>
 #include <fstream>
 #include <functional>
@@ -13,6 +14,7 @@ class SparseMatrix;
 class Mesh;
 enum class FETI_REGULARIZATION;
 enum class FETI_B0_TYPE;
+struct FETISolverConfiguration;
 
 enum Matrices : int {
 	NONE        = 0,
@@ -32,9 +34,18 @@ enum Matrices : int {
 struct Instance {
 
 	Instance(const Mesh &mesh);
+	Instance(size_t domains, const std::vector<int> &neighbours);
 	Instance(Instance &other, Matrices &share);
 	~Instance();
 
+	// binary snapshot of data used by the FETI solver (a file per process),
+	// it can be restored only with the same number of processes and options that do not change the data
+	void storeSnapshot(const std::string &directory, const FETISolverConfiguration &configuration) const;
+	static Instance* loadSnapshot(const std::string &directory, const FETISolverConfiguration &configuration);
+	// the primal solution of the stored instance (it is not part of the snapshot, since the snapshot is stored before solving)
+	void storeSnapshotSolution(const std::string &directory) const;
+	static bool loadSnapshotSolution(const std::string &directory, std::vector<std::vector<double> > &solution);
+
 	void computeKernel(FETI_REGULARIZATION regularization, size_t scSize, size_t domain, bool ortogonalCluster = false) { computeKernelCallback(regularization, scSize, domain, ortogonalCluster); }
 	void computeKernelFromOrigK(FETI_REGULARIZATION regularization, size_t scSize, size_t domain, bool ortogonalCluster = false) { computeKernelFromOrigKCallback(regularization, scSize, domain, ortogonalCluster); }
 	void computeKernelsFromOrigK(FETI_REGULARIZATION regularization, size_t scSize, bool ortogonalCluster = false) { computeKernelsFromOrigKCallback(regularization, scSize, ortogonalCluster); }
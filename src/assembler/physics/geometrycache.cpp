@@ -0,0 +1,153 @@
+
+#include "geometrycache.h"
+
+#include "../../basis/containers/serializededata.h"
+#include "../../basis/matrices/denseMatrix.h"
+
+#include "../../mesh/mesh.h"
+#include "../../mesh/elements/element.h"
+#include "../../mesh/store/elementstore.h"
+#include "../../mesh/store/nodestore.h"
+
+#include <algorithm>
+
+using namespace espreso;
+
+GeometryCache::GeometryCache(Mesh *mesh, size_t budget)
+: _mesh(mesh), _memory(0)
+{
+	size_t codes = static_cast<int>(Element::CODE::SIZE);
+	std::vector<size_t> count(codes), size(codes);
+
+	const auto &epointers = _mesh->elements->epointers->datatarray();
+	for (size_t e = 0; e < epointers.size(); e++) {
+		const Element *element = epointers[e];
+		int code = static_cast<int>(element->code);
+		if (element->dN == NULL || !element->dN->size()) {
+			continue;
+		}
+		size_t dimension = element->dN->front().rows();
+		if (dimension == 2 || dimension == 3) {
+			++count[code];
+			size[code] = element->dN->size() * (1 + dimension * element->nodes) * sizeof(double);
+		}
+	}
+
+	std::vector<int> order;
+	for (size_t c = 0; c < codes; c++) {
+		if (count[c]) {
+			order.push_back(c);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&] (int c1, int c2) { return size[c1] < size[c2]; });
+
+	std::vector<bool> cached(codes, false);
+	for (size_t i = 0; i < order.size(); i++) {
+		if (_memory + count[order[i]] * size[order[i]] <= budget) {
+			_memory += count[order[i]] * size[order[i]];
+			cached[order[i]] = true;
+		}
+	}
+
+	eslocal domains = _mesh->elements->ndomains;
+	_version.resize(domains, (size_t)-1);
+	_detJ.resize(domains);
+	_dND.resize(domains);
+	_offset.resize(epointers.size(), -1);
+	_dNDOffset.resize(epointers.size(), -1);
+	_invalid.resize(epointers.size(), 0);
+
+	for (eslocal d = 0; d < domains; d++) {
+		eslocal offset = 0, dNDOffset = 0;
+		for (eslocal e = _mesh->elements->elementsDistribution[d]; e < _mesh->elements->elementsDistribution[d + 1]; e++) {
+			const Element *element = epointers[e];
+			if (cached[static_cast<int>(element->code)]) {
+				_offset[e] = offset;
+				_dNDOffset[e] = dNDOffset;
+				offset += element->dN->size();
+				dNDOffset += element->dN->size() * element->dN->front().rows() * element->nodes;
+			}
+		}
+		_detJ[d].resize(offset);
+		_dND[d].resize(dNDOffset);
+	}
+}
+
+void GeometryCache::prepare(size_t domain, const std::function<void(eslocal)> &invalid)
+{
+	if (_version[domain] == _mesh->nodes->coordinatesVersion) {
+		return;
+	}
+
+	const auto &coordinates = _mesh->nodes->coordinates->datatarray();
+	const auto &epointers = _mesh->elements->epointers->datatarray();
+	auto nodes = _mesh->elements->nodes->cbegin() + _mesh->elements->elementsDistribution[domain];
+
+	DenseMatrix coords, J, invJ, dND;
+	for (eslocal e = _mesh->elements->elementsDistribution[domain]; e < _mesh->elements->elementsDistribution[domain + 1]; ++e, ++nodes) {
+		if (!cached(e)) {
+			continue;
+		}
+
+		const std::vector<DenseMatrix> &dN = *(epointers[e]->dN);
+		size_t dimension = dN.front().rows();
+
+		coords.resize(nodes->size(), dimension);
+		for (size_t n = 0; n < nodes->size(); n++) {
+			const Point &p = coordinates[nodes->at(n)];
+			coords(n, 0) = p.x;
+			coords(n, 1) = p.y;
+			if (dimension == 3) {
+				coords(n, 2) = p.z;
+			}
+		}
+
+		_invalid[e] = 0;
+		double *determinants = _detJ[domain].data() + _offset[e];
+		double *gradients = _dND[domain].data() + _dNDOffset[e];
+		invJ.resize(dimension, dimension);
+		for (size_t gp = 0; gp < dN.size(); gp++) {
+			J.multiply(dN[gp], coords);
+			const double *m = J.values();
+			double *inv = invJ.values();
+			double detJ;
+			if (dimension == 3) {
+				detJ =
+					+ m[0] * m[4] * m[8] + m[1] * m[5] * m[6] + m[2] * m[3] * m[7]
+					- m[2] * m[4] * m[6] - m[1] * m[3] * m[8] - m[0] * m[5] * m[7];
+			} else {
+				detJ = m[0] * m[3] - m[1] * m[2];
+			}
+			if (dimension == 3 && detJ <= 0) {
+				_invalid[e] = 1;
+				detJ = -detJ;
+			}
+			if (dimension == 3) {
+				inv[0] = ( m[8] * m[4] - m[7] * m[5]) / detJ;
+				inv[1] = (-m[8] * m[1] + m[7] * m[2]) / detJ;
+				inv[2] = ( m[5] * m[1] - m[4] * m[2]) / detJ;
+				inv[3] = (-m[8] * m[3] + m[6] * m[5]) / detJ;
+				inv[4] = ( m[8] * m[0] - m[6] * m[2]) / detJ;
+				inv[5] = (-m[5] * m[0] + m[3] * m[2]) / detJ;
+				inv[6] = ( m[7] * m[3] - m[6] * m[4]) / detJ;
+				inv[7] = (-m[7] * m[0] + m[6] * m[1]) / detJ;
+				inv[8] = ( m[4] * m[0] - m[3] * m[1]) / detJ;
+			} else {
+				inv[0] =   m[3] / detJ;
+				inv[1] = - m[1] / detJ;
+				inv[2] = - m[2] / detJ;
+				inv[3] =   m[0] / detJ;
+			}
+			dND.multiply(invJ, dN[gp]);
+
+			determinants[gp] = detJ;
+			std::copy(dND.values(), dND.values() + dimension * nodes->size(), gradients);
+			gradients += dimension * nodes->size();
+		}
+		if (_invalid[e]) {
+			invalid(e);
+		}
+	}
+
+	_version[domain] = _mesh->nodes->coordinatesVersion;
+}
@@ -0,0 +1,56 @@
+
+#ifndef SRC_ASSEMBLER_PHYSICS_GEOMETRYCACHE_H_
+#define SRC_ASSEMBLER_PHYSICS_GEOMETRYCACHE_H_
+
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+namespace espreso {
+
+class Mesh;
+
+/**
+ * Geometric factors of elements reused by repeated assemblies.
+ *
+ * For each cached element and Gauss point, detJ and gradients of shape functions
+ * with respect to physical coordinates (dND = inv(J) * dN) are stored.
+ * Data of a domain are stored contiguously: all Gauss points of an element follow each other
+ * and gradients of a Gauss point are stored as a (dimension x nodes) row-major matrix.
+ *
+ * Data are recomputed only after a change of coordinates (e.g. mesh morphing).
+ * The sign of detJ is kept for 2D elements. 3D elements with non-positive detJ are marked
+ * as invalid and their data are computed from |detJ| in the same way as element kernels do.
+ * If the memory budget is not sufficient for all elements,
+ * whole element types are cached starting from types with the smallest memory per element.
+ */
+class GeometryCache {
+
+public:
+	GeometryCache(Mesh *mesh, size_t budget);
+
+	// recompute data of the domain if coordinates were changed, 'invalid' is called once for each invalid element
+	void prepare(size_t domain, const std::function<void(eslocal)> &invalid);
+
+	bool cached(eslocal eindex) const { return _offset[eindex] != -1; }
+	bool invalid(eslocal eindex) const { return _invalid[eindex]; }
+	const double* detJ(size_t domain, eslocal eindex) const { return _detJ[domain].data() + _offset[eindex]; }
+	const double* dND(size_t domain, eslocal eindex) const { return _dND[domain].data() + _dNDOffset[eindex]; }
+
+	size_t memory() const { return _memory; }
+
+protected:
+	Mesh *_mesh;
+
+	size_t _memory;
+	std::vector<size_t> _version; // version of coordinates used for data of a domain
+	std::vector<eslocal> _offset, _dNDOffset; // offsets of elements in domain buffers (-1 for not cached elements)
+	std::vector<char> _invalid; // 3D elements with non-positive detJ in some Gauss point
+	std::vector<std::vector<double> > _detJ, _dND;
+};
+
+}
+
+
+
+#endif /* SRC_ASSEMBLER_PHYSICS_GEOMETRYCACHE_H_ */
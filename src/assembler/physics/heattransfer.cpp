@@ -62,6 +62,13 @@ HeatTransfer::HeatTransfer(const HeatTransferConfiguration &configuration, const
 	}
 }
 
+void HeatTransfer::resolveElementSettings()
+{
+	resolveElementRegions(_configuration.load_steps_settings.at(_step->step + 1).translation_motions);
+	resolveElementRegions(_configuration.load_steps_settings.at(_step->step + 1).heat_source);
+	resolveElementRegions(_configuration.thickness);
+}
+
 void HeatTransfer::setDirichlet()
 {
 	if (_step->step) {
@@ -229,6 +236,60 @@ void HeatTransfer::preprocessData()
 	computeInitialTemperature(_instance->primalSolution);
 }
 
+static bool isVariable(const ECFExpression &expression)
+{
+	return expression.evaluator != NULL && (expression.evaluator->isTimeDependent() || expression.evaluator->isTemperatureDependent());
+}
+
+static bool isVariable(const MaterialBaseConfiguration &material)
+{
+	if (isVariable(material.density) || isVariable(material.heat_capacity)) {
+		return true;
+	}
+	for (size_t i = 0; i < material.thermal_conductivity.values.values.size(); i++) {
+		if (isVariable(material.thermal_conductivity.values.values[i])) {
+			return true;
+		}
+	}
+	for (int d = 0; d < 3; d++) {
+		if (isVariable(material.coordinate_system.rotation.data[d]) || isVariable(material.coordinate_system.center.data[d])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HeatTransfer::isMatrixConstant() const
+{
+	for (size_t m = 0; m < _mesh->materials.size(); m++) {
+		if (_mesh->materials[m]->phase_change || isVariable(*_mesh->materials[m])) {
+			return false;
+		}
+	}
+
+	const HeatTransferLoadStepConfiguration &settings = _configuration.load_steps_settings.at(_step->step + 1);
+	if (settings.translation_motions.size() && _configuration.stabilization == HeatTransferConfiguration::STABILIZATION::CAU) {
+		return false;
+	}
+	for (auto it = settings.translation_motions.begin(); it != settings.translation_motions.end(); ++it) {
+		for (int d = 0; d < 3; d++) {
+			if (isVariable(it->second.data[d])) {
+				return false;
+			}
+		}
+	}
+	// radiation is non-linear
+	if (settings.diffuse_radiation.size()) {
+		return false;
+	}
+	for (auto it = settings.convection.begin(); it != settings.convection.end(); ++it) {
+		if (it->second.type != ConvectionConfiguration::TYPE::USER || isVariable(it->second.heat_transfer_coefficient)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 double HeatTransfer::sumSquares(const std::vector<std::vector<double> > &data, SumRestriction restriction) const
 {
 	switch (restriction) {
@@ -20,12 +20,15 @@ struct HeatTransfer: public virtual Physics
 	virtual void preprocessData();
 	virtual void setDirichlet();
 	virtual void analyticRegularization(size_t domain, bool ortogonalCluster);
+	virtual bool isMatrixConstant() const;
 
 	double sumSquares(const std::vector<std::vector<double> > &data, SumRestriction restriction) const;
 
 	virtual ~HeatTransfer() {}
 
 protected:
+	virtual void resolveElementSettings();
+
 	void computeInitialTemperature(std::vector<std::vector<double> > &data);
 
 	double computeHTC(const ConvectionConfiguration *convection, const Point &p, double temp) const;
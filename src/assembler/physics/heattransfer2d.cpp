@@ -159,31 +159,13 @@ void HeatTransfer2D::processElement(eslocal domain, Matrices matrices, eslocal e
 {
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = _localNodes->cbegin() + eindex;
 	const ECFExpressionVector *translation_motion = NULL;
 	Evaluator *heat_source = NULL;
 	Evaluator *thick = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).translation_motions.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).translation_motions.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			translation_motion = &it->second;
-			break;
-		}
-	}
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).heat_source.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).heat_source.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			heat_source = it->second.evaluator;
-			break;
-		}
-	}
-	for (auto it = _configuration.thickness.begin(); it != _configuration.thickness.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			thick = it->second.evaluator;
-			break;
-		}
-	}
+	translation_motion = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).translation_motions, eindex);
+	heat_source = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).heat_source, eindex);
+	thick = elementEvaluator(_configuration.thickness, eindex);
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -218,8 +200,7 @@ void HeatTransfer2D::processElement(eslocal domain, Matrices matrices, eslocal e
 	}
 
 	for (size_t n = 0; n < nodes->size(); n++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(n), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		T(n, 0) = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin];
+		T(n, 0) = (*_temperature->decomposedData)[domain][localNodes->at(n)];
 		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
 		coordinates(n, 0) = p.x;
 		coordinates(n, 1) = p.y;
@@ -297,9 +278,12 @@ void HeatTransfer2D::processElement(eslocal domain, Matrices matrices, eslocal e
 	for (size_t gp = 0; gp < N.size(); gp++) {
 		u.multiply(N[gp], U, 1, 0);
 
-		J.multiply(dN[gp], coordinates);
-		detJ = determinant2x2(J.values());
-		inverse2x2(J.values(), invJ.values(), detJ);
+		if (!cachedGeometry(domain, eindex, gp, detJ, dND)) {
+			J.multiply(dN[gp], coordinates);
+			detJ = determinant2x2(J.values());
+			inverse2x2(J.values(), invJ.values(), detJ);
+			dND.multiply(invJ, dN[gp]);
+		}
 
 		gpThickness.multiply(N[gp], thickness);
 		gpK.multiply(N[gp], K);
@@ -317,8 +301,6 @@ void HeatTransfer2D::processElement(eslocal domain, Matrices matrices, eslocal e
 		Ce(0, 1) = gpK(0, 2);
 		Ce(1, 0) = gpK(0, 3);
 
-		dND.multiply(invJ, dN[gp]);
-
 		DenseMatrix b_e(1, nodes->size()), b_e_c(1, nodes->size()), g_e(1, nodes->size());
 		b_e.multiply(u, dND, 1, 0);
 		g_e.multiply(g, dND, 1, 0);
@@ -500,7 +482,7 @@ void HeatTransfer2D::processEdge(eslocal domain, const BoundaryRegionStore *regi
 
 	auto nodes = region->elements->cbegin() + eindex;
 	auto epointer = region->epointers->datatarray()[eindex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = boundaryLocalNodes(region)->cbegin() + eindex;
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -527,8 +509,7 @@ void HeatTransfer2D::processEdge(eslocal domain, const BoundaryRegionStore *regi
 	}
 
 	for (size_t n = 0; n < nodes->size(); n++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(n), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		temp = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin];
+		temp = (*_temperature->decomposedData)[domain][localNodes->at(n)];
 		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
 		coordinates(n, 0) = p.x;
 		coordinates(n, 1) = p.y;
@@ -594,17 +575,11 @@ void HeatTransfer2D::postProcessElement(eslocal domain, eslocal eindex)
 {
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = _localNodes->cbegin() + eindex;
 	const ECFExpressionVector *translation_motion = NULL;
 //	Evaluator *heat_source = NULL;
 	Evaluator *thick = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).translation_motions.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).translation_motions.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			translation_motion = &it->second;
-			break;
-		}
-	}
+	translation_motion = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).translation_motions, eindex);
 //	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).heat_source.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).heat_source.end(); ++it) {
 //		ElementsRegionStore *region = _mesh->eregion(it->first);
 //		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
@@ -612,13 +587,7 @@ void HeatTransfer2D::postProcessElement(eslocal domain, eslocal eindex)
 //			break;
 //		}
 //	}
-	for (auto it = _configuration.thickness.begin(); it != _configuration.thickness.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			thick = it->second.evaluator;
-			break;
-		}
-	}
+	thick = elementEvaluator(_configuration.thickness, eindex);
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -640,8 +609,7 @@ void HeatTransfer2D::postProcessElement(eslocal domain, eslocal eindex)
 	coordinates.resize(nodes->size(), 2);
 
 	for (size_t n = 0; n < nodes->size(); n++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(n), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		temp(n, 0) = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin];
+		temp(n, 0) = (*_temperature->decomposedData)[domain][localNodes->at(n)];
 		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
 		coordinates(n, 0) = p.x;
 		coordinates(n, 1) = p.y;
@@ -659,8 +627,8 @@ void HeatTransfer2D::postProcessElement(eslocal domain, eslocal eindex)
 					(1 - phase) * phase2->heat_capacity.evaluator->evaluate(p, _step->currentTime, temp(n, 0)) +
 					material->latent_heat * derivation) * thickness(n, 0);
 			if (_phaseChange) {
-				(*_phaseChange->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin] = phase;
-				(*_latentHeat->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin] = material->latent_heat * derivation;
+				(*_phaseChange->decomposedData)[domain][localNodes->at(n)] = phase;
+				(*_latentHeat->decomposedData)[domain][localNodes->at(n)] = material->latent_heat * derivation;
 			}
 		} else {
 			assembleMaterialMatrix(n, p, material, 1, temp(n, 0), K, CD, false);
@@ -727,6 +695,8 @@ void HeatTransfer2D::postProcessElement(eslocal domain, eslocal eindex)
 
 void HeatTransfer2D::processSolution()
 {
+	resolveElementSettings();
+
 	if (_gradient || _flux || _phaseChange) {
 		#pragma omp parallel for
 		for (eslocal d = 0; d < _mesh->elements->ndomains; d++) {
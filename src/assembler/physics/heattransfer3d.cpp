@@ -1,5 +1,6 @@
 
 #include "heattransfer3d.h"
+#include "geometrycache.h"
 
 #include "../step.h"
 #include "../instance.h"
@@ -28,6 +29,13 @@
 // TODO: create file with constants
 #define CONST_Stefan_Boltzmann 5.6703e-8
 
+// number of elements processed together by fixed-size kernels (doubles in a SIMD register)
+#ifdef __AVX512F__
+#define ELEMENTS_BATCH 8
+#else
+#define ELEMENTS_BATCH 4
+#endif
+
 using namespace espreso;
 
 HeatTransfer3D::HeatTransfer3D(Mesh *mesh, Instance *instance, Step *step, const HeatTransferConfiguration &configuration, const ResultsSelectionConfiguration &propertiesConfiguration)
@@ -70,202 +78,239 @@ void HeatTransfer3D::processBEM(eslocal domain, Matrices matrices)
 
 }
 
-void HeatTransfer3D::assembleMaterialMatrix(eslocal node, const Point &p, const MaterialBaseConfiguration *mat, double phase, double temp, DenseMatrix &K, DenseMatrix &CD, bool tangentCorrection) const
+void HeatTransfer3D::assembleMaterialMatrix(eslocal size, const Point *p, const double *temp, const MaterialBaseConfiguration *mat, const double *phase, DenseMatrix &K, DenseMatrix &CD, bool tangentCorrection) const
 {
 	auto d2r = [] (double degree) -> double {
 		return M_PI * degree / 180;
 	};
 
-	Point sin, cos;
+	double time = _step->currentTime;
+	std::vector<Point> sin(size), cos(size);
+	std::vector<double> x(size), y(size), z(size);
+
 	switch (mat->coordinate_system.type) {
 	case CoordinateSystemConfiguration::TYPE::CARTESIAN:
 
-		cos.x = std::cos(d2r(mat->coordinate_system.rotation.x.evaluator->evaluate(p, _step->currentTime, temp)));
-		cos.y = std::cos(d2r(mat->coordinate_system.rotation.y.evaluator->evaluate(p, _step->currentTime, temp)));
-		cos.z = std::cos(d2r(mat->coordinate_system.rotation.z.evaluator->evaluate(p, _step->currentTime, temp)));
+		mat->coordinate_system.rotation.x.evaluator->evaluate(size, p, temp, time, x.data());
+		mat->coordinate_system.rotation.y.evaluator->evaluate(size, p, temp, time, y.data());
+		mat->coordinate_system.rotation.z.evaluator->evaluate(size, p, temp, time, z.data());
 
-		sin.x = std::sin(d2r(mat->coordinate_system.rotation.x.evaluator->evaluate(p, _step->currentTime, temp)));
-		sin.y = std::sin(d2r(mat->coordinate_system.rotation.y.evaluator->evaluate(p, _step->currentTime, temp)));
-		sin.z = std::sin(d2r(mat->coordinate_system.rotation.z.evaluator->evaluate(p, _step->currentTime, temp)));
+		for (eslocal n = 0; n < size; n++) {
+			cos[n].x = std::cos(d2r(x[n]));
+			cos[n].y = std::cos(d2r(y[n]));
+			cos[n].z = std::cos(d2r(z[n]));
+
+			sin[n].x = std::sin(d2r(x[n]));
+			sin[n].y = std::sin(d2r(y[n]));
+			sin[n].z = std::sin(d2r(z[n]));
+		}
 
 		break;
 
 	case CoordinateSystemConfiguration::TYPE::CYLINDRICAL: {
 
-		Point origin(
-				mat->coordinate_system.center.x.evaluator->evaluate(p, _step->currentTime, temp),
-				mat->coordinate_system.center.y.evaluator->evaluate(p, _step->currentTime, temp),
-				0);
+		mat->coordinate_system.center.x.evaluator->evaluate(size, p, temp, time, x.data());
+		mat->coordinate_system.center.y.evaluator->evaluate(size, p, temp, time, y.data());
 
-		double rotation = std::atan2((p.y - origin.y), (p.x - origin.x));
+		for (eslocal n = 0; n < size; n++) {
+			double rotation = std::atan2((p[n].y - y[n]), (p[n].x - x[n]));
 
-		cos.x = 1.0;
-		cos.y = 1.0;
-		cos.z = std::cos(rotation);
+			cos[n].x = 1.0;
+			cos[n].y = 1.0;
+			cos[n].z = std::cos(rotation);
 
-		sin.x = 0.0;
-		sin.y = 0.0;
-		sin.z = std::sin(rotation);
+			sin[n].x = 0.0;
+			sin[n].y = 0.0;
+			sin[n].z = std::sin(rotation);
+		}
 
 	} break;
 
 	case CoordinateSystemConfiguration::TYPE::SPHERICAL: {
 
-		Point origin(
-				mat->coordinate_system.center.x.evaluator->evaluate(p, _step->currentTime, temp),
-				mat->coordinate_system.center.y.evaluator->evaluate(p, _step->currentTime, temp),
-				mat->coordinate_system.center.z.evaluator->evaluate(p, _step->currentTime, temp));
+		mat->coordinate_system.center.x.evaluator->evaluate(size, p, temp, time, x.data());
+		mat->coordinate_system.center.y.evaluator->evaluate(size, p, temp, time, y.data());
+		mat->coordinate_system.center.z.evaluator->evaluate(size, p, temp, time, z.data());
 
-		double azimut = std::atan2((p.y - origin.y), (p.x - origin.x));
-		double r = std::sqrt(pow((p.x - origin.x), 2) + pow((p.y - origin.y), 2) + pow((p.z - origin.z), 2));
-		double elevation = 0.0;
+		for (eslocal n = 0; n < size; n++) {
+			Point origin(x[n], y[n], z[n]);
 
-		if (r < 1e-12) {
-			elevation = 0.0;
-		} else {
-			elevation = std::atan2(std::sqrt(pow((p.z - origin.z), 2) + pow((p.x - origin.x), 2)), (p.y - origin.y));
-		}
+			double azimut = std::atan2((p[n].y - origin.y), (p[n].x - origin.x));
+			double r = std::sqrt(pow((p[n].x - origin.x), 2) + pow((p[n].y - origin.y), 2) + pow((p[n].z - origin.z), 2));
+			double elevation = 0.0;
+
+			if (r < 1e-12) {
+				elevation = 0.0;
+			} else {
+				elevation = std::atan2(std::sqrt(pow((p[n].z - origin.z), 2) + pow((p[n].x - origin.x), 2)), (p[n].y - origin.y));
+			}
 
-		cos.x = 1.0;
-		cos.y = std::cos(elevation);
-		cos.z = std::cos(azimut);
+			cos[n].x = 1.0;
+			cos[n].y = std::cos(elevation);
+			cos[n].z = std::cos(azimut);
 
-		sin.x = 0.0;
-		sin.y = std::sin(elevation);
-		sin.z = std::sin(azimut);
+			sin[n].x = 0.0;
+			sin[n].y = std::sin(elevation);
+			sin[n].z = std::sin(azimut);
+		}
 
 	} break;
 
 	}
 
+	// components of the conductivity tensor that are evaluated
+	std::vector<std::pair<int, int> > components;
+	bool isotropic = false, symmetric = false;
+	switch (mat->thermal_conductivity.model) {
+	case ThermalConductivityConfiguration::MODEL::ISOTROPIC:
+		components = { { 0, 0 } };
+		isotropic = true;
+		break;
+	case ThermalConductivityConfiguration::MODEL::DIAGONAL:
+		components = { { 0, 0 }, { 1, 1 }, { 2, 2 } };
+		break;
+	case ThermalConductivityConfiguration::MODEL::SYMMETRIC:
+		components = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 } };
+		symmetric = true;
+		break;
+	case ThermalConductivityConfiguration::MODEL::ANISOTROPIC:
+		components = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 }, { 1, 0 }, { 2, 0 }, { 2, 1 } };
+		break;
+	default:
+		ESINFO(ERROR) << "Advection diffusion 3D not supports set material model";
+	}
 
-	DenseMatrix TCT(3, 3), T(3, 3), C(3, 3), _CD, TCDT;
+	// all nodes are evaluated by a single call for each component
+	std::vector<double> values(components.size() * size), derivations, tplus, tminus, minus;
+	for (size_t c = 0; c < components.size(); c++) {
+		mat->thermal_conductivity.values.get(components[c].first, components[c].second).evaluator->evaluate(size, p, temp, time, values.data() + c * size);
+	}
+	if (tangentCorrection) {
+		derivations.resize(components.size() * size);
+		tplus.resize(size);
+		tminus.resize(size);
+		minus.resize(size);
+		for (eslocal n = 0; n < size; n++) {
+			tplus[n] = temp[n] + temp[n] / 1e4;
+			tminus[n] = temp[n] - temp[n] / 1e4;
+		}
+		for (size_t c = 0; c < components.size(); c++) {
+			const Evaluator *evaluator = mat->thermal_conductivity.values.get(components[c].first, components[c].second).evaluator;
+			evaluator->evaluate(size, p, tplus.data(), time, derivations.data() + c * size);
+			evaluator->evaluate(size, p, tminus.data(), time, minus.data());
+			for (eslocal n = 0; n < size; n++) {
+				derivations[c * size + n] = (derivations[c * size + n] - minus[n]) / (2 * temp[n] / 1e4);
+			}
+		}
+	}
 
-	T(0, 0) = cos.y * cos.z;                         T(0, 1) = cos.y * sin.z;                         T(0, 2) = -sin.y;
-	T(1, 0) = cos.z * sin.x * sin.y - cos.x * sin.z; T(1, 1) = cos.x * cos.z + sin.x * sin.y * sin.z; T(1, 2) = cos.y * sin.x;
-	T(2, 0) = sin.x * sin.z + cos.x * cos.z * sin.y; T(2, 1) = cos.x * sin.y * sin.z - cos.z * sin.x; T(2, 2) = cos.x * cos.y;
+	DenseMatrix TCT(3, 3), T(3, 3), C(3, 3), _CD, TCDT;
 
 	if (tangentCorrection) {
 		_CD.resize(3, 3);
 		TCDT.resize(3, 3);
 	}
 
-	auto derivation = [&] (const ECFExpression &expression, double h) {
-		return (
-				expression.evaluator->evaluate(p, _step->currentTime, temp + h) -
-				expression.evaluator->evaluate(p, _step->currentTime, temp - h)
-				) / (2 * h);
+	auto fill = [&] (DenseMatrix &M, const std::vector<double> &data, eslocal node) {
+		M = 0;
+		for (size_t c = 0; c < components.size(); c++) {
+			M(components[c].first, components[c].second) = data[c * size + node];
+			if (symmetric) {
+				M(components[c].second, components[c].first) = data[c * size + node];
+			}
+		}
+		if (isotropic) {
+			M(1, 1) = M(2, 2) = M(0, 0);
+		}
 	};
 
-	switch (mat->thermal_conductivity.model) {
-	case ThermalConductivityConfiguration::MODEL::ISOTROPIC:
-		C(0, 0) = C(1, 1) = C(2, 2) = mat->thermal_conductivity.values.get(0, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 1) = C(0, 2) = C(1, 0) = C(1, 2) = C(2, 0) = C(2, 1) = 0;
+	for (eslocal n = 0; n < size; n++) {
+		double nphase = phase != NULL ? phase[n] : 1;
+
+		T(0, 0) = cos[n].y * cos[n].z;                               T(0, 1) = cos[n].y * sin[n].z;                               T(0, 2) = -sin[n].y;
+		T(1, 0) = cos[n].z * sin[n].x * sin[n].y - cos[n].x * sin[n].z; T(1, 1) = cos[n].x * cos[n].z + sin[n].x * sin[n].y * sin[n].z; T(1, 2) = cos[n].y * sin[n].x;
+		T(2, 0) = sin[n].x * sin[n].z + cos[n].x * cos[n].z * sin[n].y; T(2, 1) = cos[n].x * sin[n].y * sin[n].z - cos[n].z * sin[n].x; T(2, 2) = cos[n].x * cos[n].y;
+
+		fill(C, values, n);
+		TCT.multiply(T, C * T, 1, 0, true, false);
 		if (tangentCorrection) {
-			_CD(0, 0) = _CD(1, 1) = _CD(2, 2) = derivation(mat->thermal_conductivity.values.get(0, 0), temp / 1e4);
-			_CD(0, 1) = _CD(0, 2) = _CD(1, 0) = _CD(1, 2) = _CD(2, 0) = _CD(2, 1) = 0;
+			fill(_CD, derivations, n);
+			TCDT.multiply(T, _CD * T, 1, 0, true, false);
+			CD(n, 0) += nphase * TCDT(0, 0);
+			CD(n, 1) += nphase * TCDT(1, 1);
+			CD(n, 2) += nphase * TCDT(2, 2);
+			CD(n, 3) += nphase * TCDT(0, 1);
+			CD(n, 4) += nphase * TCDT(0, 2);
+			CD(n, 5) += nphase * TCDT(1, 0);
+			CD(n, 6) += nphase * TCDT(1, 2);
+			CD(n, 7) += nphase * TCDT(2, 0);
+			CD(n, 8) += nphase * TCDT(2, 1);
 		}
-		break;
-	case ThermalConductivityConfiguration::MODEL::DIAGONAL:
-		C(0, 0) = mat->thermal_conductivity.values.get(0, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 1) = mat->thermal_conductivity.values.get(1, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		C(2, 2) = mat->thermal_conductivity.values.get(2, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 1) = C(0, 2) = C(1, 0) = C(1, 2) = C(2, 0) = C(2, 1) = 0;
-		if (tangentCorrection) {
-			_CD(0, 0) = derivation(mat->thermal_conductivity.values.get(0, 0), temp / 1e4);
-			_CD(1, 1) = derivation(mat->thermal_conductivity.values.get(1, 1), temp / 1e4);
-			_CD(2, 2) = derivation(mat->thermal_conductivity.values.get(2, 2), temp / 1e4);
-			_CD(0, 1) = _CD(0, 2) = _CD(1, 0) = _CD(1, 2) = _CD(2, 0) = _CD(2, 1) = 0;
+
+		K(n, 0) += nphase * TCT(0, 0);
+		K(n, 1) += nphase * TCT(1, 1);
+		K(n, 2) += nphase * TCT(2, 2);
+		K(n, 3) += nphase * TCT(0, 1);
+		K(n, 4) += nphase * TCT(0, 2);
+		K(n, 5) += nphase * TCT(1, 0);
+		K(n, 6) += nphase * TCT(1, 2);
+		K(n, 7) += nphase * TCT(2, 0);
+		K(n, 8) += nphase * TCT(2, 1);
+	}
+}
+
+void HeatTransfer3D::assembleElementMaterial(eslocal eindex, eslocal size, const Point *points, const double *temps, DenseMatrix &K, DenseMatrix &m, DenseMatrix &CD, bool tangentCorrection) const
+{
+	const MaterialConfiguration* material = _mesh->materials[_mesh->elements->material->datatarray()[eindex]];
+
+	const MaterialBaseConfiguration *phase1, *phase2;
+	if (material->phase_change) {
+		phase1 = &material->phases.find(1)->second;
+		phase2 = &material->phases.find(2)->second;
+	}
+
+	double time = _step->currentTime;
+	std::vector<double> phase, complement, derivation, density(size), heatCapacity(size);
+	if (material->phase_change) {
+		phase.resize(size);
+		complement.resize(size);
+		derivation.resize(size);
+		for (eslocal n = 0; n < size; n++) {
+			smoothstep(phase[n], derivation[n], material->phase_change_temperature - material->transition_interval / 2, material->phase_change_temperature + material->transition_interval / 2, temps[n], material->smooth_step_order);
+			complement[n] = 1 - phase[n];
 		}
-		break;
-	case ThermalConductivityConfiguration::MODEL::SYMMETRIC:
-		C(0, 0) = mat->thermal_conductivity.values.get(0, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 1) = mat->thermal_conductivity.values.get(1, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		C(2, 2) = mat->thermal_conductivity.values.get(2, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 1) = C(1, 0) = mat->thermal_conductivity.values.get(0, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 2) = C(2, 0) = mat->thermal_conductivity.values.get(0, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 2) = C(2, 1) = mat->thermal_conductivity.values.get(1, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		if (tangentCorrection) {
-			_CD(0, 0) = derivation(mat->thermal_conductivity.values.get(0, 0), temp / 1e4);
-			_CD(1, 1) = derivation(mat->thermal_conductivity.values.get(1, 1), temp / 1e4);
-			_CD(2, 2) = derivation(mat->thermal_conductivity.values.get(2, 2), temp / 1e4);
-			_CD(0, 1) = _CD(1, 0) = derivation(mat->thermal_conductivity.values.get(0, 1), temp / 1e4);
-			_CD(0, 2) = _CD(2, 0) = derivation(mat->thermal_conductivity.values.get(0, 2), temp / 1e4);
-			_CD(1, 2) = _CD(2, 1) = derivation(mat->thermal_conductivity.values.get(1, 2), temp / 1e4);
+		assembleMaterialMatrix(size, points, temps, phase1, phase.data(), K, CD, tangentCorrection);
+		assembleMaterialMatrix(size, points, temps, phase2, complement.data(), K, CD, tangentCorrection);
+
+		std::vector<double> density2(size), heatCapacity2(size);
+		phase1->density.evaluator->evaluate(size, points, temps, time, density.data());
+		phase2->density.evaluator->evaluate(size, points, temps, time, density2.data());
+		phase1->heat_capacity.evaluator->evaluate(size, points, temps, time, heatCapacity.data());
+		phase2->heat_capacity.evaluator->evaluate(size, points, temps, time, heatCapacity2.data());
+		for (eslocal n = 0; n < size; n++) {
+			m(n, 0) =
+					(phase[n] * density[n] + complement[n] * density2[n]) *
+					(phase[n] * heatCapacity[n] + complement[n] * heatCapacity2[n] + material->latent_heat * derivation[n]);
 		}
-		break;
-	case ThermalConductivityConfiguration::MODEL::ANISOTROPIC:
-		C(0, 0) = mat->thermal_conductivity.values.get(0, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 1) = mat->thermal_conductivity.values.get(1, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		C(2, 2) = mat->thermal_conductivity.values.get(2, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 1) = mat->thermal_conductivity.values.get(0, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		C(0, 2) = mat->thermal_conductivity.values.get(0, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 0) = mat->thermal_conductivity.values.get(1, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(1, 2) = mat->thermal_conductivity.values.get(1, 2).evaluator->evaluate(p, _step->currentTime, temp);
-		C(2, 0) = mat->thermal_conductivity.values.get(2, 0).evaluator->evaluate(p, _step->currentTime, temp);
-		C(2, 1) = mat->thermal_conductivity.values.get(2, 1).evaluator->evaluate(p, _step->currentTime, temp);
-		if (tangentCorrection) {
-			_CD(0, 0) = derivation(mat->thermal_conductivity.values.get(0, 0), temp / 1e4);
-			_CD(1, 1) = derivation(mat->thermal_conductivity.values.get(1, 1), temp / 1e4);
-			_CD(2, 2) = derivation(mat->thermal_conductivity.values.get(2, 2), temp / 1e4);
-			_CD(0, 1) = derivation(mat->thermal_conductivity.values.get(0, 1), temp / 1e4);
-			_CD(0, 2) = derivation(mat->thermal_conductivity.values.get(0, 2), temp / 1e4);
-			_CD(1, 2) = derivation(mat->thermal_conductivity.values.get(1, 2), temp / 1e4);
-			_CD(1, 0) = derivation(mat->thermal_conductivity.values.get(1, 0), temp / 1e4);
-			_CD(2, 0) = derivation(mat->thermal_conductivity.values.get(2, 0), temp / 1e4);
-			_CD(2, 1) = derivation(mat->thermal_conductivity.values.get(2, 1), temp / 1e4);
+	} else {
+		assembleMaterialMatrix(size, points, temps, material, NULL, K, CD, tangentCorrection);
+		material->density.evaluator->evaluate(size, points, temps, time, density.data());
+		material->heat_capacity.evaluator->evaluate(size, points, temps, time, heatCapacity.data());
+		for (eslocal n = 0; n < size; n++) {
+			m(n, 0) = density[n] * heatCapacity[n];
 		}
-		break;
-	default:
-		ESINFO(ERROR) << "Advection diffusion 3D not supports set material model";
 	}
-
-	TCT.multiply(T, C * T, 1, 0, true, false);
-	if (tangentCorrection) {
-		TCDT.multiply(T, _CD * T, 1, 0, true, false);
-		CD(node, 0) += phase * TCDT(0, 0);
-		CD(node, 1) += phase * TCDT(1, 1);
-		CD(node, 2) += phase * TCDT(2, 2);
-		CD(node, 3) += phase * TCDT(0, 1);
-		CD(node, 4) += phase * TCDT(0, 2);
-		CD(node, 5) += phase * TCDT(1, 0);
-		CD(node, 6) += phase * TCDT(1, 2);
-		CD(node, 7) += phase * TCDT(2, 0);
-		CD(node, 8) += phase * TCDT(2, 1);
-	}
-
-	K(node, 0) += phase * TCT(0, 0);
-	K(node, 1) += phase * TCT(1, 1);
-	K(node, 2) += phase * TCT(2, 2);
-	K(node, 3) += phase * TCT(0, 1);
-	K(node, 4) += phase * TCT(0, 2);
-	K(node, 5) += phase * TCT(1, 0);
-	K(node, 6) += phase * TCT(1, 2);
-	K(node, 7) += phase * TCT(2, 0);
-	K(node, 8) += phase * TCT(2, 1);
 }
 
 void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal eindex, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe) const
 {
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = _localNodes->cbegin() + eindex;
 	const ECFExpressionVector *translation_motion = NULL;
 	Evaluator *heat_source = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).translation_motions.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).translation_motions.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			translation_motion = &it->second;
-			break;
-		}
-	}
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).heat_source.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).heat_source.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			heat_source = it->second.evaluator;
-			break;
-		}
-	}
+	translation_motion = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).translation_motions, eindex);
+	heat_source = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).heat_source, eindex);
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -275,7 +320,7 @@ void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal e
 	bool tangentCorrection = (matrices & Matrices::K) && _step->tangentMatrixCorrection;
 
 	DenseMatrix Ce(3, 3), coordinates(nodes->size(), 3), J(3, 3), invJ(3, 3), dND;
-	double detJ, temp, tauK, xi = 1, C1 = 1, C2 = 6;
+	double detJ, tauK, xi = 1, C1 = 1, C2 = 6;
 	DenseMatrix f(nodes->size(), 1);
 	DenseMatrix U(nodes->size(), 3);
 	DenseMatrix m(nodes->size(), 1);
@@ -285,55 +330,39 @@ void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal e
 	DenseMatrix tangentK, BT, BTN, gpCD, CD, CDBTN, CDe;
 	DenseMatrix gKe(nodes->size(), nodes->size());
 
-	const MaterialConfiguration* material = _mesh->materials[_mesh->elements->material->datatarray()[eindex]];
-
-	const MaterialBaseConfiguration *phase1, *phase2;
-	if (material->phase_change) {
-		phase1 = &material->phases.find(1)->second;
-		phase2 = &material->phases.find(2)->second;
-	}
-
 	if (tangentCorrection) {
 		CD.resize(nodes->size(), 9);
 		CDe.resize(3, 3);
 	}
 
-	for (size_t n = 0; n < nodes->size(); n++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(n), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		temp = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin];
-		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
-		T(n, 0) = temp;
-		coordinates(n, 0) = p.x;
-		coordinates(n, 1) = p.y;
-		coordinates(n, 2) = p.z;
-		if (material->phase_change) {
-			double phase, derivation;
-			smoothstep(phase, derivation, material->phase_change_temperature - material->transition_interval / 2, material->phase_change_temperature + material->transition_interval / 2, temp, material->smooth_step_order);
-			assembleMaterialMatrix(n, p, phase1, phase, temp, K, CD, tangentCorrection);
-			assembleMaterialMatrix(n, p, phase2, (1 - phase), temp, K, CD, tangentCorrection);
-			m(n, 0) =
-					(    phase  * phase1->density.evaluator->evaluate(p, _step->currentTime, temp) +
-					(1 - phase) * phase2->density.evaluator->evaluate(p, _step->currentTime, temp)) *
+	eslocal size = nodes->size();
+	double time = _step->currentTime;
+	std::vector<Point> points(size);
+	std::vector<double> temps(size);
+	for (eslocal n = 0; n < size; n++) {
+		temps[n] = (*_temperature->decomposedData)[domain][localNodes->at(n)];
+		points[n] = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
+		T(n, 0) = temps[n];
+		coordinates(n, 0) = points[n].x;
+		coordinates(n, 1) = points[n].y;
+		coordinates(n, 2) = points[n].z;
+	}
 
-					(    phase  * phase1->heat_capacity.evaluator->evaluate(p, _step->currentTime, temp) +
-					(1 - phase) * phase2->heat_capacity.evaluator->evaluate(p, _step->currentTime, temp) +
-					material->latent_heat * derivation);
-		} else {
-			assembleMaterialMatrix(n, p, material, 1, temp, K, CD, tangentCorrection);
-			m(n, 0) =
-					material->density.evaluator->evaluate(p, _step->currentTime, temp) *
-					material->heat_capacity.evaluator->evaluate(p, _step->currentTime, temp);
-		}
+	assembleElementMaterial(eindex, size, points.data(), temps.data(), K, m, CD, tangentCorrection);
 
-		if (translation_motion) {
-			U(n, 0) = translation_motion->x.evaluator->evaluate(p, _step->currentTime, temp) * m(n, 0);
-			U(n, 1) = translation_motion->y.evaluator->evaluate(p, _step->currentTime, temp) * m(n, 0);
-			U(n, 2) = translation_motion->z.evaluator->evaluate(p, _step->currentTime, temp) * m(n, 0);
-		}
-		if (heat_source) {
-			f(n, 0) = heat_source->evaluate(p, _step->currentTime, temp);
+	if (translation_motion) {
+		translation_motion->x.evaluator->evaluate(size, 3, points.data(), temps.data(), time, U.values() + 0);
+		translation_motion->y.evaluator->evaluate(size, 3, points.data(), temps.data(), time, U.values() + 1);
+		translation_motion->z.evaluator->evaluate(size, 3, points.data(), temps.data(), time, U.values() + 2);
+		for (eslocal n = 0; n < size; n++) {
+			U(n, 0) *= m(n, 0);
+			U(n, 1) *= m(n, 0);
+			U(n, 2) *= m(n, 0);
 		}
 	}
+	if (heat_source) {
+		heat_source->evaluate(size, points.data(), temps.data(), time, f.values());
+	}
 
 	eslocal Ksize = nodes->size();
 
@@ -374,13 +403,16 @@ void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal e
 	for (size_t gp = 0; gp < N.size(); gp++) {
 		u.multiply(N[gp], U, 1, 0);
 
-		J.multiply(dN[gp], coordinates);
-		detJ = determinant3x3(J.values());
-		if (detJ <= 0) {
-			printInvalidElement(eindex);
-			detJ = -detJ;
+		if (!cachedGeometry(domain, eindex, gp, detJ, dND)) {
+			J.multiply(dN[gp], coordinates);
+			detJ = determinant3x3(J.values());
+			if (detJ <= 0) {
+				printInvalidElement(eindex);
+				detJ = -detJ;
+			}
+			inverse3x3(J.values(), invJ.values(), detJ);
+			dND.multiply(invJ, dN[gp]);
 		}
-		inverse3x3(J.values(), invJ.values(), detJ);
 
 		gpK.multiply(N[gp], K);
 		if (tangentCorrection) {
@@ -407,8 +439,6 @@ void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal e
 		Ce(2, 0) = gpK(0, 7);
 		Ce(2, 1) = gpK(0, 8);
 
-		dND.multiply(invJ, dN[gp]);
-
 		DenseMatrix b_e(1, nodes->size()), b_e_c(1, nodes->size()), g_e(1, nodes->size());
 		b_e.multiply(u, dND, 1, 0);
 		g_e.multiply(g, dND, 1, 0);
@@ -536,6 +566,295 @@ void HeatTransfer3D::processElement(eslocal domain, Matrices matrices, eslocal e
 	}
 }
 
+void HeatTransfer3D::processElements(eslocal domain, Matrices matrices, eslocal begin, eslocal end, int code, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe)
+{
+	bool tangentCorrection = (matrices & Matrices::K) && _step->tangentMatrixCorrection;
+	bool diffusionSplit = (matrices & Matrices::M) && _configuration.diffusion_split;
+
+	if (_configuration.fixed_kernels && !tangentCorrection && !diffusionSplit) {
+		switch (static_cast<Element::CODE>(code)) {
+		case Element::CODE::TETRA4:    processElementsFixed< 4,  4>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::TETRA10:   processElementsFixed<10, 15>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::PYRAMID5:  processElementsFixed< 5,  8>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::PYRAMID13: processElementsFixed<13, 14>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::PRISMA6:   processElementsFixed< 6,  9>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::PRISMA15:  processElementsFixed<15,  9>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::HEXA8:     processElementsFixed< 8,  8>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		case Element::CODE::HEXA20:    processElementsFixed<20,  8>(domain, matrices, begin, end, DOFs, Ke, Me, Re, fe); return;
+		default: break;
+		}
+	}
+	Physics::processElements(domain, matrices, begin, end, code, DOFs, Ke, Me, Re, fe);
+}
+
+template <int nodes, int gps>
+void HeatTransfer3D::processElementsFixed(eslocal domain, Matrices matrices, eslocal begin, eslocal end, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe)
+{
+	const auto &translation_motions = _configuration.load_steps_settings.at(_step->step + 1).translation_motions;
+
+	eslocal batch[ELEMENTS_BATCH];
+	int size = 0;
+	for (eslocal e = begin; e < end; ++e) {
+		// elements with advection use the general kernel (stabilization needs the velocity)
+		if (elementSettings(translation_motions, e) != NULL || _mesh->elements->epointers->datatarray()[e]->N->size() != (size_t)gps) {
+			processElement(domain, matrices, e, Ke, Me, Re, fe);
+			insertElement(domain, e, DOFs, Ke, Me, Re, fe);
+		} else {
+			batch[size++] = e;
+		}
+		if (size == ELEMENTS_BATCH || (size && e + 1 == end)) {
+			processElementsBatch<nodes, gps>(domain, matrices, batch, size, DOFs, Ke, Me, Re, fe);
+			size = 0;
+		}
+	}
+}
+
+template <int nodes, int gps>
+void HeatTransfer3D::processElementsBatch(eslocal domain, Matrices matrices, const eslocal *eindices, int size, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe)
+{
+	const int L = ELEMENTS_BATCH;
+
+	// elements of a batch have the same code, hence the same shape functions
+	auto epointer = _mesh->elements->epointers->datatarray()[eindices[0]];
+	const std::vector<DenseMatrix> &N = *(epointer->N);
+	const std::vector<DenseMatrix> &dN = *(epointer->dN);
+	const std::vector<double> &weighFactor = *(epointer->weighFactor);
+
+	bool computeK = (matrices & Matrices::K) || ((matrices & Matrices::R) && _step->timeIntegrationConstantK != 0);
+	bool computeM = (matrices & Matrices::M) || ((matrices & Matrices::R) && _step->timeIntegrationConstantM != 0);
+
+	// data are stored as structure of arrays, the last index is the element in the batch (SIMD lane)
+	double temps[nodes][L], f[nodes][L], m[nodes][L], K[nodes][9][L], coordinates[nodes][3][L];
+
+	Point points[nodes];
+	double etemps[nodes], ef[nodes];
+	DenseMatrix eK, em, CD;
+	for (int l = 0; l < size; l++) {
+		auto enodes = _mesh->elements->nodes->cbegin() + eindices[l];
+		auto localNodes = _localNodes->cbegin() + eindices[l];
+		Evaluator *heat_source = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).heat_source, eindices[l]);
+
+		for (int n = 0; n < nodes; n++) {
+			etemps[n] = (*_temperature->decomposedData)[domain][localNodes->at(n)];
+			points[n] = _mesh->nodes->coordinates->datatarray()[enodes->at(n)];
+			ef[n] = 0;
+		}
+		eK.resize(nodes, 9);
+		eK = 0;
+		em.resize(nodes, 1);
+		assembleElementMaterial(eindices[l], nodes, points, etemps, eK, em, CD, false);
+		if (heat_source) {
+			heat_source->evaluate(nodes, points, etemps, _step->currentTime, ef);
+		}
+
+		for (int n = 0; n < nodes; n++) {
+			temps[n][l] = etemps[n];
+			f[n][l] = ef[n];
+			m[n][l] = em(n, 0);
+			for (int k = 0; k < 9; k++) {
+				K[n][k][l] = eK(n, k);
+			}
+			coordinates[n][0][l] = points[n].x;
+			coordinates[n][1][l] = points[n].y;
+			coordinates[n][2][l] = points[n].z;
+		}
+	}
+	// unused lanes repeat the first element
+	for (int l = size; l < L; l++) {
+		for (int n = 0; n < nodes; n++) {
+			temps[n][l] = temps[n][0];
+			f[n][l] = f[n][0];
+			m[n][l] = m[n][0];
+			for (int k = 0; k < 9; k++) {
+				K[n][k][l] = K[n][k][0];
+			}
+			for (int d = 0; d < 3; d++) {
+				coordinates[n][d][l] = coordinates[n][d][0];
+			}
+		}
+	}
+
+	// the whole element code is either cached or not
+	bool cached = _geometry != NULL && _geometry->cached(eindices[0]);
+
+	// position of Ce(r, c) in the nodal conductivity (xx, yy, zz, xy, xz, yx, yz, zx, zy)
+	const int C[9] = { 0, 3, 4, 5, 1, 6, 7, 8, 2 };
+
+	double kKe[nodes][nodes][L] = {}, kMe[nodes][nodes][L] = {}, kfe[nodes][L] = {};
+	double J[9][L], invJ[9][L], detJ[L], w[L], gpK[9][L], gpM[L], dND[3][nodes][L], CdND[3][nodes][L];
+
+	for (int gp = 0; gp < gps; gp++) {
+		const double *gpN = N[gp].values(), *gpdN = dN[gp].values();
+
+		if (cached) {
+			for (int l = 0; l < L; l++) {
+				eslocal eindex = eindices[l < size ? l : 0];
+				const double *gradients = _geometry->dND(domain, eindex) + gp * 3 * nodes;
+				detJ[l] = _geometry->detJ(domain, eindex)[gp];
+				for (int i = 0; i < 3; i++) {
+					for (int n = 0; n < nodes; n++) {
+						dND[i][n][l] = gradients[i * nodes + n];
+					}
+				}
+			}
+		} else {
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					#pragma omp simd
+					for (int l = 0; l < L; l++) {
+						J[3 * i + j][l] = 0;
+					}
+					for (int n = 0; n < nodes; n++) {
+						#pragma omp simd
+						for (int l = 0; l < L; l++) {
+							J[3 * i + j][l] += gpdN[i * nodes + n] * coordinates[n][j][l];
+						}
+					}
+				}
+			}
+
+			#pragma omp simd
+			for (int l = 0; l < L; l++) {
+				detJ[l] =
+					+ J[0][l] * J[4][l] * J[8][l]
+					+ J[1][l] * J[5][l] * J[6][l]
+					+ J[2][l] * J[3][l] * J[7][l]
+					- J[2][l] * J[4][l] * J[6][l]
+					- J[1][l] * J[3][l] * J[8][l]
+					- J[0][l] * J[5][l] * J[7][l];
+			}
+			for (int l = 0; l < L; l++) {
+				if (detJ[l] <= 0) {
+					if (l < size) {
+						printInvalidElement(eindices[l]);
+					}
+					detJ[l] = -detJ[l];
+				}
+			}
+
+			#pragma omp simd
+			for (int l = 0; l < L; l++) {
+				double detJx = 1 / detJ[l];
+				invJ[0][l] = detJx * ( J[8][l] * J[4][l] - J[7][l] * J[5][l]);
+				invJ[1][l] = detJx * (-J[8][l] * J[1][l] + J[7][l] * J[2][l]);
+				invJ[2][l] = detJx * ( J[5][l] * J[1][l] - J[4][l] * J[2][l]);
+				invJ[3][l] = detJx * (-J[8][l] * J[3][l] + J[6][l] * J[5][l]);
+				invJ[4][l] = detJx * ( J[8][l] * J[0][l] - J[6][l] * J[2][l]);
+				invJ[5][l] = detJx * (-J[5][l] * J[0][l] + J[3][l] * J[2][l]);
+				invJ[6][l] = detJx * ( J[7][l] * J[3][l] - J[6][l] * J[4][l]);
+				invJ[7][l] = detJx * (-J[7][l] * J[0][l] + J[6][l] * J[1][l]);
+				invJ[8][l] = detJx * ( J[4][l] * J[0][l] - J[3][l] * J[1][l]);
+			}
+
+			for (int i = 0; i < 3; i++) {
+				for (int n = 0; n < nodes; n++) {
+					#pragma omp simd
+					for (int l = 0; l < L; l++) {
+						dND[i][n][l] = invJ[3 * i + 0][l] * gpdN[0 * nodes + n] + invJ[3 * i + 1][l] * gpdN[1 * nodes + n] + invJ[3 * i + 2][l] * gpdN[2 * nodes + n];
+					}
+				}
+			}
+		}
+
+		#pragma omp simd
+		for (int l = 0; l < L; l++) {
+			w[l] = detJ[l] * weighFactor[gp];
+			gpM[l] = 0;
+			for (int k = 0; k < 9; k++) {
+				gpK[k][l] = 0;
+			}
+		}
+		for (int n = 0; n < nodes; n++) {
+			for (int k = 0; k < 9; k++) {
+				#pragma omp simd
+				for (int l = 0; l < L; l++) {
+					gpK[k][l] += gpN[n] * K[n][k][l];
+				}
+			}
+			#pragma omp simd
+			for (int l = 0; l < L; l++) {
+				gpM[l] += gpN[n] * m[n][l];
+			}
+		}
+
+		if (computeM) {
+			for (int r = 0; r < nodes; r++) {
+				for (int c = 0; c < nodes; c++) {
+					#pragma omp simd
+					for (int l = 0; l < L; l++) {
+						kMe[r][c][l] += w[l] * gpM[l] * gpN[r] * gpN[c];
+					}
+				}
+			}
+		}
+		if (computeK) {
+			for (int i = 0; i < 3; i++) {
+				for (int n = 0; n < nodes; n++) {
+					#pragma omp simd
+					for (int l = 0; l < L; l++) {
+						CdND[i][n][l] = gpK[C[3 * i + 0]][l] * dND[0][n][l] + gpK[C[3 * i + 1]][l] * dND[1][n][l] + gpK[C[3 * i + 2]][l] * dND[2][n][l];
+					}
+				}
+			}
+			for (int r = 0; r < nodes; r++) {
+				for (int c = 0; c < nodes; c++) {
+					#pragma omp simd
+					for (int l = 0; l < L; l++) {
+						kKe[r][c][l] += w[l] * (dND[0][r][l] * CdND[0][c][l] + dND[1][r][l] * CdND[1][c][l] + dND[2][r][l] * CdND[2][c][l]);
+					}
+				}
+			}
+		}
+		if (matrices & Matrices::f) {
+			for (int n = 0; n < nodes; n++) {
+				#pragma omp simd
+				for (int l = 0; l < L; l++) {
+					kfe[n][l] += w[l] * gpN[n] * f[n][l];
+				}
+			}
+		}
+	}
+
+	for (int l = 0; l < size; l++) {
+		Ke.resize(0, 0);
+		Me.resize(0, 0);
+		Re.resize(0, 0);
+		fe.resize(0, 0);
+		if (matrices & Matrices::K) {
+			Ke.resize(nodes, nodes);
+			for (int r = 0; r < nodes; r++) {
+				for (int c = 0; c < nodes; c++) {
+					Ke(r, c) = kKe[r][c][l];
+				}
+			}
+		}
+		if (matrices & Matrices::M) {
+			Me.resize(nodes, nodes);
+			for (int r = 0; r < nodes; r++) {
+				for (int c = 0; c < nodes; c++) {
+					Me(r, c) = kMe[r][c][l];
+				}
+			}
+		}
+		if (matrices & Matrices::R) {
+			Re.resize(nodes, 1);
+			for (int r = 0; r < nodes; r++) {
+				Re(r, 0) = 0;
+				for (int c = 0; c < nodes; c++) {
+					Re(r, 0) += _step->timeIntegrationConstantK * kKe[r][c][l] * temps[c][l] + _step->timeIntegrationConstantM * kMe[r][c][l] * temps[c][l];
+				}
+			}
+		}
+		if (matrices & Matrices::f) {
+			fe.resize(nodes, 1);
+			for (int n = 0; n < nodes; n++) {
+				fe(n, 0) = kfe[n][l];
+			}
+		}
+		insertElement(domain, eindices[l], DOFs, Ke, Me, Re, fe);
+	}
+}
+
 void HeatTransfer3D::processFace(eslocal domain, const BoundaryRegionStore *region, Matrices matrices, eslocal findex, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe) const
 {
 	const ConvectionConfiguration *convection = NULL;
@@ -578,7 +897,7 @@ void HeatTransfer3D::processFace(eslocal domain, const BoundaryRegionStore *regi
 
 	auto nodes = region->elements->cbegin() + findex;
 	auto epointer = region->epointers->datatarray()[findex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = boundaryLocalNodes(region)->cbegin() + findex;
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -605,8 +924,7 @@ void HeatTransfer3D::processFace(eslocal domain, const BoundaryRegionStore *regi
 	}
 
 	for (size_t n = 0; n < nodes->size(); n++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(n), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		temp = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(n) - it->begin];
+		temp = (*_temperature->decomposedData)[domain][localNodes->at(n)];
 		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(n)];
 		coordinates(n, 0) = p.x;
 		coordinates(n, 1) = p.y;
@@ -766,15 +1084,9 @@ void HeatTransfer3D::postProcessElement(eslocal domain, eslocal eindex)
 {
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+	auto localNodes = _localNodes->cbegin() + eindex;
 	const ECFExpressionVector *translation_motion = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).translation_motions.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).translation_motions.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			translation_motion = &it->second;
-			break;
-		}
-	}
+	translation_motion = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).translation_motions, eindex);
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
 	const std::vector<DenseMatrix> &dN = *(epointer->dN);
@@ -795,32 +1107,37 @@ void HeatTransfer3D::postProcessElement(eslocal domain, eslocal eindex)
 
 	coordinates.resize(nodes->size(), 3);
 
-	for (size_t i = 0; i < nodes->size(); i++) {
-		auto it = std::lower_bound(intervals.begin(), intervals.end(), nodes->at(i), [] (const DomainInterval &interval, eslocal node) { return interval.end < node; });
-		temp(i, 0) = (*_temperature->decomposedData)[domain][it->DOFOffset + nodes->at(i) - it->begin];
-		const Point &p = _mesh->nodes->coordinates->datatarray()[nodes->at(i)];
-		coordinates(i, 0) = p.x;
-		coordinates(i, 1) = p.y;
-		coordinates(i, 2) = p.z;
-		if (material->phase_change) {
-			double phase, derivation;
-			smoothstep(phase, derivation, material->phase_change_temperature - material->transition_interval / 2, material->phase_change_temperature + material->transition_interval / 2, temp(i, 0), material->smooth_step_order);
-			assembleMaterialMatrix(i, p, phase1, phase, temp(i, 0), K, CD, false);
-			assembleMaterialMatrix(i, p, phase2, (1 - phase), temp(i, 0), K, CD, false);
+	eslocal size = nodes->size();
+	double time = _step->currentTime;
+	std::vector<Point> points(size);
+	for (eslocal i = 0; i < size; i++) {
+		temp(i, 0) = (*_temperature->decomposedData)[domain][localNodes->at(i)];
+		points[i] = _mesh->nodes->coordinates->datatarray()[nodes->at(i)];
+		coordinates(i, 0) = points[i].x;
+		coordinates(i, 1) = points[i].y;
+		coordinates(i, 2) = points[i].z;
+	}
 
+	if (material->phase_change) {
+		std::vector<double> phase(size), complement(size), derivation(size);
+		for (eslocal i = 0; i < size; i++) {
+			smoothstep(phase[i], derivation[i], material->phase_change_temperature - material->transition_interval / 2, material->phase_change_temperature + material->transition_interval / 2, temp(i, 0), material->smooth_step_order);
+			complement[i] = 1 - phase[i];
 			if (_phaseChange) {
-				(*_phaseChange->decomposedData)[domain][it->DOFOffset + nodes->at(i) - it->begin] = phase;
-				(*_latentHeat->decomposedData)[domain][it->DOFOffset + nodes->at(i) - it->begin] = material->latent_heat * derivation;
+				(*_phaseChange->decomposedData)[domain][localNodes->at(i)] = phase[i];
+				(*_latentHeat->decomposedData)[domain][localNodes->at(i)] = material->latent_heat * derivation[i];
 			}
-		} else {
-			assembleMaterialMatrix(i, p, material, 1, temp(i, 0), K, CD, false);
 		}
+		assembleMaterialMatrix(size, points.data(), temp.values(), phase1, phase.data(), K, CD, false);
+		assembleMaterialMatrix(size, points.data(), temp.values(), phase2, complement.data(), K, CD, false);
+	} else {
+		assembleMaterialMatrix(size, points.data(), temp.values(), material, NULL, K, CD, false);
+	}
 
-		if (translation_motion) {
-			U(i, 0) = translation_motion->x.evaluator->evaluate(p, _step->currentTime, temp(i, 0));
-			U(i, 1) = translation_motion->y.evaluator->evaluate(p, _step->currentTime, temp(i, 0));
-			U(i, 2) = translation_motion->z.evaluator->evaluate(p, _step->currentTime, temp(i, 0));
-		}
+	if (translation_motion) {
+		translation_motion->x.evaluator->evaluate(size, 3, points.data(), temp.values(), time, U.values() + 0);
+		translation_motion->y.evaluator->evaluate(size, 3, points.data(), temp.values(), time, U.values() + 1);
+		translation_motion->z.evaluator->evaluate(size, 3, points.data(), temp.values(), time, U.values() + 2);
 	}
 
 	for (size_t gp = 0; gp < N.size(); gp++) {
@@ -895,6 +1212,8 @@ void HeatTransfer3D::processBEMSolution(eslocal domain)
 
 void HeatTransfer3D::processSolution()
 {
+	resolveElementSettings();
+
 	if (_hasBEM) {
 		#pragma omp parallel for
 		for (eslocal d = 0; d < _mesh->elements->ndomains; d++) {
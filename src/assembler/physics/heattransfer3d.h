@@ -22,7 +22,19 @@ struct HeatTransfer3D: public HeatTransfer, public Physics3D
 	void processBEMSolution(eslocal domain);
 
 protected:
-	void assembleMaterialMatrix(eslocal node, const Point &p, const MaterialBaseConfiguration *mat, double phase, double temp, DenseMatrix &K, DenseMatrix &CD, bool tangentCorrection) const;
+	void processElements(eslocal domain, Matrices matrices, eslocal begin, eslocal end, int code, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe);
+
+	// kernel with compile-time number of nodes and Gauss points for elements without advection and tangent correction
+	template <int nodes, int gps>
+	void processElementsFixed(eslocal domain, Matrices matrices, eslocal begin, eslocal end, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe);
+	// process up to ELEMENTS_BATCH elements together, each element is computed in its own SIMD lane
+	template <int nodes, int gps>
+	void processElementsBatch(eslocal domain, Matrices matrices, const eslocal *eindices, int size, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe);
+
+	// evaluate nodal conductivity (nodes x 9) and density * heat capacity of an element
+	void assembleElementMaterial(eslocal eindex, eslocal size, const Point *points, const double *temps, DenseMatrix &K, DenseMatrix &m, DenseMatrix &CD, bool tangentCorrection) const;
+	// evaluate material parameters in all nodes at once ('phase' == NULL for materials without phase change)
+	void assembleMaterialMatrix(eslocal size, const Point *p, const double *temp, const MaterialBaseConfiguration *mat, const double *phase, DenseMatrix &K, DenseMatrix &CD, bool tangentCorrection) const;
 	void postProcessElement(eslocal domain, eslocal eindex);
 };
 
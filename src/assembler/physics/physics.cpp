@@ -1,5 +1,6 @@
 
 #include "physics.h"
+#include "geometrycache.h"
 
 #include "../../basis/containers/serializededata.h"
 #include "../../basis/utilities/utils.h"
@@ -18,9 +19,7 @@
 #include "../../mesh/store/elementsregionstore.h"
 
 #include "../../solver/generic/SparseMatrix.h"
-#include "../../basis/matrices/sparseVVPMatrix.h"
 #include "../../basis/matrices/denseMatrix.h"
-#include "../../basis/matrices/sparseCSRMatrix.h"
 #include "../../config/ecf/solver/feti.h"
 #include "../../config/ecf/physics/physics.h"
 
@@ -31,13 +30,13 @@
 using namespace espreso;
 
 Physics::Physics()
-: _name(""), _mesh(NULL), _instance(NULL), _step(NULL), _constraints(NULL), _configuration(NULL), _DOFs(0), _invalidElements(0)
+: _name(""), _mesh(NULL), _instance(NULL), _step(NULL), _constraints(NULL), _configuration(NULL), _DOFs(0), _localNodes(NULL), _geometry(NULL), _invalidElements(0)
 {
 
 }
 
 Physics::Physics(const std::string &name, Mesh *mesh, Instance *instance, Step *step, const PhysicsConfiguration *configuration, int DOFs)
-: _name(name), _mesh(mesh), _instance(instance), _step(step), _constraints(NULL), _configuration(configuration), _DOFs(DOFs), _invalidElements(0) // initialized in a particular physics
+: _name(name), _mesh(mesh), _instance(instance), _step(step), _constraints(NULL), _configuration(configuration), _DOFs(DOFs), _localNodes(NULL), _geometry(NULL), _invalidElements(0) // initialized in a particular physics
 {
 	std::vector<int> BEMRegions(_mesh->elements->regionMaskSize);
 	for (auto it = configuration->discretization.begin(); it != configuration->discretization.end(); ++it) {
@@ -62,6 +61,13 @@ Physics::Physics(const std::string &name, Mesh *mesh, Instance *instance, Step *
 	}
 
 	_BEMData.resize(mesh->elements->ndomains, NULL);
+	_patterns.resize(mesh->elements->ndomains);
+
+	if (configuration->geometry_cache) {
+		_geometry = new GeometryCache(_mesh, configuration->geometry_cache * 1024 * 1024);
+	}
+
+	computeLocalNodes();
 }
 
 Physics::~Physics()
@@ -69,6 +75,17 @@ Physics::~Physics()
 	if (_constraints != NULL) {
 		delete _constraints;
 	}
+	if (_localNodes != NULL) {
+		delete _localNodes;
+	}
+	if (_geometry != NULL) {
+		delete _geometry;
+	}
+	for (size_t r = 0; r < _boundaryLocalNodes.size(); r++) {
+		if (_boundaryLocalNodes[r] != NULL) {
+			delete _boundaryLocalNodes[r];
+		}
+	}
 #ifdef BEM4I
 	for (size_t i = 0; i < _BEMData.size(); i++) {
 		if (_BEMData[i] != NULL) {
@@ -80,7 +97,11 @@ Physics::~Physics()
 
 void Physics::printInvalidElement(eslocal eindex) const
 {
-	if (_invalidElements++ == 0) {
+	size_t invalid;
+	#pragma omp atomic capture
+	invalid = _invalidElements++;
+
+	if (invalid == 0) {
 		auto nodes = _mesh->elements->nodes->begin() + eindex;
 
 		std::ofstream os("invalidElement.vtk");
@@ -144,8 +165,24 @@ void Physics::printInvalidElement(eslocal eindex) const
 	}
 }
 
+bool Physics::cachedGeometry(eslocal domain, eslocal eindex, size_t gp, double &detJ, DenseMatrix &dND) const
+{
+	if (_geometry == NULL || !_geometry->cached(eindex)) {
+		return false;
+	}
+
+	const DenseMatrix &dN = (*_mesh->elements->epointers->datatarray()[eindex]->dN)[gp];
+	const double *gradients = _geometry->dND(domain, eindex) + gp * dN.rows() * dN.columns();
+	dND.resize(dN.rows(), dN.columns());
+	std::copy(gradients, gradients + dN.rows() * dN.columns(), dND.values());
+	detJ = _geometry->detJ(domain, eindex)[gp];
+	return true;
+}
+
 void Physics::updateMatrix(Matrices matrix)
 {
+	resolveElementSettings();
+
 	#pragma omp parallel for
 	for  (size_t d = 0; d < _instance->domains; d++) {
 
@@ -154,8 +191,13 @@ void Physics::updateMatrix(Matrices matrix)
 		switch (_instance->K[d].mtype) {
 		case MatrixType::REAL_SYMMETRIC_POSITIVE_DEFINITE:
 		case MatrixType::REAL_SYMMETRIC_INDEFINITE:
-			_instance->K[d].RemoveLower();
-			_instance->M[d].RemoveLower();
+			// matrices assembled according to a symmetric pattern contain only upper triangle
+			if (_instance->K[d].type != 'S') {
+				_instance->K[d].RemoveLower();
+			}
+			if (_instance->M[d].type != 'S') {
+				_instance->M[d].RemoveLower();
+			}
 			break;
 		case MatrixType::REAL_UNSYMMETRIC:
 			break;
@@ -174,7 +216,7 @@ void Physics::updateMatrix(Matrices matrix)
 
 void Physics::updateMatrix(Matrices matrices, size_t domain)
 {
-	SparseVVPMatrix<eslocal> _K, _M;
+	SparseMatrix &K = _instance->K[domain], &M = _instance->M[domain];
 
 	if (matrices & Matrices::f) {
 		_instance->f[domain].clear();
@@ -189,14 +231,23 @@ void Physics::updateMatrix(Matrices matrices, size_t domain)
 			ESINFO(ERROR) << "BEM not support computation of matrix R.";
 		}
 		processBEM(domain, matrices);
-		_instance->K[domain].ConvertDenseToCSR(1);
-		assembleBoundaryConditions(_K, _M, matrices & Matrices::f, domain);
+		K.ConvertDenseToCSR(1);
+		assembleBoundaryConditions(K, M, matrices & Matrices::f, domain);
 	} else {
+		MatrixType mtype = getMatrixType(domain);
+		bool symmetric = mtype != MatrixType::REAL_UNSYMMETRIC;
+		if (matrices & (Matrices::K | Matrices::M)) {
+			if (!_patterns[domain].initialized || _patterns[domain].symmetric != symmetric) {
+				buildDomainPattern(domain, symmetric);
+			}
+		}
 		if (matrices & Matrices::K) {
-			_K.resize(_instance->domainDOFCount[domain], _instance->domainDOFCount[domain]);
+			initMatrixFromPattern(K, domain);
+			K.mtype = mtype;
 		}
 		if (matrices & Matrices::M) {
-			_M.resize(_instance->domainDOFCount[domain], _instance->domainDOFCount[domain]);
+			initMatrixFromPattern(M, domain);
+			M.mtype = MatrixType::REAL_SYMMETRIC_POSITIVE_DEFINITE;
 		}
 		if (matrices & Matrices::R) {
 			_instance->R[domain].clear();
@@ -206,28 +257,115 @@ void Physics::updateMatrix(Matrices matrices, size_t domain)
 		std::vector<eslocal> DOFs;
 		DenseMatrix Ke, Me, Re, fe;
 
-		auto nodes = _mesh->elements->nodes->cbegin() + _mesh->elements->elementsDistribution[domain];
-		for (eslocal e = _mesh->elements->elementsDistribution[domain]; e < (eslocal)_mesh->elements->elementsDistribution[domain + 1]; ++e, ++nodes) {
-			processElement(domain, matrices, e, Ke, Me, Re, fe);
-			fillDOFsIndices(*nodes, domain, DOFs);
-			insertElementToDomain(_K, _M, DOFs, Ke, Me, Re, fe, domain, false);
+		if (_geometry != NULL) {
+			_geometry->prepare(domain, [&] (eslocal eindex) { printInvalidElement(eindex); });
 		}
-		assembleBoundaryConditions(_K, _M, matrices, domain);
-		// TODO: make it direct
-		if (matrices & Matrices::K) {
-			SparseCSRMatrix<eslocal> csrK = _K;
-			_instance->K[domain] = csrK;
-			_instance->K[domain].mtype = getMatrixType(domain);
+
+		for (eslocal i = _mesh->elements->eintervalsDistribution[domain]; i < _mesh->elements->eintervalsDistribution[domain + 1]; i++) {
+			const ElementsInterval &interval = _mesh->elements->eintervals[i];
+			processElements(domain, matrices, interval.begin, interval.end, interval.code, DOFs, Ke, Me, Re, fe);
 		}
-		if (matrices & Matrices::M) {
-			SparseCSRMatrix<eslocal> csrM = _M;
-			_instance->M[domain] = csrM;
-			_instance->M[domain].mtype = MatrixType::REAL_SYMMETRIC_POSITIVE_DEFINITE;
+		assembleBoundaryConditions(K, M, matrices, domain);
+	}
+}
+
+void Physics::processElements(eslocal domain, Matrices matrices, eslocal begin, eslocal end, int code, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe)
+{
+	for (eslocal e = begin; e < end; ++e) {
+		processElement(domain, matrices, e, Ke, Me, Re, fe);
+		insertElement(domain, e, DOFs, Ke, Me, Re, fe);
+	}
+}
+
+void Physics::insertElement(eslocal domain, eslocal eindex, std::vector<eslocal> &DOFs, const DenseMatrix &Ke, const DenseMatrix &Me, const DenseMatrix &Re, const DenseMatrix &fe)
+{
+	const DomainPattern &pattern = _patterns[domain];
+	auto nodes = _localNodes->cbegin() + eindex;
+	fillDOFsIndices(*nodes, DOFs);
+	const eslocal *positions = pattern.initialized ? pattern.positions.data() + pattern.elementOffset[eindex - _mesh->elements->elementsDistribution[domain]] : NULL;
+	insertElementToDomain(_instance->K[domain], _instance->M[domain], DOFs, positions, Ke, Me, Re, fe, domain, false);
+}
+
+void Physics::buildDomainPattern(size_t domain, bool symmetric)
+{
+	DomainPattern &pattern = _patterns[domain];
+	std::vector<eslocal> DOFs;
+	std::vector<std::vector<eslocal> > columns(_instance->domainDOFCount[domain]);
+
+	eslocal ebegin = _mesh->elements->elementsDistribution[domain];
+	eslocal eend = _mesh->elements->elementsDistribution[domain + 1];
+
+	pattern.elementOffset.clear();
+	pattern.elementOffset.reserve(eend - ebegin + 1);
+	pattern.elementOffset.push_back(0);
+
+	auto nodes = _localNodes->cbegin() + ebegin;
+	for (eslocal e = ebegin; e < eend; ++e, ++nodes) {
+		fillDOFsIndices(*nodes, DOFs);
+		for (size_t r = 0; r < DOFs.size(); r++) {
+			for (size_t c = 0; c < DOFs.size(); c++) {
+				if (!symmetric || DOFs[r] <= DOFs[c]) {
+					columns[DOFs[r]].push_back(DOFs[c]);
+				}
+			}
+		}
+		pattern.elementOffset.push_back(pattern.elementOffset.back() + DOFs.size() * DOFs.size());
+	}
+
+	pattern.rows.clear();
+	pattern.columns.clear();
+	pattern.rows.reserve(columns.size() + 1);
+	pattern.rows.push_back(1);
+	for (size_t r = 0; r < columns.size(); r++) {
+		Esutils::sortAndRemoveDuplicity(columns[r]);
+		for (size_t c = 0; c < columns[r].size(); c++) {
+			pattern.columns.push_back(columns[r][c] + 1);
+		}
+		pattern.rows.push_back(pattern.columns.size() + 1);
+		std::vector<eslocal>().swap(columns[r]);
+	}
+
+	pattern.positions.resize(pattern.elementOffset.back());
+	nodes = _localNodes->cbegin() + ebegin;
+	for (eslocal e = ebegin; e < eend; ++e, ++nodes) {
+		fillDOFsIndices(*nodes, DOFs);
+		eslocal *positions = pattern.positions.data() + pattern.elementOffset[e - ebegin];
+		for (size_t r = 0, i = 0; r < DOFs.size(); r++) {
+			auto begin = pattern.columns.begin() + pattern.rows[DOFs[r]] - 1;
+			auto end = pattern.columns.begin() + pattern.rows[DOFs[r] + 1] - 1;
+			for (size_t c = 0; c < DOFs.size(); c++, i++) {
+				if (!symmetric || DOFs[r] <= DOFs[c]) {
+					positions[i] = std::lower_bound(begin, end, DOFs[c] + 1) - pattern.columns.begin();
+				} else {
+					positions[i] = -1;
+				}
+			}
 		}
 	}
+
+	pattern.symmetric = symmetric;
+	pattern.initialized = true;
+}
+
+void Physics::initMatrixFromPattern(SparseMatrix &A, size_t domain) const
+{
+	const DomainPattern &pattern = _patterns[domain];
+
+	// keep already allocated pattern (and hence pointers imported to solvers) if it is not changed
+	if (A.CSR_I_row_indices != pattern.rows || A.CSR_J_col_indices != pattern.columns) {
+		A.CSR_I_row_indices = pattern.rows;
+		A.CSR_J_col_indices = pattern.columns;
+	}
+	A.CSR_V_values.assign(pattern.columns.size(), 0);
+
+	A.rows = pattern.rows.size() - 1;
+	A.cols = pattern.rows.size() - 1;
+	A.nnz = pattern.columns.size();
+	A.type = pattern.symmetric ? 'S' : 'G';
+	A.USE_FLOAT = false;
 }
 
-void Physics::assembleBoundaryConditions(SparseVVPMatrix<eslocal> &K, SparseVVPMatrix<eslocal> &M, Matrices matrices, size_t domain)
+void Physics::assembleBoundaryConditions(SparseMatrix &K, SparseMatrix &M, Matrices matrices, size_t domain)
 {
 	DenseMatrix Ke, fe, Me(0, 0), Re(0, 0);
 	std::vector<eslocal> DOFs;
@@ -237,11 +375,11 @@ void Physics::assembleBoundaryConditions(SparseVVPMatrix<eslocal> &K, SparseVVPM
 			if (_mesh->boundaryRegions[r]->eintervalsDistribution[domain] < _mesh->boundaryRegions[r]->eintervalsDistribution[domain + 1]) {
 				eslocal begin = _mesh->boundaryRegions[r]->eintervals[_mesh->boundaryRegions[r]->eintervalsDistribution[domain]].begin;
 				eslocal end = _mesh->boundaryRegions[r]->eintervals[_mesh->boundaryRegions[r]->eintervalsDistribution[domain + 1] - 1].end;
-				auto nodes = _mesh->boundaryRegions[r]->elements->cbegin() + begin;
+				auto nodes = _boundaryLocalNodes[r]->cbegin() + begin;
 				for (eslocal i = begin; i < end; ++i, ++nodes) {
 					processFace(domain, _mesh->boundaryRegions[r], matrices, i, Ke, Me, Re, fe);
-					fillDOFsIndices(*nodes, domain, DOFs);
-					insertElementToDomain(K, M, DOFs, Ke, Me, Re, fe, domain, true);
+					fillDOFsIndices(*nodes, DOFs);
+					insertElementToDomain(K, M, DOFs, NULL, Ke, Me, Re, fe, domain, true);
 				}
 			}
 		}
@@ -249,11 +387,11 @@ void Physics::assembleBoundaryConditions(SparseVVPMatrix<eslocal> &K, SparseVVPM
 			if (_mesh->boundaryRegions[r]->eintervalsDistribution[domain] < _mesh->boundaryRegions[r]->eintervalsDistribution[domain + 1]) {
 				eslocal begin = _mesh->boundaryRegions[r]->eintervals[_mesh->boundaryRegions[r]->eintervalsDistribution[domain]].begin;
 				eslocal end = _mesh->boundaryRegions[r]->eintervals[_mesh->boundaryRegions[r]->eintervalsDistribution[domain + 1] - 1].end;
-				auto nodes = _mesh->boundaryRegions[r]->elements->cbegin() + begin;
+				auto nodes = _boundaryLocalNodes[r]->cbegin() + begin;
 				for (eslocal i = begin; i < end; ++i, ++nodes) {
 					processEdge(domain, _mesh->boundaryRegions[r], matrices, i, Ke, Me, Re, fe);
-					fillDOFsIndices(*nodes, domain, DOFs);
-					insertElementToDomain(K, M, DOFs, Ke, Me, Re, fe, domain, true);
+					fillDOFsIndices(*nodes, DOFs);
+					insertElementToDomain(K, M, DOFs, NULL, Ke, Me, Re, fe, domain, true);
 				}
 			}
 		}
@@ -273,29 +411,138 @@ void Physics::assembleBoundaryConditions(SparseVVPMatrix<eslocal> &K, SparseVVPM
 	}
 }
 
+void Physics::resolveElementRegions(const void *settings, const std::vector<std::pair<std::string, const void*> > &regions)
+{
+	auto it = _elementSettings.find(settings);
+	if (it != _elementSettings.end() && it->second.step == _step->step) {
+		return;
+	}
+
+	// settings of previous load steps are not requested anymore
+	for (auto stale = _elementSettings.begin(); stale != _elementSettings.end();) {
+		if (stale->second.step != _step->step) {
+			stale = _elementSettings.erase(stale);
+		} else {
+			++stale;
+		}
+	}
+
+	ElementSettings &resolved = _elementSettings[settings];
+	resolved.step = _step->step;
+	resolved.values.clear();
+	resolved.regions.clear();
+	if (regions.size() == 0) {
+		return;
+	}
+
+	resolved.regions.resize(_mesh->elements->size, -1);
+	for (size_t r = 0; r < regions.size(); r++) {
+		ElementsRegionStore *region = _mesh->eregion(regions[r].first);
+		resolved.values.push_back(regions[r].second);
+		for (auto e = region->elements->datatarray().cbegin(); e != region->elements->datatarray().cend(); ++e) {
+			if (resolved.regions[*e] == -1) {
+				resolved.regions[*e] = r;
+			}
+		}
+	}
+}
+
+const void* Physics::elementSettings(const void *settings, eslocal eindex) const
+{
+	auto it = _elementSettings.find(settings);
+	if (it == _elementSettings.end() || it->second.step != _step->step) {
+		ESINFO(ERROR) << "ESPRESO internal error: request for settings of not resolved elements regions.";
+	}
+	if (it->second.regions.size() == 0 || it->second.regions[eindex] == -1) {
+		return NULL;
+	}
+	return it->second.values[it->second.regions[eindex]];
+}
+
+void Physics::computeLocalNodes()
+{
+	auto localIndex = [&] (eslocal domain, eslocal node) {
+		const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
+		auto it = std::lower_bound(intervals.begin(), intervals.end(), node, [] (const DomainInterval &interval, eslocal node) { return interval.end <= node; });
+		return it->DOFOffset + node - it->begin;
+	};
+
+	_localNodes = new serializededata<eslocal, eslocal>(*_mesh->elements->nodes);
+
+	#pragma omp parallel for
+	for (eslocal d = 0; d < _mesh->elements->ndomains; d++) {
+		auto nodes = _mesh->elements->nodes->cbegin() + _mesh->elements->elementsDistribution[d];
+		auto local = _localNodes->begin() + _mesh->elements->elementsDistribution[d];
+		for (eslocal e = _mesh->elements->elementsDistribution[d]; e < (eslocal)_mesh->elements->elementsDistribution[d + 1]; ++e, ++nodes, ++local) {
+			for (size_t n = 0; n < nodes->size(); n++) {
+				local->at(n) = localIndex(d, nodes->at(n));
+			}
+		}
+	}
+
+	_boundaryLocalNodes.resize(_mesh->boundaryRegions.size(), NULL);
+	for (size_t r = 0; r < _mesh->boundaryRegions.size(); r++) {
+		const BoundaryRegionStore *region = _mesh->boundaryRegions[r];
+		if (region->dimension == 0 || region->elements == NULL) {
+			continue;
+		}
+		_boundaryLocalNodes[r] = new serializededata<eslocal, eslocal>(*region->elements);
+
+		#pragma omp parallel for
+		for (eslocal d = 0; d < _mesh->elements->ndomains; d++) {
+			for (eslocal i = region->eintervalsDistribution[d]; i < region->eintervalsDistribution[d + 1]; i++) {
+				auto nodes = region->elements->cbegin() + region->eintervals[i].begin;
+				auto local = _boundaryLocalNodes[r]->begin() + region->eintervals[i].begin;
+				for (eslocal e = region->eintervals[i].begin; e < region->eintervals[i].end; ++e, ++nodes, ++local) {
+					for (size_t n = 0; n < nodes->size(); n++) {
+						local->at(n) = localIndex(d, nodes->at(n));
+					}
+				}
+			}
+		}
+	}
+}
+
+const serializededata<eslocal, eslocal>* Physics::boundaryLocalNodes(const BoundaryRegionStore *region) const
+{
+	return _boundaryLocalNodes[std::find(_mesh->boundaryRegions.begin(), _mesh->boundaryRegions.end(), region) - _mesh->boundaryRegions.begin()];
+}
+
 /**
  *
  * The method assumed that element matrix is composed in the following order:
  * x1, x2, x3, ..., y1, y2, y3, ..., z1, z2, z3,...
  *
  */
-void Physics::fillDOFsIndices(edata<const eslocal> &nodes, eslocal domain, std::vector<eslocal> &DOFs) const
+void Physics::fillDOFsIndices(edata<const eslocal> &localNodes, std::vector<eslocal> &DOFs) const
 {
-	// TODO: improve performance
-	const std::vector<DomainInterval> &intervals = _mesh->nodes->dintervals[domain];
-	DOFs.resize(_DOFs * nodes.size());
+	DOFs.resize(_DOFs * localNodes.size());
 	size_t i = 0;
 	for (int dof = 0; dof < _DOFs; dof++) {
-		for (auto n = nodes.begin(); n != nodes.end(); n++) {
-			auto it = std::lower_bound(intervals.begin(), intervals.end(), *n, [] (const DomainInterval &interval, eslocal node) { return interval.end <= node; });
-			DOFs[i++] = _DOFs * (it->DOFOffset + *n - it->begin) + dof;
+		for (auto n = localNodes.begin(); n != localNodes.end(); n++) {
+			DOFs[i++] = _DOFs * *n + dof;
 		}
 	}
 }
 
+// position of the value A(row, column) in CSR values (-1 for not stored lower triangle)
+static eslocal findPosition(const SparseMatrix &A, eslocal row, eslocal column)
+{
+	if (A.type == 'S' && column < row) {
+		return -1;
+	}
+	auto begin = A.CSR_J_col_indices.begin() + A.CSR_I_row_indices[row] - A.CSR_I_row_indices[0];
+	auto end = A.CSR_J_col_indices.begin() + A.CSR_I_row_indices[row + 1] - A.CSR_I_row_indices[0];
+	auto it = std::lower_bound(begin, end, column + A.CSR_I_row_indices[0]);
+	if (it == end || *it != column + A.CSR_I_row_indices[0]) {
+		ESINFO(ERROR) << "ESPRESO internal error: value (" << row << "," << column << ") is not in the pattern of the assembled matrix.";
+	}
+	return it - A.CSR_J_col_indices.begin();
+}
+
 void Physics::insertElementToDomain(
-		SparseVVPMatrix<eslocal> &K, SparseVVPMatrix<eslocal> &M,
-		const std::vector<eslocal> &DOFs,
+		SparseMatrix &K, SparseMatrix &M,
+		const std::vector<eslocal> &DOFs, const eslocal *positions,
 		const DenseMatrix &Ke, const DenseMatrix &Me, const DenseMatrix &Re, const DenseMatrix &fe,
 		size_t domain, bool isBOundaryCondition)
 {
@@ -303,9 +550,12 @@ void Physics::insertElementToDomain(
 	double Kreduction = isBOundaryCondition ? RHSreduction : 1;
 
 	if (Ke.rows() == DOFs.size() && Ke.columns() == DOFs.size()) {
-		for (size_t r = 0; r < DOFs.size(); r++) {
-			for (size_t c = 0; c < DOFs.size(); c++) {
-				K(DOFs[r], DOFs[c]) = Kreduction * Ke(r, c);
+		for (size_t r = 0, i = 0; r < DOFs.size(); r++) {
+			for (size_t c = 0; c < DOFs.size(); c++, i++) {
+				eslocal position = positions != NULL ? positions[i] : findPosition(K, DOFs[r], DOFs[c]);
+				if (position != -1) {
+					K.CSR_V_values[position] += Kreduction * Ke(r, c);
+				}
 			}
 		}
 	} else {
@@ -319,7 +569,11 @@ void Physics::insertElementToDomain(
 		for (size_t m = 0; m < multiplicity; m++) {
 			for (size_t r = 0; r < Me.rows(); r++) {
 				for (size_t c = 0; c < Me.columns(); c++) {
-					M(DOFs[r * multiplicity + m], DOFs[c * multiplicity + m]) = Me(r, c);
+					size_t row = r * multiplicity + m, column = c * multiplicity + m;
+					eslocal position = positions != NULL ? positions[row * DOFs.size() + column] : findPosition(M, DOFs[row], DOFs[column]);
+					if (position != -1) {
+						M.CSR_V_values[position] += Me(r, c);
+					}
 				}
 			}
 		}
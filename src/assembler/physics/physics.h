@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <string>
 #include <vector>
+#include <map>
 
 namespace bem4i { template<class LO, class SC> struct bem4idata; }
 
@@ -13,18 +14,20 @@ namespace espreso {
 struct Step;
 enum Matrices : int;
 enum class MatrixType;
-template<typename TIndices> class SparseVVPMatrix;
 class DenseMatrix;
 class Mesh;
 class Instance;
 class Constraints;
 class SparseMatrix;
+class Evaluator;
 struct PhysicsConfiguration;
 
 template <typename TType> class edata;
+template <typename TEBoundaries, typename TEData> class serializededata;
 struct NodeData;
 struct ElementData;
 struct BoundaryRegionStore;
+class GeometryCache;
 
 enum class FETI_REGULARIZATION;
 
@@ -49,6 +52,8 @@ struct Physics {
 	virtual void updateMatrix(Matrices matrices, size_t domain);
 
 	virtual MatrixType getMatrixType(size_t domain) const =0;
+	// K and M depend neither on time nor on the solution, hence they can be reused by the next time step
+	virtual bool isMatrixConstant() const { return false; }
 
 	virtual void processBEM(eslocal domain, Matrices matrices) =0;
 	virtual void processElement(eslocal domain, Matrices matrices, eslocal eindex, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe) const =0;
@@ -72,17 +77,69 @@ struct Physics {
 	virtual ~Physics();
 
 protected:
-	virtual void fillDOFsIndices(edata<const eslocal> &nodes, eslocal domain, std::vector<eslocal> &DOFs) const;
+	// Pattern of matrices K and M computed from elements of a domain.
+	// Element matrices are added directly to CSR values according to precomputed positions.
+	struct DomainPattern {
+		bool initialized, symmetric;
+		std::vector<eslocal> rows, columns; // CSR pattern indexed from 1
+		std::vector<eslocal> elementOffset; // offset of an element to 'positions'
+		std::vector<eslocal> positions; // position of Ke(r, c) in CSR values (-1 for not stored lower triangle)
+
+		DomainPattern(): initialized(false), symmetric(false) {}
+	};
+
+	// Settings of elements regions are resolved to a per-element table once per load step.
+	// The first region (in the configuration order) that contains an element is used.
+	virtual void resolveElementSettings() {};
+
+	template <typename TSettings>
+	void resolveElementRegions(const std::map<std::string, TSettings> &settings)
+	{
+		std::vector<std::pair<std::string, const void*> > regions;
+		for (auto it = settings.begin(); it != settings.end(); ++it) {
+			regions.push_back(std::make_pair(it->first, static_cast<const void*>(&it->second)));
+		}
+		resolveElementRegions(&settings, regions);
+	}
+
+	template <typename TSettings>
+	const TSettings* elementSettings(const std::map<std::string, TSettings> &settings, eslocal eindex) const
+	{
+		return static_cast<const TSettings*>(elementSettings(static_cast<const void*>(&settings), eindex));
+	}
+
+	template <typename TSettings>
+	Evaluator* elementEvaluator(const std::map<std::string, TSettings> &settings, eslocal eindex) const
+	{
+		const TSettings *value = elementSettings(settings, eindex);
+		return value != NULL ? value->evaluator : NULL;
+	}
+
+	void resolveElementRegions(const void *settings, const std::vector<std::pair<std::string, const void*> > &regions);
+	const void* elementSettings(const void *settings, eslocal eindex) const;
+
+	virtual void computeLocalNodes();
+	const serializededata<eslocal, eslocal>* boundaryLocalNodes(const BoundaryRegionStore *region) const;
+	virtual void fillDOFsIndices(edata<const eslocal> &localNodes, std::vector<eslocal> &DOFs) const;
+	virtual void buildDomainPattern(size_t domain, bool symmetric);
+	virtual void initMatrixFromPattern(SparseMatrix &A, size_t domain) const;
 	virtual void insertElementToDomain(
-			SparseVVPMatrix<eslocal> &K, SparseVVPMatrix<eslocal> &M,
-			const std::vector<eslocal> &DOFs,
+			SparseMatrix &K, SparseMatrix &M,
+			const std::vector<eslocal> &DOFs, const eslocal *positions,
 			const DenseMatrix &Ke, const DenseMatrix &Me, const DenseMatrix &Re, const DenseMatrix &fe,
 			size_t domain, bool isBoundaryCondition);
 
-	virtual void assembleBoundaryConditions(SparseVVPMatrix<eslocal> &K, SparseVVPMatrix<eslocal> &M, Matrices matrices, size_t domain);
+	// elements of an interval have the same code, hence a particular physics can select a specialized kernel once per interval
+	virtual void processElements(eslocal domain, Matrices matrices, eslocal begin, eslocal end, int code, std::vector<eslocal> &DOFs, DenseMatrix &Ke, DenseMatrix &Me, DenseMatrix &Re, DenseMatrix &fe);
+	void insertElement(eslocal domain, eslocal eindex, std::vector<eslocal> &DOFs, const DenseMatrix &Ke, const DenseMatrix &Me, const DenseMatrix &Re, const DenseMatrix &fe);
+
+	virtual void assembleBoundaryConditions(SparseMatrix &K, SparseMatrix &M, Matrices matrices, size_t domain);
 
 	void printInvalidElement(eslocal eindex) const;
 
+	// detJ and dND at a Gauss point of a cached element, returns false if the element is not cached
+	bool cachedGeometry(eslocal domain, eslocal eindex, size_t gp, double &detJ, DenseMatrix &dND) const;
+
 	static void smoothstep(double &smoothStep, double &derivation, double edge0, double edge1, double value, size_t order);
 
 	std::string _name;
@@ -99,6 +156,21 @@ protected:
 	std::vector<int> _BEMDomain;
 	std::vector<bem4i::bem4idata<eslocal, double>* > _BEMData;
 
+	std::vector<DomainPattern> _patterns;
+
+	struct ElementSettings {
+		size_t step;
+		std::vector<const void*> values;
+		std::vector<eslocal> regions; // index to 'values' for each element (-1 for elements without settings)
+	};
+	std::map<const void*, ElementSettings> _elementSettings;
+
+	// indices of element nodes within the element domain (the same structure as elements->nodes)
+	serializededata<eslocal, eslocal>* _localNodes;
+	std::vector<serializededata<eslocal, eslocal>*> _boundaryLocalNodes;
+
+	GeometryCache *_geometry;
+
 	mutable size_t _invalidElements;
 };
 
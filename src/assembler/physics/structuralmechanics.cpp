@@ -56,6 +56,15 @@ StructuralMechanics::StructuralMechanics(const StructuralMechanicsConfiguration
 	}
 }
 
+void StructuralMechanics::resolveElementSettings()
+{
+	resolveElementRegions(_configuration.load_steps_settings.at(_step->step + 1).acceleration);
+	resolveElementRegions(_configuration.load_steps_settings.at(_step->step + 1).angular_velocity);
+	resolveElementRegions(_configuration.load_steps_settings.at(_step->step + 1).temperature);
+	resolveElementRegions(_configuration.initial_temperature);
+	resolveElementRegions(_configuration.thickness);
+}
+
 void StructuralMechanics::setDirichlet()
 {
 	if (_step->step) {
@@ -22,6 +22,8 @@ struct StructuralMechanics: public virtual Physics
 	virtual void assembleB1(bool withRedundantMultipliers, bool withGluing, bool withScaling);
 
 protected:
+	virtual void resolveElementSettings();
+
 	const StructuralMechanicsConfiguration &_configuration;
 	const ResultsSelectionConfiguration &_propertiesConfiguration;
 
@@ -260,43 +260,13 @@ void StructuralMechanics2D::processElement(eslocal domain, Matrices matrices, es
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
 	const ECFExpressionVector *acceleration = NULL, *angular_velocity = NULL;
 	Evaluator *thick = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).acceleration.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).acceleration.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			acceleration = &it->second;
-			break;
-		}
-	}
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).angular_velocity.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).angular_velocity.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			angular_velocity = &it->second;
-			break;
-		}
-	}
+	acceleration = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).acceleration, eindex);
+	angular_velocity = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).angular_velocity, eindex);
 
 	Evaluator *initial_temperature = NULL, *temperature = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).temperature.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			temperature = it->second.evaluator;
-			break;
-		}
-	}
-	for (auto it = _configuration.initial_temperature.begin(); it != _configuration.initial_temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			initial_temperature = it->second.evaluator;
-			break;
-		}
-	}
-	for (auto it = _configuration.thickness.begin(); it != _configuration.thickness.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			thick = it->second.evaluator;
-			break;
-		}
-	}
+	temperature = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).temperature, eindex);
+	initial_temperature = elementEvaluator(_configuration.initial_temperature, eindex);
+	thick = elementEvaluator(_configuration.thickness, eindex);
 
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
@@ -375,13 +345,15 @@ void StructuralMechanics2D::processElement(eslocal domain, Matrices matrices, es
 	}
 
 	for (size_t gp = 0; gp < N.size(); gp++) {
-		J.multiply(dN[gp], coordinates);
-		detJ = determinant2x2(J.values());
-		inverse2x2(J.values(), invJ.values(), detJ);
+		if (!cachedGeometry(domain, eindex, gp, detJ, dND)) {
+			J.multiply(dN[gp], coordinates);
+			detJ = determinant2x2(J.values());
+			inverse2x2(J.values(), invJ.values(), detJ);
+			dND.multiply(invJ, dN[gp]);
+		}
 
 		gpThickness.multiply(N[gp], thickness);
 		gpK.multiply(N[gp], K);
-		dND.multiply(invJ, dN[gp]);
 		gpDens.multiply(N[gp], dens);
 
 		if (matrices & Matrices::f) {
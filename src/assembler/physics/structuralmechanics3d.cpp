@@ -1,5 +1,6 @@
 
 #include "structuralmechanics3d.h"
+#include "geometrycache.h"
 
 #include "../step.h"
 #include "../instance.h"
@@ -355,29 +356,11 @@ void StructuralMechanics3D::processElement(eslocal domain, Matrices matrices, es
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
 	const ECFExpressionVector *acceleration = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).acceleration.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).acceleration.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			acceleration = &it->second;
-			break;
-		}
-	}
+	acceleration = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).acceleration, eindex);
 
 	Evaluator *initial_temperature = NULL, *temperature = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).temperature.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			temperature = it->second.evaluator;
-			break;
-		}
-	}
-	for (auto it = _configuration.initial_temperature.begin(); it != _configuration.initial_temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			initial_temperature = it->second.evaluator;
-			break;
-		}
-	}
+	temperature = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).temperature, eindex);
+	initial_temperature = elementEvaluator(_configuration.initial_temperature, eindex);
 
 
 	const std::vector<DenseMatrix> &N = *(epointer->N);
@@ -448,16 +431,20 @@ void StructuralMechanics3D::processElement(eslocal domain, Matrices matrices, es
 	}
 
 	for (size_t gp = 0; gp < N.size(); gp++) {
-		J.multiply(dN[gp], coordinates);
-		detJ = determinant3x3(J.values());
-		if (detJ <= 0) {
-			printInvalidElement(eindex);
+		if (!cachedGeometry(domain, eindex, gp, detJ, dND)) {
+			J.multiply(dN[gp], coordinates);
+			detJ = determinant3x3(J.values());
+			if (detJ <= 0) {
+				printInvalidElement(eindex);
+				ESINFO(ERROR) << "Invalid element detected - check input data.";
+			}
+			inverse3x3(J.values(), invJ.values(), detJ);
+			dND.multiply(invJ, dN[gp]);
+		} else if (_geometry->invalid(eindex)) {
 			ESINFO(ERROR) << "Invalid element detected - check input data.";
 		}
-		inverse3x3(J.values(), invJ.values(), detJ);
 
 		gpK.multiply(N[gp], K);
-		dND.multiply(invJ, dN[gp]);
 		gpDens.multiply(N[gp], dens);
 
 		if (matrices & Matrices::f) {
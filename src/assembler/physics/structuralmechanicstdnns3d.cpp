@@ -355,29 +355,11 @@ void StructuralMechanicsTDNNS3D::processElement(eslocal domain, Matrices matrice
 	auto nodes = _mesh->elements->nodes->cbegin() + eindex;
 	auto epointer = _mesh->elements->epointers->datatarray()[eindex];
 	const ECFExpressionVector *acceleration = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).acceleration.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).acceleration.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			acceleration = &it->second;
-			break;
-		}
-	}
+	acceleration = elementSettings(_configuration.load_steps_settings.at(_step->step + 1).acceleration, eindex);
 
 	Evaluator *initial_temperature = NULL, *temperature = NULL;
-	for (auto it = _configuration.load_steps_settings.at(_step->step + 1).temperature.begin(); it != _configuration.load_steps_settings.at(_step->step + 1).temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			temperature = it->second.evaluator;
-			break;
-		}
-	}
-	for (auto it = _configuration.initial_temperature.begin(); it != _configuration.initial_temperature.end(); ++it) {
-		ElementsRegionStore *region = _mesh->eregion(it->first);
-		if (std::binary_search(region->elements->datatarray().cbegin(), region->elements->datatarray().cend(), eindex)) {
-			initial_temperature = it->second.evaluator;
-			break;
-		}
-	}
+	temperature = elementEvaluator(_configuration.load_steps_settings.at(_step->step + 1).temperature, eindex);
+	initial_temperature = elementEvaluator(_configuration.initial_temperature, eindex);
 
 
 	// BASE functions
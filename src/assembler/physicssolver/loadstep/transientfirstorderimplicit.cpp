@@ -7,6 +7,7 @@
 #include "../../instance.h"
 #include "../../physics/physics.h"
 
+#include "../../../linearsolver/linearsolver.h"
 #include "../../../mesh/mesh.h"
 #include "../../../mesh/store/nodestore.h"
 
@@ -22,7 +23,8 @@ using namespace espreso;
 size_t TransientFirstOrderImplicit::loadStep = 0;
 
 TransientFirstOrderImplicit::TransientFirstOrderImplicit(TimeStepSolver &timeStepSolver, const TransientSolverConfiguration &configuration, double duration)
-: LoadStepSolver("TRANSIENT", timeStepSolver, duration), _configuration(configuration), _alpha(0), _nTimeStep(_configuration.time_step)
+: LoadStepSolver("TRANSIENT", timeStepSolver, duration), _configuration(configuration), _alpha(0), _nTimeStep(_configuration.time_step),
+  _constantOperator(false), _storeOperator(false), _operatorTimeStep(0)
 {
 	if (configuration.time_step < 1e-7) {
 		ESINFO(GLOBAL_ERROR) << "Set time step for TRANSIENT solver greater than 1e-7.";
@@ -44,6 +46,28 @@ Matrices TransientFirstOrderImplicit::updateStructuralMatrices(Matrices matrices
 //		updatedMatrices &= (Matrices::f | Matrices::B1c);
 //	}
 
+	if (_constantOperator && _operatorTimeStep != 0) {
+		// Dirichlet conditions are set on the same regions within a load step, only their values can be changed
+		if (updatedMatrices & Matrices::B1) {
+			updatedMatrices = (updatedMatrices & ~Matrices::B1) | Matrices::B1c;
+		}
+
+		double timeStep = _assembler.step.timeStep;
+		if (std::fabs(timeStep - _operatorTimeStep) / timeStep < _precision) {
+			updatedMatrices &= ~(Matrices::K | Matrices::M);
+		} else if (_assembler.linearSolver.restoreOperator(timeStep)) {
+			ESINFO(CONVERGENCE) << "REUSE OPERATOR OF TIME STEP (" << timeStep << ")";
+			updatedMatrices &= ~(Matrices::K | Matrices::M);
+			_operatorTimeStep = timeStep;
+		}
+	}
+
+	if (_constantOperator && (updatedMatrices & (Matrices::K | Matrices::M))) {
+		ESINFO(CONVERGENCE) << "ASSEMBLE OPERATOR OF TIME STEP (" << _assembler.step.timeStep << ")";
+		_operatorTimeStep = _assembler.step.timeStep;
+		_storeOperator = true;
+	}
+
 	return reassembleStructuralMatrices(updatedMatrices);
 }
 
@@ -116,6 +140,9 @@ void TransientFirstOrderImplicit::initLoadStep()
 	}
 	loadStep = _assembler.step.step;
 	(*U->decomposedData) = _assembler.instance.primalSolution;
+
+	_constantOperator = _assembler.physics.isMatrixConstant();
+	_operatorTimeStep = 0;
 }
 
 void TransientFirstOrderImplicit::runNextTimeStep()
@@ -137,6 +164,11 @@ void TransientFirstOrderImplicit::processTimeStep()
 
 	_timeStepSolver.solve(*this);
 
+	if (_storeOperator) {
+		_assembler.linearSolver.storeOperator(_assembler.step.timeStep);
+		_storeOperator = false;
+	}
+
 	_assembler.sum(
 			*dU->decomposedData,
 			1, _assembler.instance.primalSolution,
@@ -26,6 +26,10 @@ protected:
 	double _alpha;
 	double _nTimeStep;
 
+	// K + 1 / (alpha * delta T) * M is kept if the material is linear and the time step is unchanged
+	bool _constantOperator, _storeOperator;
+	double _operatorTimeStep;
+
 	static size_t loadStep;
 
 	NodeData *U, *dU, *V, *X, *Y, *dTK;
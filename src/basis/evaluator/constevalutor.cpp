@@ -1,10 +1,16 @@
 
 #include "constevaluator.h"
 
+#include <algorithm>
+
 using namespace espreso;
 
 void ConstEvaluator::evaluate(eslocal size, eslocal increment, const Point* cbegin, const double* tbegin, double time, double *results) const
 {
+	if (increment == 1) {
+		std::fill(results, results + size, _value);
+		return;
+	}
 	for (eslocal i = 0; i < size; ++i) {
 		results[i * increment] = _value;
 	}
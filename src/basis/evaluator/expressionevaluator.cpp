@@ -1,9 +1,13 @@
 
 #include "expressionevaluator.h"
 #include "../expression/expression.h"
+#include "../expression/compiledexpression.h"
 
 #include "omp.h"
 
+#include <cmath>
+#include <algorithm>
+
 #include "../../basis/containers/point.h"
 #include "../../basis/utilities/parser.h"
 #include "../../config/ecf/environment.h"
@@ -24,6 +28,8 @@ ExpressionEvaluator::ExpressionEvaluator(const std::string &expression)
 	_coordinateDependency = StringCompare::contains(expression, { "X", "Y", "Z" });
 	_timeDependency = StringCompare::contains(expression, { "TIME" });
 	_temperatureDependency = StringCompare::contains(expression, { "TEMPERATURE" });
+
+	compile();
 }
 
 ExpressionEvaluator::ExpressionEvaluator(const ExpressionEvaluator &other)
@@ -40,11 +46,74 @@ ExpressionEvaluator::ExpressionEvaluator(const ExpressionEvaluator &other)
 	_coordinateDependency = other._coordinateDependency;
 	_timeDependency = other._timeDependency;
 	_temperatureDependency = other._temperatureDependency;
+
+	compile();
+}
+
+ExpressionEvaluator::~ExpressionEvaluator()
+{
+	for (size_t t = 0; t < _expressions.size(); t++) {
+		delete _expressions[t];
+	}
+	if (_compiled != NULL) {
+		delete _compiled;
+	}
+}
+
+void ExpressionEvaluator::compile()
+{
+	_compiled = new CompiledExpression(_expressions.front()->expression(), ExpressionEvaluator::variables());
+	if (_compiled->compiled()) {
+		// check the bytecode against exprtk for safety
+		std::vector<double> values(ExpressionEvaluator::variables().size());
+		for (int sample = 0; sample < 5 && _compiled != NULL; sample++) {
+			for (size_t v = 0; v < values.size(); v++) {
+				values[v] = 0.5 + sample * (v + 1) * 0.37;
+			}
+			double expected = _expressions.front()->evaluate(values);
+			double value = _compiled->evaluate(values);
+			if (expected != value && std::fabs(expected - value) > 1e-12 * std::max(1.0, std::fabs(expected))) {
+				delete _compiled;
+				_compiled = NULL;
+			}
+		}
+	} else {
+		delete _compiled;
+		_compiled = NULL;
+	}
 }
 
 void ExpressionEvaluator::evaluate(eslocal size, eslocal increment, const Point* cbegin, const double* tbegin, double time, double *results) const
 {
 	int thread = omp_get_thread_num();
+	if (!_coordinateDependency && !_temperatureDependency) {
+		// the expression is the same for all points
+		_expressions[thread]->values[4] = time;
+		double value = _expressions[thread]->evaluate();
+		for (eslocal i = 0; i < size; ++i) {
+			results[i * increment] = value;
+		}
+		return;
+	}
+	if (_compiled != NULL) {
+		double zero = 0;
+		const double *values[6] = {
+				cbegin != NULL ? &cbegin->x : &zero,
+				cbegin != NULL ? &cbegin->y : &zero,
+				cbegin != NULL ? &cbegin->z : &zero,
+				tbegin != NULL ? tbegin : &zero,
+				&time,
+				&zero };
+		eslocal increments[6] = {
+				cbegin != NULL ? 3 : 0,
+				cbegin != NULL ? 3 : 0,
+				cbegin != NULL ? 3 : 0,
+				tbegin != NULL ? 1 : 0,
+				0,
+				0 };
+		_compiled->evaluate(size, values, increments, results, increment);
+		return;
+	}
 	for (eslocal i = 0; i < size; ++i) {
 		if (cbegin != NULL) {
 			_expressions[thread]->values[0] = cbegin[i].x;
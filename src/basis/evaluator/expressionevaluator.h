@@ -10,6 +10,7 @@
 namespace espreso {
 
 class Expression;
+class CompiledExpression;
 
 /**
  * Evaluator can be called from various threads.
@@ -22,6 +23,7 @@ public:
 
 	ExpressionEvaluator(const std::string &expression);
 	ExpressionEvaluator(const ExpressionEvaluator &other);
+	~ExpressionEvaluator();
 
 	Type type() { return Type::EXPRESSION; }
 	virtual Evaluator* copy() const { return new ExpressionEvaluator(*this); }
@@ -36,7 +38,10 @@ public:
 	std::string getEXPRTKForm() const;
 
 protected:
+	void compile();
+
 	std::vector<Expression*> _expressions;
+	CompiledExpression *_compiled; // NULL if the expression is not supported by the bytecode
 	bool _coordinateDependency, _temperatureDependency, _timeDependency;
 };
 
@@ -3,6 +3,8 @@
 
 #include "../logging/logging.h"
 
+#include <algorithm>
+
 using namespace espreso;
 
 TableInterpolationEvaluator::TableInterpolationEvaluator(const std::vector<std::pair<double, double> > &table)
@@ -11,24 +13,23 @@ TableInterpolationEvaluator::TableInterpolationEvaluator(const std::vector<std::
 	if (!table.size()) {
 		ESINFO(GLOBAL_ERROR) << "Interpolation table with zero size.";
 	}
+	for (size_t i = 0; i + 1 < _table.size(); i++) {
+		_slope.push_back((_table[i + 1].second - _table[i].second) / (_table[i + 1].first - _table[i].first));
+	}
 }
 
 void TableInterpolationEvaluator::evaluate(eslocal size, eslocal increment, const Point* cbegin, const double* tbegin, double time, double *results) const
 {
+	double first = _table.front().first, last = _table.back().first;
 	for (eslocal i = 0; i < size; ++i) {
-		if (tbegin[i] < _table[0].first) {
-			results[i * increment] = _table[0].second;
-			break;
-		}
-		for (size_t j = 0; j < _table.size() - 1; j++) {
-			if (_table[j].first < tbegin[i] && tbegin[i] < _table[j + 1].first) {
-				double a = _table[j].first, b = _table[j + 1].first;
-				double va = _table[j].second, vb = _table[j + 1].second;
-				results[i * increment] = va + (vb - va) * (tbegin[i] - a) / (b - a);
-				break;
-			}
+		if (tbegin[i] <= first) {
+			results[i * increment] = _table.front().second;
+		} else if (last <= tbegin[i]) {
+			results[i * increment] = _table.back().second;
+		} else {
+			size_t j = std::upper_bound(_table.begin(), _table.end(), tbegin[i], [] (double t, const std::pair<double, double> &v) { return t < v.first; }) - _table.begin() - 1;
+			results[i * increment] = _table[j].second + _slope[j] * (tbegin[i] - _table[j].first);
 		}
-		results[i * increment] = _table.back().second;
 	}
 }
 
@@ -27,6 +27,7 @@ public:
 
 protected:
 	std::vector<std::pair<double, double> > _table;
+	std::vector<double> _slope;
 };
 
 }
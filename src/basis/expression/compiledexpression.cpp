@@ -0,0 +1,522 @@
+
+#include "compiledexpression.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace espreso;
+
+// number of points evaluated by a single pass through the bytecode
+#define BLOCK_SIZE 64
+// registers are allocated on the stack if their total size is below this size
+#define STACK_REGISTERS 4096
+
+static double equal(double a, double b)
+{
+	// the same as exprtk
+	return std::fabs(a - b) <= std::max(1.0, std::max(std::fabs(a), std::fabs(b))) * 0.0000000001 ? 1 : 0;
+}
+
+class CompiledExpression::Parser {
+
+	struct Unsupported {};
+
+public:
+	Parser(const std::string &str, const std::vector<std::string> &variables, std::vector<Instruction> &instructions)
+	: _str(str), _position(0), _variables(variables), _instructions(instructions) {}
+
+	bool parse()
+	{
+		try {
+			expression();
+			skip();
+			if (_position != _str.size()) {
+				throw Unsupported();
+			}
+		} catch (Unsupported&) {
+			_instructions.clear();
+			return false;
+		}
+		return true;
+	}
+
+protected:
+	void skip()
+	{
+		while (_position < _str.size() && std::isspace(_str[_position])) {
+			++_position;
+		}
+	}
+
+	bool accept(const std::string &token)
+	{
+		skip();
+		if (_str.compare(_position, token.size(), token) == 0) {
+			_position += token.size();
+			return true;
+		}
+		return false;
+	}
+
+	bool acceptKeyword(const std::string &keyword)
+	{
+		skip();
+		size_t end = _position;
+		while (end < _str.size() && (std::isalnum(_str[end]) || _str[end] == '_')) {
+			++end;
+		}
+		if (end - _position != keyword.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < keyword.size(); i++) {
+			if (std::tolower(_str[_position + i]) != keyword[i]) {
+				return false;
+			}
+		}
+		_position = end;
+		return true;
+	}
+
+	void expect(const std::string &token)
+	{
+		if (!accept(token)) {
+			throw Unsupported();
+		}
+	}
+
+	int emit(OP op, int a = 0, int b = 0, int c = 0, double value = 0)
+	{
+		if (op != OP::CONST && op != OP::VARIABLE) {
+			int count = operands(op);
+			bool folding = _instructions[a].op == OP::CONST;
+			folding = folding && (count < 2 || _instructions[b].op == OP::CONST);
+			folding = folding && (count < 3 || _instructions[c].op == OP::CONST);
+			if (folding) {
+				value = apply(op, _instructions[a].value, _instructions[b].value, _instructions[c].value);
+				op = OP::CONST;
+				a = b = c = 0;
+			}
+		}
+		_instructions.push_back(Instruction(op, a, b, c, value));
+		return _instructions.size() - 1;
+	}
+
+	// or < and < comparison < additive < multiplicative < unary < power (exprtk precedence)
+	int expression()
+	{
+		int left = conjunction();
+		while (acceptKeyword("or")) {
+			left = emit(OP::OR, left, conjunction());
+		}
+		return left;
+	}
+
+	int conjunction()
+	{
+		int left = comparison();
+		while (acceptKeyword("and")) {
+			left = emit(OP::AND, left, comparison());
+		}
+		return left;
+	}
+
+	int comparison()
+	{
+		int left = additive();
+		OP op;
+		if (accept("<=")) {
+			op = OP::LE;
+		} else if (accept(">=")) {
+			op = OP::GE;
+		} else if (accept("==") || accept("=")) {
+			op = OP::EQ;
+		} else if (accept("!=") || accept("<>")) {
+			op = OP::NE;
+		} else if (accept("<")) {
+			op = OP::LT;
+		} else if (accept(">")) {
+			op = OP::GT;
+		} else {
+			return left;
+		}
+		left = emit(op, left, additive());
+		skip();
+		if (_position < _str.size() && std::string("<>=!").find(_str[_position]) != std::string::npos) {
+			throw Unsupported(); // chained comparisons
+		}
+		return left;
+	}
+
+	int additive()
+	{
+		int left = multiplicative();
+		while (true) {
+			if (accept("+")) {
+				left = emit(OP::ADD, left, multiplicative());
+			} else if (accept("-")) {
+				left = emit(OP::SUB, left, multiplicative());
+			} else {
+				return left;
+			}
+		}
+	}
+
+	int multiplicative()
+	{
+		int left = unary();
+		while (true) {
+			if (accept("*")) {
+				left = emit(OP::MUL, left, unary());
+			} else if (accept("/")) {
+				left = emit(OP::DIV, left, unary());
+			} else if (accept("%")) {
+				left = emit(OP::MOD, left, unary());
+			} else {
+				return left;
+			}
+		}
+	}
+
+	int unary()
+	{
+		if (accept("-")) {
+			return emit(OP::NEG, unary());
+		}
+		if (accept("+")) {
+			return unary();
+		}
+		return power();
+	}
+
+	int power()
+	{
+		int base = primary();
+		if (accept("^")) {
+			base = pow(base, unary()); // right associative as in exprtk
+		}
+		return base;
+	}
+
+	int pow(int base, int exponent)
+	{
+		// small integer powers are evaluated by multiplications
+		const Instruction &e = _instructions[exponent];
+		if (e.op == OP::CONST && e.value == std::floor(e.value) && 1 <= e.value && e.value <= 16) {
+			int n = e.value, result = -1;
+			while (n) {
+				if (n & 1) {
+					result = result == -1 ? base : emit(OP::MUL, result, base);
+				}
+				n >>= 1;
+				if (n) {
+					base = emit(OP::MUL, base, base);
+				}
+			}
+			return result;
+		}
+		return emit(OP::POW, base, exponent);
+	}
+
+	std::vector<int> arguments()
+	{
+		std::vector<int> args;
+		expect("(");
+		args.push_back(expression());
+		while (accept(",")) {
+			args.push_back(expression());
+		}
+		expect(")");
+		return args;
+	}
+
+	int primary()
+	{
+		skip();
+		if (_position == _str.size()) {
+			throw Unsupported();
+		}
+
+		if (accept("(")) {
+			int value = expression();
+			expect(")");
+			return value;
+		}
+
+		if (std::isdigit(_str[_position]) || _str[_position] == '.') {
+			const char *begin = _str.c_str() + _position;
+			char *end;
+			double value = std::strtod(begin, &end);
+			if (end == begin) {
+				throw Unsupported();
+			}
+			_position += end - begin;
+			if (_position < _str.size() && (std::isalpha(_str[_position]) || _str[_position] == '_')) {
+				throw Unsupported(); // implicit multiplication
+			}
+			return emit(OP::CONST, 0, 0, 0, value);
+		}
+
+		if (!std::isalpha(_str[_position]) && _str[_position] != '_') {
+			throw Unsupported();
+		}
+
+		size_t begin = _position;
+		while (_position < _str.size() && (std::isalnum(_str[_position]) || _str[_position] == '_')) {
+			++_position;
+		}
+		std::string name = _str.substr(begin, _position - begin);
+		std::string lower = name, upper = name;
+		std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+		std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+		for (size_t v = 0; v < _variables.size(); v++) {
+			if (_variables[v] == upper) {
+				return emit(OP::VARIABLE, v);
+			}
+		}
+		if (lower == "pi") {
+			return emit(OP::CONST, 0, 0, 0, M_PI);
+		}
+
+		struct Function { const char *name; OP op; size_t args; };
+		static const Function functions[] = {
+			{ "sin", OP::SIN, 1 }, { "cos", OP::COS, 1 }, { "tan", OP::TAN, 1 },
+			{ "asin", OP::ASIN, 1 }, { "acos", OP::ACOS, 1 }, { "atan", OP::ATAN, 1 },
+			{ "sinh", OP::SINH, 1 }, { "cosh", OP::COSH, 1 }, { "tanh", OP::TANH, 1 },
+			{ "exp", OP::EXP, 1 }, { "log", OP::LOG, 1 }, { "log10", OP::LOG10, 1 },
+			{ "sqrt", OP::SQRT, 1 }, { "abs", OP::ABS, 1 }, { "floor", OP::FLOOR, 1 }, { "ceil", OP::CEIL, 1 },
+			{ "not", OP::NOT, 1 },
+			{ "pow", OP::POW, 2 }, { "atan2", OP::ATAN2, 2 }, { "if", OP::IF, 3 },
+			{ "min", OP::MIN, 0 }, { "max", OP::MAX, 0 } // variadic
+		};
+
+		for (size_t f = 0; f < sizeof(functions) / sizeof(Function); f++) {
+			if (lower == functions[f].name) {
+				std::vector<int> args = arguments();
+				if (functions[f].args == 0) {
+					int value = args.front();
+					for (size_t i = 1; i < args.size(); i++) {
+						value = emit(functions[f].op, value, args[i]);
+					}
+					return value;
+				}
+				if (args.size() != functions[f].args) {
+					throw Unsupported();
+				}
+				if (functions[f].op == OP::POW) {
+					return pow(args[0], args[1]);
+				}
+				args.resize(3, 0);
+				return emit(functions[f].op, args[0], args[1], args[2]);
+			}
+		}
+
+		throw Unsupported();
+	}
+
+	const std::string &_str;
+	size_t _position;
+	const std::vector<std::string> &_variables;
+	std::vector<Instruction> &_instructions;
+};
+
+int CompiledExpression::operands(OP op)
+{
+	switch (op) {
+	case OP::CONST:
+	case OP::VARIABLE:
+		return 0;
+	case OP::NEG: case OP::NOT:
+	case OP::SIN: case OP::COS: case OP::TAN: case OP::ASIN: case OP::ACOS: case OP::ATAN:
+	case OP::SINH: case OP::COSH: case OP::TANH:
+	case OP::EXP: case OP::LOG: case OP::LOG10: case OP::SQRT: case OP::ABS: case OP::FLOOR: case OP::CEIL:
+		return 1;
+	case OP::IF:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+double CompiledExpression::apply(OP op, double a, double b, double c)
+{
+	switch (op) {
+	case OP::NEG: return -a;
+	case OP::NOT: return a == 0 ? 1 : 0;
+	case OP::ADD: return a + b;
+	case OP::SUB: return a - b;
+	case OP::MUL: return a * b;
+	case OP::DIV: return a / b;
+	case OP::MOD: return std::fmod(a, b);
+	case OP::POW: return std::pow(a, b);
+	case OP::LT: return a < b ? 1 : 0;
+	case OP::LE: return a <= b ? 1 : 0;
+	case OP::GT: return a > b ? 1 : 0;
+	case OP::GE: return a >= b ? 1 : 0;
+	case OP::EQ: return equal(a, b);
+	case OP::NE: return 1 - equal(a, b);
+	case OP::AND: return a != 0 && b != 0 ? 1 : 0;
+	case OP::OR: return a != 0 || b != 0 ? 1 : 0;
+	case OP::IF: return a != 0 ? b : c;
+	case OP::SIN: return std::sin(a);
+	case OP::COS: return std::cos(a);
+	case OP::TAN: return std::tan(a);
+	case OP::ASIN: return std::asin(a);
+	case OP::ACOS: return std::acos(a);
+	case OP::ATAN: return std::atan(a);
+	case OP::SINH: return std::sinh(a);
+	case OP::COSH: return std::cosh(a);
+	case OP::TANH: return std::tanh(a);
+	case OP::EXP: return std::exp(a);
+	case OP::LOG: return std::log(a);
+	case OP::LOG10: return std::log10(a);
+	case OP::SQRT: return std::sqrt(a);
+	case OP::ABS: return std::fabs(a);
+	case OP::FLOOR: return std::floor(a);
+	case OP::CEIL: return std::ceil(a);
+	case OP::ATAN2: return std::atan2(a, b);
+	case OP::MIN: return std::min(a, b);
+	case OP::MAX: return std::max(a, b);
+	default: return 0;
+	}
+}
+
+CompiledExpression::CompiledExpression(const std::string &str, const std::vector<std::string> &variables)
+: _variables(variables), _compiled(false)
+{
+	for (size_t v = 0; v < _variables.size(); v++) {
+		std::transform(_variables[v].begin(), _variables[v].end(), _variables[v].begin(), ::toupper);
+	}
+	Parser parser(str, _variables, _instructions);
+	_compiled = parser.parse();
+	if (_compiled) {
+		removeUnused();
+	}
+}
+
+void CompiledExpression::removeUnused()
+{
+	// operands of folded constants are not referenced anymore
+	std::vector<int> used(_instructions.size(), 0), map(_instructions.size(), -1);
+	used.back() = 1;
+	for (size_t i = _instructions.size(); i > 0; i--) {
+		const Instruction &ins = _instructions[i - 1];
+		if (used[i - 1]) {
+			int count = operands(ins.op);
+			if (count > 0) { used[ins.a] = 1; }
+			if (count > 1) { used[ins.b] = 1; }
+			if (count > 2) { used[ins.c] = 1; }
+		}
+	}
+
+	std::vector<Instruction> instructions;
+	for (size_t i = 0; i < _instructions.size(); i++) {
+		if (used[i]) {
+			Instruction ins = _instructions[i];
+			int count = operands(ins.op);
+			if (count > 0) { ins.a = map[ins.a]; }
+			if (count > 1) { ins.b = map[ins.b]; }
+			if (count > 2) { ins.c = map[ins.c]; }
+			map[i] = instructions.size();
+			instructions.push_back(ins);
+		}
+	}
+	_instructions.swap(instructions);
+}
+
+void CompiledExpression::evaluate(eslocal size, const double * const *values, const eslocal *increments, double *results, eslocal increment) const
+{
+	double stack[STACK_REGISTERS];
+	std::vector<double> heap;
+
+	eslocal block = std::min((eslocal)BLOCK_SIZE, size);
+	double *registers = stack;
+	if (_instructions.size() * block > STACK_REGISTERS) {
+		heap.resize(_instructions.size() * block);
+		registers = heap.data();
+	}
+
+	// constants are the same for all blocks
+	for (size_t i = 0; i < _instructions.size(); i++) {
+		if (_instructions[i].op == OP::CONST) {
+			std::fill(registers + i * block, registers + (i + 1) * block, _instructions[i].value);
+		}
+	}
+
+	for (eslocal begin = 0; begin < size; begin += block) {
+		eslocal n = std::min(block, size - begin);
+
+		for (size_t i = 0; i < _instructions.size(); i++) {
+			const Instruction &ins = _instructions[i];
+			double *r = registers + i * block;
+			const double *a = registers + ins.a * block;
+			const double *b = registers + ins.b * block;
+
+			switch (ins.op) {
+			case OP::CONST:
+				break;
+			case OP::VARIABLE: {
+				const double *v = values[ins.a];
+				eslocal inc = increments[ins.a];
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = v[(begin + k) * inc];
+				}
+			} break;
+			case OP::NEG:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = -a[k];
+				}
+				break;
+			case OP::ADD:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = a[k] + b[k];
+				}
+				break;
+			case OP::SUB:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = a[k] - b[k];
+				}
+				break;
+			case OP::MUL:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = a[k] * b[k];
+				}
+				break;
+			case OP::DIV:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = a[k] / b[k];
+				}
+				break;
+			case OP::IF: {
+				const double *c = registers + ins.c * block;
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = a[k] != 0 ? b[k] : c[k];
+				}
+			} break;
+			default:
+				for (eslocal k = 0; k < n; k++) {
+					r[k] = apply(ins.op, a[k], b[k], 0);
+				}
+			}
+		}
+
+		const double *result = registers + (_instructions.size() - 1) * block;
+		for (eslocal k = 0; k < n; k++) {
+			results[(begin + k) * increment] = result[k];
+		}
+	}
+}
+
+double CompiledExpression::evaluate(const std::vector<double> &values) const
+{
+	std::vector<const double*> pointers(values.size());
+	std::vector<eslocal> increments(values.size(), 0);
+	for (size_t v = 0; v < values.size(); v++) {
+		pointers[v] = values.data() + v;
+	}
+	double result;
+	evaluate(1, pointers.data(), increments.data(), &result);
+	return result;
+}
@@ -0,0 +1,65 @@
+
+#ifndef SRC_BASIS_EXPRESSION_COMPILEDEXPRESSION_H_
+#define SRC_BASIS_EXPRESSION_COMPILEDEXPRESSION_H_
+
+#include <string>
+#include <vector>
+
+namespace espreso {
+
+/**
+ * Expression translated to a flat register-based bytecode.
+ *
+ * Only a subset of exprtk syntax is supported: numbers, variables, PI,
+ * arithmetic, comparison and logical operators, 'if(c, a, b)' and common functions.
+ * Expressions with other constructs are not compiled (see 'compiled()')
+ * and have to be evaluated by exprtk (class Expression).
+ *
+ * Evaluation is thread-safe - registers are allocated by the caller.
+ */
+class CompiledExpression {
+
+public:
+	CompiledExpression(const std::string &str, const std::vector<std::string> &variables);
+
+	bool compiled() const { return _compiled; }
+
+	// variable 'v' of point 'i' is values[v][i * increments[v]] (use increment 0 for variables constant for all points)
+	void evaluate(eslocal size, const double * const *values, const eslocal *increments, double *results, eslocal increment = 1) const;
+	double evaluate(const std::vector<double> &values) const;
+
+protected:
+	enum class OP: int {
+		CONST, VARIABLE,
+		NEG, NOT,
+		ADD, SUB, MUL, DIV, MOD, POW,
+		LT, LE, GT, GE, EQ, NE, AND, OR,
+		IF,
+		SIN, COS, TAN, ASIN, ACOS, ATAN, SINH, COSH, TANH,
+		EXP, LOG, LOG10, SQRT, ABS, FLOOR, CEIL,
+		ATAN2, MIN, MAX
+	};
+
+	struct Instruction {
+		OP op;
+		int a, b, c; // registers of operands (variable index for OP::VARIABLE)
+		double value; // OP::CONST only
+
+		Instruction(OP op, int a = 0, int b = 0, int c = 0, double value = 0): op(op), a(a), b(b), c(c), value(value) {}
+	};
+
+	class Parser;
+
+	static int operands(OP op);
+	static double apply(OP op, double a, double b, double c);
+	void removeUnused();
+
+	// the result of i-th instruction is stored to i-th register
+	std::vector<Instruction> _instructions;
+	std::vector<std::string> _variables;
+	bool _compiled;
+};
+
+}
+
+#endif /* SRC_BASIS_EXPRESSION_COMPILEDEXPRESSION_H_ */
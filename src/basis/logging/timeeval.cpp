@@ -3,12 +3,14 @@
 
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 #include "mpi.h"
 #include "omp.h"
 
 #include "../../config/ecf/environment.h"
 #include "logging.h"
+#include "timetrace.h"
 
 using namespace espreso;
 
@@ -59,8 +61,10 @@ TimeEval::TimeEval(std::string name):
 }
 
 void TimeEval::addEvent(TimeEvent &timeEvent){};
+void TimeEval::addThreadsIdleTime(const std::vector<double> &busyTime, double totalTime){};
 void TimeEval::printStats(){};
 void TimeEval::printStatsMPI(){};
+void TimeEval::printThreadsIdleTime(bool MPI){};
 
 #else
 
@@ -145,8 +149,7 @@ void TimeEvent::endWithBarrier() {
 }
 
 void TimeEvent::endWithoutBarrier() {
-	eventTime.back() = time() - eventTime.back();
-	eventCount++;
+	endWithoutBarrier(time());
 }
 
 void TimeEvent::end(double time) {
@@ -163,6 +166,9 @@ void TimeEvent::endWithBarrier(double time) {
 }
 
 void TimeEvent::endWithoutBarrier(double time) {
+	if (TimeTrace::enabled()) {
+		TimeTrace::record(eventName, eventTime.back(), time);
+	}
 	eventTime.back() = time - eventTime.back();
 	eventCount++;
 }
@@ -337,6 +343,48 @@ void TimeEval::addPointerToEvent(TimeEvent *timeEvent)
 	ptimeEvents.push_back(timeEvent);
 }
 
+void TimeEval::addThreadsIdleTime(const std::vector<double> &busyTime, double totalTime)
+{
+	if (threadsIdleTime.size() < busyTime.size()) {
+		threadsIdleTime.resize(busyTime.size(), 0);
+	}
+	for (size_t t = 0; t < busyTime.size(); t++) {
+		threadsIdleTime[t] += totalTime - busyTime[t];
+	}
+}
+
+void TimeEval::printThreadsIdleTime(bool MPI)
+{
+	double avg = 0, min = threadsIdleTime.size() ? threadsIdleTime.front() : 0, max = 0;
+	for (size_t t = 0; t < threadsIdleTime.size(); t++) {
+		avg += threadsIdleTime[t] / threadsIdleTime.size();
+		min = std::min(min, threadsIdleTime[t]);
+		max = std::max(max, threadsIdleTime[t]);
+	}
+
+	int threads = threadsIdleTime.size();
+	if (MPI) {
+		double g_avg, g_min, g_max;
+		int g_threads;
+		MPI_Reduce(&avg, &g_avg, 1, MPI_DOUBLE, MPI_SUM, 0, environment->MPICommunicator);
+		MPI_Reduce(&min, &g_min, 1, MPI_DOUBLE, MPI_MIN, 0, environment->MPICommunicator);
+		MPI_Reduce(&max, &g_max, 1, MPI_DOUBLE, MPI_MAX, 0, environment->MPICommunicator);
+		MPI_Reduce(&threads, &g_threads, 1, MPI_INT, MPI_MAX, 0, environment->MPICommunicator);
+		avg = g_avg / environment->MPIsize;
+		min = g_min;
+		max = g_max;
+		threads = g_threads;
+	}
+
+	if (threads) {
+		ESLOG(SUMMARY)
+			<< std::setw(totalTime.name_length) << std::left << evalName + "- Threads idle "
+			<< " avg.: " << std::setw(totalTime.val_length) << std::fixed << avg
+			<< " min.: " << std::setw(totalTime.val_length) << min
+			<< " max.: " << std::setw(totalTime.val_length) << max;
+	}
+}
+
 void TimeEval::printStats() {
 	totalTime.evaluate();
 
@@ -345,6 +393,7 @@ void TimeEval::printStats() {
 	}
 
 	totalTime.printStat(totalTime.avgTime);
+	printThreadsIdleTime(false);
 }
 
 void TimeEval::printStatsMPI() {
@@ -378,6 +427,7 @@ void TimeEval::printStatsMPI() {
 	ESLOG(SUMMARY) << separator(separator_size, '-');
 
 	totalTime.printStatMPI(totalTime.g_avgTime);
+	printThreadsIdleTime(true);
 
 	ESLOG(SUMMARY) << separator(separator_size, '*');
 }
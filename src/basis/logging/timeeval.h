@@ -72,6 +72,7 @@ struct TimeEval
 
 	void addEvent(TimeEvent &timeEvent);
 	void addPointerToEvent(TimeEvent *timeEvent);
+	void addThreadsIdleTime(const std::vector<double> &busyTime, double totalTime);
 	void printStats();
 	void printStatsMPI();
 
@@ -84,6 +85,11 @@ struct TimeEval
 	std::vector<TimeEvent> timeEvents;
 	std::vector<TimeEvent*> ptimeEvents;
 
+	// accumulated idle time of each OpenMP thread within parallel regions
+	std::vector<double> threadsIdleTime;
+
+private:
+	void printThreadsIdleTime(bool MPI);
 };
 
 }
@@ -0,0 +1,155 @@
+
+#include "timetrace.h"
+#include "timeeval.h"
+#include "logging.h"
+
+#include "../../config/ecf/environment.h"
+
+#include "mpi.h"
+
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+
+using namespace espreso;
+
+size_t TimeTrace::_records = 0;
+double TimeTrace::_origin = 0;
+
+namespace {
+
+struct TraceRecord {
+	double start, end;
+	int thread;
+	char name[52];
+};
+
+struct TraceBuffer {
+	int thread;
+	size_t size; // the number of records written so far (including overwritten)
+	std::vector<TraceRecord> records;
+
+	TraceBuffer(int thread, size_t records): thread(thread), size(0), records(records) {}
+};
+
+std::mutex mutex;
+std::vector<TraceBuffer*> buffers;
+thread_local TraceBuffer *buffer = NULL;
+
+void escape(std::ostream &os, const char *name)
+{
+	for (const char *c = name; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			os << '\\';
+		}
+		if (*c >= ' ') {
+			os << *c;
+		}
+	}
+}
+
+}
+
+void TimeTrace::init(size_t records)
+{
+	_records = records;
+	if (_records) {
+		// processes share the origin of the timeline
+		MPI_Barrier(environment->MPICommunicator);
+		_origin = TimeEvent::time();
+	}
+}
+
+void TimeTrace::record(const std::string &name, double start, double end)
+{
+	if (buffer == NULL) {
+		std::lock_guard<std::mutex> lock(mutex);
+		buffer = new TraceBuffer(buffers.size(), _records);
+		buffers.push_back(buffer);
+	}
+
+	TraceRecord &record = buffer->records[buffer->size++ % buffer->records.size()];
+	record.start = start - _origin;
+	record.end = end - _origin;
+	record.thread = buffer->thread;
+	strncpy(record.name, name.c_str(), sizeof(record.name) - 1);
+	record.name[sizeof(record.name) - 1] = '\0';
+}
+
+void TimeTrace::finish(const std::string &directory)
+{
+	if (!_records) {
+		return;
+	}
+
+	int rank = environment->MPIrank, size = environment->MPIsize;
+
+	std::vector<TraceRecord> records;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t b = 0; b < buffers.size(); b++) {
+			size_t capacity = buffers[b]->records.size();
+			size_t first = buffers[b]->size > capacity ? buffers[b]->size - capacity : 0;
+			for (size_t r = first; r < buffers[b]->size; r++) {
+				records.push_back(buffers[b]->records[r % capacity]);
+			}
+			delete buffers[b];
+		}
+		buffers.clear();
+		buffer = NULL;
+		_records = 0;
+	}
+
+	// counts and displacements of records have to fit into int
+	size_t limit = INT_MAX / size;
+	if (records.size() > limit) {
+		ESINFO(ALWAYS) << Info::TextColor::YELLOW << "Time trace has too many records, only the last " << limit << " records are stored.";
+		std::sort(records.begin(), records.end(), [] (const TraceRecord &r1, const TraceRecord &r2) { return r1.start < r2.start; });
+		records.erase(records.begin(), records.end() - limit);
+	}
+
+	MPI_Datatype type;
+	MPI_Type_contiguous(sizeof(TraceRecord), MPI_BYTE, &type);
+	MPI_Type_commit(&type);
+
+	int count = records.size();
+	std::vector<int> rcount(size), displacement(size + 1);
+	MPI_Gather(&count, 1, MPI_INT, rcount.data(), 1, MPI_INT, 0, environment->MPICommunicator);
+	for (int r = 0; r < size; r++) {
+		displacement[r + 1] = displacement[r] + rcount[r];
+	}
+
+	std::vector<TraceRecord> all(rank == 0 ? displacement.back() : 0);
+	MPI_Gatherv(records.data(), count, type, all.data(), rcount.data(), displacement.data(), type, 0, environment->MPICommunicator);
+	MPI_Type_free(&type);
+
+	if (rank != 0) {
+		return;
+	}
+
+	std::string mkdir = "mkdir -p " + directory;
+	if (system(mkdir.c_str())) {
+		ESINFO(ALWAYS) << Info::TextColor::YELLOW << "Cannot create directory '" << directory << "' for the time trace.";
+		return;
+	}
+
+	std::ofstream os(directory + "/trace.json");
+	os << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	for (int r = 0; r < size; r++) {
+		os << (r ? ",\n" : "\n");
+		os << "{ \"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << r << ", \"args\": { \"name\": \"MPI rank " << r << "\" } }";
+		for (int i = displacement[r]; i < displacement[r + 1]; i++) {
+			os << ",\n{ \"name\": \"";
+			escape(os, all[i].name);
+			os << "\", \"ph\": \"X\", \"pid\": " << r << ", \"tid\": " << all[i].thread;
+			os << ", \"ts\": " << std::fixed << 1e6 * all[i].start << ", \"dur\": " << 1e6 * (all[i].end - all[i].start) << " }";
+		}
+	}
+	os << "\n] }\n";
+
+	ESINFO(OVERVIEW) << "Time trace stored to '" << directory << "/trace.json'.";
+}
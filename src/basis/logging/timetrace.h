@@ -0,0 +1,35 @@
+
+#ifndef BASIS_LOGGING_TIMETRACE_H_
+#define BASIS_LOGGING_TIMETRACE_H_
+
+#include <string>
+
+namespace espreso {
+
+/**
+ * Timeline of measured events stored in the Chrome trace format (readable by chrome://tracing or Perfetto).
+ *
+ * Each thread appends records to its own ring buffer, hence recording needs no synchronization
+ * (the oldest records of a thread are overwritten when its buffer is full).
+ * Buffers of all threads and processes are merged and stored by 'finish'.
+ */
+struct TimeTrace {
+
+	// allocate 'records' per thread (0 disables tracing), called by all processes
+	static void init(size_t records);
+	static bool enabled() { return _records != 0; }
+
+	// time is measured by TimeEvent::time()
+	static void record(const std::string &name, double start, double end);
+
+	// collect records of all processes and store them to 'directory'/trace.json, called by all processes
+	static void finish(const std::string &directory);
+
+private:
+	static size_t _records;
+	static double _origin;
+};
+
+}
+
+#endif /* BASIS_LOGGING_TIMETRACE_H_ */
@@ -37,6 +37,7 @@ Environment::Environment(): executable("espreso")
 
 	verbose_level = 1;
 	measure_level = testing_level = 0;
+	trace_buffer = 0;
 	remove_old_results = print_matrices = false;
 
 	if (environment == NULL) {
@@ -58,6 +59,10 @@ EnvironmentConfiguration::EnvironmentConfiguration()
 			.setdescription({ "Measure level [0-3]." })
 			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER }));
 
+	REGISTER(trace_buffer, ECFMetaData()
+			.setdescription({ "The number of timeline records kept per thread (0 = tracing is disabled)." })
+			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER }));
+
 	REGISTER(print_matrices, ECFMetaData()
 			.setdescription({ "Print assembler matrices for debugging." })
 			.setdatatype({ ECFDataType::BOOL }));
@@ -29,6 +29,7 @@ struct Environment {
 	size_t verbose_level;
 	size_t testing_level;
 	size_t measure_level;
+	size_t trace_buffer;
 
 	bool print_matrices;
 	bool remove_old_results;
@@ -129,6 +129,12 @@ espreso::OutputConfiguration::OutputConfiguration(const PHYSICS &physics)
 			.addoption(ECFOption().setname("ENSIGHT").setdescription("EnSight format."))
 			.addoption(ECFOption().setname("STL_SURFACE").setdescription("Surface of bodies in STL format.")));
 
+	compression = false;
+	REGISTER(compression, ECFMetaData()
+			.setdescription({ "Compress binary data by zlib" })
+			.setdatatype({ ECFDataType::BOOL })
+			.allowonly([&] () { return format == FORMAT::VTK_XML_BINARY; }));
+
 	mode = MODE::THREAD;
 	REGISTER(mode, ECFMetaData()
 			.setdescription({ "ASYNC library mode" })
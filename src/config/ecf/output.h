@@ -73,6 +73,7 @@ struct OutputConfiguration: public ECFObject {
 	};
 
 	FORMAT format;
+	bool compression;
 	MODE mode;
 
 //	size_t output_node_group_size;
@@ -177,6 +177,11 @@ espreso::HeatTransferConfiguration::HeatTransferConfiguration(DIMENSION dimensio
             .setdescription({ "Thermal shock stabilization" })
 			.setdatatype({ ECFDataType::BOOL }));
 
+	fixed_kernels = true;
+	REGISTER(fixed_kernels, ECFMetaData()
+			.setdescription({ "Assemble 3D elements by kernels specialized for their size (batches of elements in SIMD lanes)" })
+			.setdatatype({ ECFDataType::BOOL }));
+
 	REGISTER(
 			load_steps_settings,
 			ECFMetaData()
@@ -76,7 +76,7 @@ struct HeatTransferConfiguration: public PhysicsConfiguration {
 
 	STABILIZATION stabilization;
 	double sigma;
-	bool init_temp_respect_bc, diffusion_split;
+	bool init_temp_respect_bc, diffusion_split, fixed_kernels;
 
 	std::map<size_t, HeatTransferLoadStepConfiguration> load_steps_settings;
 
@@ -62,6 +62,11 @@ espreso::PhysicsConfiguration::PhysicsConfiguration(DIMENSION dimension, Materia
 	REGISTER(contact_interfaces, ECFMetaData()
             .setdescription({ "Consistent stabilization" })
 			.setdatatype({ ECFDataType::BOOL }));
+
+	geometry_cache = 0;
+	REGISTER(geometry_cache, ECFMetaData()
+			.setdescription({ "Memory [MB] for Jacobians and gradients of shape functions reused by assemblies (0 = no cache)" })
+			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER }));
 }
 
 
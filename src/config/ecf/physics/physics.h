@@ -46,6 +46,8 @@ struct PhysicsConfiguration: public ECFObject {
 
 	bool contact_interfaces;
 
+	size_t geometry_cache;
+
 	PhysicsConfiguration(DIMENSION dimension, MaterialConfiguration::PHYSICAL_MODEL physicalModel);
 };
 
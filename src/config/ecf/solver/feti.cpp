@@ -21,6 +21,21 @@ espreso::FETISolverConfiguration::FETISolverConfiguration()
 			.addoption(ECFOption().setname("DIRICHLET").setdescription("Dirichler precodition."))
 			.addoption(ECFOption().setname("SUPER_DIRICHLET").setdescription("Diagonal Dirichlet precodition.")));
 
+	dirichlet_mode = FETI_DIRICHLET_MODE::EXPLICIT;
+	REGISTER(dirichlet_mode, ECFMetaData()
+			.setdescription({ "Dirichlet preconditioner assembly" })
+			.setdatatype({ ECFDataType::OPTION })
+			.addoption(ECFOption().setname("EXPLICIT").setdescription("Dense Schur complement of each domain."))
+			.addoption(ECFOption().setname("IMPLICIT").setdescription("Schur complement is applied by a factorization of interior DOFs."))
+			.addoption(ECFOption().setname("AUTO").setdescription("IMPLICIT for domains with a large interface."))
+			.allowonly([&] () { return preconditioner == FETI_PRECONDITIONER::DIRICHLET; }));
+
+	dirichlet_implicit_ratio = 10;
+	REGISTER(dirichlet_implicit_ratio, ECFMetaData()
+			.setdescription({ "AUTO uses IMPLICIT if the dense Schur complement is larger than RATIO times non-zeros of interior DOFs" })
+			.setdatatype({ ECFDataType::FLOAT })
+			.allowonly([&] () { return preconditioner == FETI_PRECONDITIONER::DIRICHLET && dirichlet_mode == FETI_DIRICHLET_MODE::AUTO; }));
+
 	precision = 1e-5;
 	REGISTER(precision, ECFMetaData()
             .setdescription({ "Precision" })
@@ -31,7 +46,7 @@ espreso::FETISolverConfiguration::FETISolverConfiguration()
             .setdescription({ "Max iterations" })
 			.setdatatype({ ECFDataType::POSITIVE_INTEGER }));
 
-	iterative_solver = FETI_ITERATIVE_SOLVER::PCG;
+	iterative_solver = FETI_ITERATIVE_SOLVER::pipePCG;
 	REGISTER(iterative_solver, ECFMetaData()
             .setdescription({ "Iterative solver" })
 			.setdatatype({ ECFDataType::OPTION })
@@ -44,6 +59,24 @@ espreso::FETISolverConfiguration::FETISolverConfiguration()
 			.addoption(ECFOption().setname("orthogonalPCG_CP").setdescription("FETI Geneo with full ortogonalization CG"))
 			.addoption(ECFOption().setname("PCG_CP").setdescription("FETI Geneo with regular CG")));
 
+	residual_replacement = 50;
+	REGISTER(residual_replacement, ECFMetaData()
+			.setdescription({ "Number of pipelined PCG iterations after which recurrences are replaced by true residual (0 = never)" })
+			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER })
+			.allowonly([&] () { return iterative_solver == FETI_ITERATIVE_SOLVER::pipePCG; }));
+
+	recycling_size = 0;
+	REGISTER(recycling_size, ECFMetaData()
+			.setdescription({ "Number of search directions recycled from previous solves to deflate the dual operator (0 = no recycling)" })
+			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER })
+			.allowonly([&] () { return iterative_solver == FETI_ITERATIVE_SOLVER::PCG; }));
+
+	warm_start = false;
+	REGISTER(warm_start, ECFMetaData()
+			.setdescription({ "Start the dual solver from the projected solution of the previous solve (time step or Newton iteration)." })
+			.setdatatype({ ECFDataType::BOOL })
+			.allowonly([&] () { return iterative_solver == FETI_ITERATIVE_SOLVER::PCG || iterative_solver == FETI_ITERATIVE_SOLVER::pipePCG; }));
+
 	regularization = FETI_REGULARIZATION::ANALYTIC;
 	REGISTER(regularization, ECFMetaData()
             .setdescription({ "Regularization" })
@@ -60,6 +93,14 @@ espreso::FETISolverConfiguration::FETISolverConfiguration()
 			.addoption(ECFOption().setname("CONJ_R").setdescription("Conjugate projector for transient problems from pseudo-kernel"))
 			.addoption(ECFOption().setname("CONJ_K").setdescription("Conjugate projector for transient problems from stiffness matrix")));
 
+	coarse_problem = FETI_COARSE_PROBLEM::INVERSE;
+	REGISTER(coarse_problem, ECFMetaData()
+			.setdescription({ "Coarse problem" })
+			.setdatatype({ ECFDataType::OPTION })
+			.addoption(ECFOption().setname("INVERSE").setdescription("Each process keeps its stripe of the explicit inverse of GGt."))
+			.addoption(ECFOption().setname("THREE_LEVEL").setdescription("Node-level coarse problems and a global coarse problem on kernels coupled across nodes."))
+			.allowonly([&] () { return conjugate_projector == FETI_CONJ_PROJECTOR::NONE; }));
+
 	geneo_size = 6;
 	restart_iteration = 10;
 	num_restart = 8;
@@ -159,6 +200,21 @@ espreso::FETISolverConfiguration::FETISolverConfiguration()
 			.setdescription({ "Keep factors between iterations." })
 			.setdatatype({ ECFDataType::BOOL }));
 
+	reuse_symbolic_factorization = true;
+	REGISTER(reuse_symbolic_factorization, ECFMetaData()
+			.setdescription({ "Keep FETI preprocessing and symbolic factorization of K if only values of K are changed." })
+			.setdatatype({ ECFDataType::BOOL }));
+
+	cached_operators = 0;
+	REGISTER(cached_operators, ECFMetaData()
+			.setdescription({ "Number of factorized operators kept for a reuse in addition to the current one (e.g. by a transient solver with alternating time steps)." })
+			.setdatatype({ ECFDataType::NONNEGATIVE_INTEGER }));
+
+	store_instance = false;
+	REGISTER(store_instance, ECFMetaData()
+			.setdescription({ "Store a binary snapshot of the solved system for 'espreso-feti-bench'." })
+			.setdatatype({ ECFDataType::BOOL }));
+
 	sc_size = 200;
 	n_mics = 2;
 	REGISTER(sc_size, ECFMetaData()
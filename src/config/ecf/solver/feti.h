@@ -47,6 +47,15 @@ enum class FETI_PRECONDITIONER {
 	MAGIC = 5
 };
 
+enum class FETI_DIRICHLET_MODE {
+	/// Dense Schur complement S is assembled
+	EXPLICIT = 0,
+	/// S is applied by sparse matrices and a factorization of K_rr
+	IMPLICIT = 1,
+	/// Chosen per domain according to the size of the interface
+	AUTO = 2
+};
+
 enum class FETI_CONJ_PROJECTOR {
 	/// No conj projector
 	NONE = 0,
@@ -57,6 +66,13 @@ enum class FETI_CONJ_PROJECTOR {
 	CONJ_K
 };
 
+enum class FETI_COARSE_PROBLEM {
+	/// Distributed explicit inverse of GGt
+	INVERSE = 0,
+	/// Node-level coarse problems and a global coarse problem on interface kernels
+	THREE_LEVEL = 1
+};
+
 enum class FETI_REGULARIZATION {
 	/// Based on a physics
 	ANALYTIC = 0,
@@ -120,10 +136,15 @@ struct FETISolverConfiguration: public ECFObject {
 	FETI_METHOD method;
 	FETI_ITERATIVE_SOLVER iterative_solver;
 	FETI_PRECONDITIONER preconditioner;
+	FETI_DIRICHLET_MODE dirichlet_mode;
+	double dirichlet_implicit_ratio;
 	FETI_REGULARIZATION regularization;
 	FETI_CONJ_PROJECTOR conjugate_projector;
+	FETI_COARSE_PROBLEM coarse_problem;
 
 	size_t geneo_size, restart_iteration, num_restart;
+	size_t residual_replacement, recycling_size;
+	bool warm_start;
 
 	bool orthogonal_K_kernels;
 	bool redundant_lagrange, scaling;
@@ -141,6 +162,9 @@ struct FETISolverConfiguration: public ECFObject {
 	FETI_MATRIX_STORAGE schur_type;
 
 	bool mp_pseudoinverse, combine_sc_and_spds, keep_factors;
+	bool reuse_symbolic_factorization;
+	size_t cached_operators;
+	bool store_instance;
 
 	size_t sc_size, n_mics;
 	bool load_balancing, load_balancing_preconditioner;
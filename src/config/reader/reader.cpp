@@ -14,6 +14,7 @@
 #include "../ecf/output.h"
 #include "../ecf/environment.h"
 #include "../../basis/logging/logging.h"
+#include "../../basis/logging/timetrace.h"
 #include "../../basis/utilities/parser.h"
 
 using namespace espreso;
@@ -435,6 +436,7 @@ void ECFReader::set(const Environment &env, const OutputConfiguration &output)
 {
 	Info::setLevel(env.verbose_level, env.testing_level);
 	Measure::setLevel(env.measure_level);
+	TimeTrace::init(env.trace_buffer);
 	Logging::path = output.path;
 	Logging::debug = env.log_dir;
 	Logging::rank = env.MPIrank;
@@ -0,0 +1,217 @@
+
+#include "esdata.h"
+
+#include "../../basis/containers/serializededata.h"
+#include "../../basis/logging/logging.h"
+#include "../../basis/logging/timeeval.h"
+#include "../../basis/utilities/utils.h"
+#include "../../config/ecf/environment.h"
+#include "../../config/ecf/input/input.h"
+
+#include "../../mesh/mesh.h"
+#include "../../mesh/elements/element.h"
+#include "../../mesh/store/nodestore.h"
+#include "../../mesh/store/elementstore.h"
+#include "../../mesh/store/elementsregionstore.h"
+#include "../../mesh/store/boundaryregionstore.h"
+
+#include "../../output/data/espresobinaryformat.h"
+
+using namespace espreso;
+
+// MPI-IO count has to fit into int
+static const size_t MPI_IO_BLOCK = 1 << 30;
+
+template <typename TType>
+static serializededata<eslocal, TType>* serialize(const std::vector<size_t> &distribution, const std::vector<eslocal> &boundaries, const std::vector<TType> &data)
+{
+	size_t threads = distribution.size() - 1;
+	std::vector<std::vector<eslocal> > tboundaries(threads);
+	std::vector<std::vector<TType> > tdata(threads);
+
+	#pragma omp parallel for
+	for (size_t t = 0; t < threads; t++) {
+		tboundaries[t].insert(tboundaries[t].end(), boundaries.begin() + distribution[t] + (t ? 1 : 0), boundaries.begin() + distribution[t + 1] + 1);
+		tdata[t].insert(tdata[t].end(), data.begin() + boundaries[distribution[t]], data.begin() + boundaries[distribution[t + 1]]);
+	}
+
+	return new serializededata<eslocal, TType>(tboundaries, tdata);
+}
+
+static serializededata<eslocal, Element*>* epointers(Mesh &mesh, const std::vector<size_t> &distribution, const std::vector<int> &codes)
+{
+	size_t threads = distribution.size() - 1;
+	std::vector<std::vector<Element*> > tepointers(threads);
+
+	#pragma omp parallel for
+	for (size_t t = 0; t < threads; t++) {
+		for (size_t e = distribution[t]; e < distribution[t + 1]; ++e) {
+			tepointers[t].push_back(&mesh._eclasses[t][codes[e]]);
+		}
+	}
+
+	return new serializededata<eslocal, Element*>(1, tepointers);
+}
+
+void ESDATALoader::load(const InputConfiguration &configuration, Mesh &mesh)
+{
+	ESDATALoader(configuration, mesh);
+}
+
+ESDATALoader::ESDATALoader(const InputConfiguration &configuration, Mesh &mesh)
+: _configuration(configuration), _mesh(mesh), _p(NULL)
+{
+	TimeEval timing("Load ESDATA");
+	timing.totalTime.startWithBarrier();
+	ESINFO(OVERVIEW) << "Load ESDATA from '" << _configuration.path << "'.";
+
+	TimeEvent tread("read data from file"); tread.start();
+	readData();
+	tread.end(); timing.addEvent(tread);
+	ESINFO(PROGRESS2) << "ESDATA:: data copied from file.";
+
+	TimeEvent tnodes("fill nodes"); tnodes.start();
+	fillNodes();
+	tnodes.end(); timing.addEvent(tnodes);
+	ESINFO(PROGRESS2) << "ESDATA:: nodes filled.";
+
+	TimeEvent telements("fill elements"); telements.start();
+	fillElements();
+	telements.end(); timing.addEvent(telements);
+	ESINFO(PROGRESS2) << "ESDATA:: elements filled.";
+
+	TimeEvent tregions("fill regions"); tregions.start();
+	fillRegions();
+	tregions.end(); timing.addEvent(tregions);
+	ESINFO(PROGRESS2) << "ESDATA:: regions filled.";
+
+	timing.totalTime.endWithBarrier();
+	timing.printStatsMPI();
+}
+
+void ESDATALoader::readData()
+{
+	MPI_File MPIfile;
+	if (MPI_File_open(environment->MPICommunicator, _configuration.path.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &MPIfile)) {
+		ESINFO(GLOBAL_ERROR) << "Cannot open ESDATA file '" << _configuration.path << "'.";
+	}
+
+	std::vector<size_t> header(2);
+	MPI_File_read_at_all(MPIfile, 0, header.data(), header.size() * sizeof(size_t), MPI_BYTE, MPI_STATUS_IGNORE);
+	if (header[0] != ESPRESOBinaryFormat::IDENTIFIER) {
+		ESINFO(GLOBAL_ERROR) << "File '" << _configuration.path << "' is not ESDATA file or it was stored by a different version of ESPRESO.";
+	}
+	if (header[1] != (size_t)environment->MPIsize) {
+		ESINFO(GLOBAL_ERROR) << "ESDATA file '" << _configuration.path << "' was stored for " << header[1] << " MPI processes. "
+				<< "Run ESPRESO on the same number of MPI processes or convert the database again.";
+	}
+
+	std::vector<size_t> offsets(environment->MPIsize + 1);
+	MPI_File_read_at_all(MPIfile, header.size() * sizeof(size_t), offsets.data(), offsets.size() * sizeof(size_t), MPI_BYTE, MPI_STATUS_IGNORE);
+	MPI_Offset offset = (header.size() + offsets.size()) * sizeof(size_t) + offsets[environment->MPIrank];
+
+	_data.resize(offsets[environment->MPIrank + 1] - offsets[environment->MPIrank]);
+
+	MPI_Datatype block;
+	MPI_Type_contiguous(MPI_IO_BLOCK, MPI_BYTE, &block);
+	MPI_Type_commit(&block);
+
+	size_t blocks = _data.size() / MPI_IO_BLOCK, rest = _data.size() % MPI_IO_BLOCK;
+	MPI_File_read_at_all(MPIfile, offset, _data.data(), blocks, block, MPI_STATUS_IGNORE);
+	MPI_File_read_at_all(MPIfile, offset + blocks * MPI_IO_BLOCK, _data.data() + blocks * MPI_IO_BLOCK, rest, MPI_BYTE, MPI_STATUS_IGNORE);
+
+	MPI_File_close(&MPIfile);
+	MPI_Type_free(&block);
+
+	_p = _data.data();
+}
+
+void ESDATALoader::fillNodes()
+{
+	size_t threads = environment->OMP_NUM_THREADS;
+
+	std::vector<eslocal> IDs, rdistribution;
+	std::vector<Point> coordinates;
+	std::vector<int> ranks;
+
+	Esutils::unpack(_mesh.nodes->size, _p);
+	Esutils::unpack(IDs, _p);
+	Esutils::unpack(coordinates, _p);
+	Esutils::unpack(rdistribution, _p);
+	Esutils::unpack(ranks, _p);
+
+	_mesh.nodes->distribution = tarray<size_t>::distribute(threads, _mesh.nodes->size);
+	_mesh.nodes->IDs = new serializededata<eslocal, eslocal>(1, tarray<eslocal>(_mesh.nodes->distribution, IDs));
+	_mesh.nodes->coordinates = new serializededata<eslocal, Point>(1, tarray<Point>(_mesh.nodes->distribution, coordinates));
+	_mesh.nodes->ranks = serialize(_mesh.nodes->distribution, rdistribution, ranks);
+}
+
+void ESDATALoader::fillElements()
+{
+	size_t threads = environment->OMP_NUM_THREADS;
+
+	std::vector<eslocal> IDs, edistribution, enodes;
+	std::vector<int> codes, body, material;
+
+	Esutils::unpack(_mesh.elements->size, _p);
+	Esutils::unpack(IDs, _p);
+	Esutils::unpack(edistribution, _p);
+	Esutils::unpack(enodes, _p);
+	Esutils::unpack(codes, _p);
+	Esutils::unpack(body, _p);
+	Esutils::unpack(material, _p);
+	Esutils::unpack(_mesh.elements->nclusters, _p);
+	Esutils::unpack(_mesh.elements->clusters, _p);
+	Esutils::unpack(_mesh.elements->elementsDistribution, _p);
+
+	_mesh.elements->dimension = _mesh.dimension;
+	_mesh.elements->distribution = tarray<size_t>::distribute(threads, _mesh.elements->size);
+	_mesh.elements->IDs = new serializededata<eslocal, eslocal>(1, tarray<eslocal>(_mesh.elements->distribution, IDs));
+	_mesh.elements->nodes = serialize(_mesh.elements->distribution, edistribution, enodes);
+	_mesh.elements->epointers = epointers(_mesh, _mesh.elements->distribution, codes);
+	_mesh.elements->body = new serializededata<eslocal, int>(1, tarray<int>(_mesh.elements->distribution, body));
+	_mesh.elements->material = new serializededata<eslocal, int>(1, tarray<int>(_mesh.elements->distribution, material));
+	_mesh.elements->ndomains = _mesh.elements->elementsDistribution.size() - 1;
+}
+
+void ESDATALoader::fillRegions()
+{
+	size_t threads = environment->OMP_NUM_THREADS;
+
+	size_t regions;
+	std::string name;
+
+	Esutils::unpack(regions, _p);
+	for (size_t r = 0; r < regions; r++) {
+		std::vector<eslocal> elements;
+		Esutils::unpack(name, _p);
+		Esutils::unpack(elements, _p);
+		_mesh.elementsRegions.push_back(new ElementsRegionStore(name));
+		_mesh.elementsRegions.back()->elements = new serializededata<eslocal, eslocal>(1, tarray<eslocal>(threads, elements));
+	}
+
+	Esutils::unpack(regions, _p);
+	for (size_t r = 0; r < regions; r++) {
+		Esutils::unpack(name, _p);
+		_mesh.boundaryRegions.push_back(new BoundaryRegionStore(name, _mesh._eclasses));
+		BoundaryRegionStore *region = _mesh.boundaryRegions.back();
+		Esutils::unpack(region->dimension, _p);
+		if (region->dimension) {
+			std::vector<eslocal> edistribution, enodes;
+			std::vector<int> codes;
+			Esutils::unpack(edistribution, _p);
+			Esutils::unpack(enodes, _p);
+			Esutils::unpack(codes, _p);
+			region->distribution = tarray<size_t>::distribute(threads, codes.size());
+			region->elements = serialize(region->distribution, edistribution, enodes);
+			region->epointers = epointers(_mesh, region->distribution, codes);
+		} else {
+			std::vector<eslocal> nodes;
+			Esutils::unpack(nodes, _p);
+			region->nodes = new serializededata<eslocal, eslocal>(1, tarray<eslocal>(threads, nodes));
+		}
+	}
+
+	Esutils::unpack(_mesh.neighbours, _p);
+	Esutils::unpack(_mesh.neighboursWithMe, _p);
+}
@@ -0,0 +1,37 @@
+
+#ifndef SRC_INPUT_ESDATA_ESDATA_H_
+#define SRC_INPUT_ESDATA_ESDATA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace espreso {
+
+class InputConfiguration;
+class Mesh;
+
+class ESDATALoader {
+
+public:
+	static void load(const InputConfiguration &configuration, Mesh &mesh);
+
+protected:
+	ESDATALoader(const InputConfiguration &configuration, Mesh &mesh);
+
+	void readData();
+	void fillNodes();
+	void fillElements();
+	void fillRegions();
+
+	const InputConfiguration &_configuration;
+	Mesh &_mesh;
+
+	std::vector<char> _data;
+	const char *_p;
+};
+
+}
+
+
+
+#endif /* SRC_INPUT_ESDATA_ESDATA_H_ */
@@ -2,6 +2,7 @@
 #include "input.h"
 #include "workbench/workbench.h"
 #include "openfoam/openfoam.h"
+#include "esdata/esdata.h"
 #include "meshgenerator/meshgenerator.h"
 
 #include "../basis/containers/serializededata.h"
@@ -33,6 +34,10 @@ void Input::load(const ECFRoot &configuration, Mesh &mesh)
 		OpenFOAMLoader::load(configuration.openfoam, mesh);
 		mesh.update();
 		break;
+	case INPUT_FORMAT::ESDATA:
+		ESDATALoader::load(configuration.esdata, mesh);
+		mesh.update();
+		break;
 	case INPUT_FORMAT::GENERATOR:
 	default:
 		MeshGenerator::generate(configuration.generator, mesh);
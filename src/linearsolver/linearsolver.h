@@ -19,6 +19,11 @@ public:
 
 	virtual double& precision() =0;
 
+	// keep the current operator under a given key (e.g. a time step) for a later reuse
+	virtual void storeOperator(double key) {}
+	// set the operator stored under a given key as the current one (returns false if it is not stored)
+	virtual bool restoreOperator(double key) { return false; }
+
 	virtual ~LinearSolver() {}
 };
 
@@ -256,15 +256,20 @@ void Mesh::update()
 		uniformDecomposition = false;
 	}
 
-	if (configuration.decomposition.balance_clusters) {
-		preprocessing->reclusterize();
-	}
-
-	uniformDecomposition = false;
-	if (uniformDecomposition) {
-		// implement uniform decomposition
+	if (elements->elementsDistribution.size()) {
+		// the mesh was loaded already decomposed (ESDATA)
+		preprocessing->restoreDecomposition();
 	} else {
-		preprocessing->partitiate(preferedDomains);
+		if (configuration.decomposition.balance_clusters) {
+			preprocessing->reclusterize();
+		}
+
+		uniformDecomposition = false;
+		if (uniformDecomposition) {
+			// implement uniform decomposition
+		} else {
+			preprocessing->partitiate(preferedDomains);
+		}
 	}
 
 	if (configuration.physics == PHYSICS::STRUCTURAL_MECHANICS_2D || configuration.physics == PHYSICS::STRUCTURAL_MECHANICS_3D) {
@@ -307,6 +307,26 @@ void MeshPreprocessing::partitiate(eslocal parts)
 		finish("reindex METIS output");
 	}
 
+	distributeDomains(partition, clusters);
+}
+
+void MeshPreprocessing::restoreDecomposition()
+{
+	std::vector<eslocal> partition(_mesh->elements->size);
+	for (size_t d = 1; d < _mesh->elements->elementsDistribution.size(); d++) {
+		std::fill(partition.begin() + _mesh->elements->elementsDistribution[d - 1], partition.begin() + _mesh->elements->elementsDistribution[d], d - 1);
+	}
+	std::vector<int> clusters;
+	clusters.swap(_mesh->elements->clusters);
+	_mesh->elements->elementsDistribution.clear();
+
+	distributeDomains(partition, clusters);
+}
+
+void MeshPreprocessing::distributeDomains(const std::vector<eslocal> &partition, const std::vector<int> &clusters)
+{
+	size_t threads = environment->OMP_NUM_THREADS;
+
 	start("post-process domains");
 
 	std::vector<eslocal> permutation(partition.size());
@@ -42,6 +42,7 @@ public:
 
 	void reclusterize();
 	void partitiate(eslocal parts);
+	void restoreDecomposition();
 
 	void arrangeNodes();
 	void arrangeElements();
@@ -85,6 +86,7 @@ protected:
 private:
 	void permuteElements(const std::vector<eslocal> &permutation, const std::vector<size_t> &distribution);
 	void arrangeElementsPermutation(std::vector<eslocal> &permutation);
+	void distributeDomains(const std::vector<eslocal> &partition, const std::vector<int> &clusters);
 	void computeBoundaryNodes(std::vector<eslocal> &externalBoundary, std::vector<eslocal> &internalBoundary);
 	void fillRegionMask();
 	void computeRegionArea(BoundaryRegionStore *store);
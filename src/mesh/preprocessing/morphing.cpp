@@ -605,6 +605,7 @@ void MeshPreprocessing::morphRBF(const std::string &name, const RBFTargetConfigu
 		}
 	}
 	finish("applying morphing '" + name + "'");
+	++_mesh->nodes->coordinatesVersion;
 
 
 	if (_morphing == NULL) {
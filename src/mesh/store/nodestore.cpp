@@ -25,6 +25,7 @@ NodeStore::NodeStore()
   originCoordinates(NULL),
   coordinates(NULL),
   ranks(NULL),
+  coordinatesVersion(0),
 
   idomains(NULL),
   ineighborOffsets(NULL),
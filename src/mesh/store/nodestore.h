@@ -79,6 +79,7 @@ struct NodeStore {
 	serializededata<eslocal, Point>* originCoordinates;
 	serializededata<eslocal, Point>* coordinates;
 	serializededata<eslocal, int>* ranks;
+	size_t coordinatesVersion; // increased by each change of coordinates (e.g. mesh morphing)
 
 	std::vector<eslocal> externalIntervals;
 	std::vector<ProcessInterval> pintervals;
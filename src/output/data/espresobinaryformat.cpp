@@ -1,12 +1,146 @@
 
 #include "espresobinaryformat.h"
 
+#include "../../basis/containers/serializededata.h"
+#include "../../basis/logging/logging.h"
+#include "../../basis/logging/timeeval.h"
+#include "../../basis/utilities/utils.h"
+#include "../../basis/utilities/communication.h"
+
 #include "../../config/ecf/environment.h"
 
+#include "../../mesh/mesh.h"
+#include "../../mesh/elements/element.h"
+#include "../../mesh/store/nodestore.h"
+#include "../../mesh/store/elementstore.h"
+#include "../../mesh/store/elementsregionstore.h"
+#include "../../mesh/store/boundaryregionstore.h"
+
 using namespace espreso;
 
-void ESPRESOBinaryFormat::store(const Mesh &mesh, const ECFRoot &configuration)
+// 'ESDATA' + version
+const size_t ESPRESOBinaryFormat::IDENTIFIER = 0x4553444154410001;
+
+// MPI-IO count has to fit into int
+static const size_t MPI_IO_BLOCK = 1 << 30;
+
+template <typename TType>
+static void push(std::vector<char> &buffer, const TType &data)
+{
+	size_t offset = buffer.size();
+	buffer.resize(offset + Esutils::packedSize(data));
+	char *p = buffer.data() + offset;
+	Esutils::pack(data, p);
+}
+
+template <typename TType>
+static void push(std::vector<char> &buffer, const tarray<TType> &data)
 {
+	push(buffer, std::vector<TType>(data.begin(), data.end()));
+}
 
+static void pushCodes(std::vector<char> &buffer, const serializededata<eslocal, Element*> *epointers)
+{
+	std::vector<int> codes;
+	codes.reserve(epointers->datatarray().size());
+	for (auto e = epointers->datatarray().begin(); e != epointers->datatarray().end(); ++e) {
+		codes.push_back(static_cast<int>((*e)->code));
+	}
+	push(buffer, codes);
 }
 
+void ESPRESOBinaryFormat::store(const Mesh &mesh, const ECFRoot &configuration)
+{
+	TimeEval timing("Store ESDATA");
+	timing.totalTime.startWithBarrier();
+
+	TimeEvent tpack("pack mesh"); tpack.start();
+
+	std::vector<char> buffer;
+
+	push(buffer, mesh.nodes->size);
+	push(buffer, mesh.nodes->IDs->datatarray());
+	push(buffer, mesh.nodes->coordinates->datatarray());
+	push(buffer, mesh.nodes->ranks->boundarytarray());
+	push(buffer, mesh.nodes->ranks->datatarray());
+
+	push(buffer, mesh.elements->size);
+	push(buffer, mesh.elements->IDs->datatarray());
+	push(buffer, mesh.elements->nodes->boundarytarray());
+	push(buffer, mesh.elements->nodes->datatarray());
+	pushCodes(buffer, mesh.elements->epointers);
+	push(buffer, mesh.elements->body->datatarray());
+	push(buffer, mesh.elements->material->datatarray());
+	push(buffer, mesh.elements->nclusters);
+	push(buffer, mesh.elements->clusters);
+	push(buffer, mesh.elements->elementsDistribution);
+
+	std::vector<const ElementsRegionStore*> eregions;
+	for (size_t r = 0; r < mesh.elementsRegions.size(); r++) {
+		// the region is created during preprocessing
+		if (mesh.elementsRegions[r]->name.compare("NAMELESS_ELEMENT_SET") != 0) {
+			eregions.push_back(mesh.elementsRegions[r]);
+		}
+	}
+	push(buffer, eregions.size());
+	for (size_t r = 0; r < eregions.size(); r++) {
+		push(buffer, eregions[r]->name);
+		push(buffer, eregions[r]->elements->datatarray());
+	}
+
+	push(buffer, mesh.boundaryRegions.size());
+	for (size_t r = 0; r < mesh.boundaryRegions.size(); r++) {
+		const BoundaryRegionStore *region = mesh.boundaryRegions[r];
+		push(buffer, region->name);
+		push(buffer, region->dimension);
+		if (region->dimension) {
+			push(buffer, region->elements->boundarytarray());
+			push(buffer, region->elements->datatarray());
+			pushCodes(buffer, region->epointers);
+		} else {
+			push(buffer, region->nodes->datatarray());
+		}
+	}
+
+	push(buffer, mesh.neighbours);
+	push(buffer, mesh.neighboursWithMe);
+
+	tpack.end(); timing.addEvent(tpack);
+
+	TimeEvent twrite("write file"); twrite.start();
+
+	std::string file = Logging::outputRoot() + "/" + Logging::name + ".esdata";
+	std::vector<size_t> offsets = Communication::getDistribution<size_t>(buffer.size());
+
+	std::vector<size_t> header = { IDENTIFIER, (size_t)environment->MPIsize };
+	header.insert(header.end(), offsets.begin(), offsets.end());
+	MPI_Offset offset = header.size() * sizeof(size_t) + offsets[environment->MPIrank];
+
+	MPI_File MPIfile;
+	if (MPI_File_open(environment->MPICommunicator, file.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &MPIfile)) {
+		ESINFO(GLOBAL_ERROR) << "Cannot create ESDATA file '" << file << "'.";
+	}
+	MPI_File_set_size(MPIfile, 0);
+
+	if (environment->MPIrank == 0) {
+		MPI_File_write_at(MPIfile, 0, header.data(), header.size() * sizeof(size_t), MPI_BYTE, MPI_STATUS_IGNORE);
+	}
+
+	MPI_Datatype block;
+	MPI_Type_contiguous(MPI_IO_BLOCK, MPI_BYTE, &block);
+	MPI_Type_commit(&block);
+
+	size_t blocks = buffer.size() / MPI_IO_BLOCK, rest = buffer.size() % MPI_IO_BLOCK;
+	MPI_File_write_at_all(MPIfile, offset, buffer.data(), blocks, block, MPI_STATUS_IGNORE);
+	MPI_File_write_at_all(MPIfile, offset + blocks * MPI_IO_BLOCK, buffer.data() + blocks * MPI_IO_BLOCK, rest, MPI_BYTE, MPI_STATUS_IGNORE);
+
+	MPI_File_close(&MPIfile);
+	MPI_Type_free(&block);
+
+	twrite.end(); timing.addEvent(twrite);
+
+	timing.totalTime.endWithBarrier();
+	timing.printStatsMPI();
+
+	ESINFO(OVERVIEW) << "Mesh stored to '" << file << "'. Run ESPRESO with INPUT=ESDATA and ESDATA::PATH=" << file << " on " << environment->MPIsize << " MPI processes.";
+}
@@ -2,14 +2,26 @@
 #ifndef SRC_OUTPUT_DATA_ESPRESOBINARYFORMAT_H_
 #define SRC_OUTPUT_DATA_ESPRESOBINARYFORMAT_H_
 
+#include <cstddef>
+
 namespace espreso {
 
 class Mesh;
 struct ECFRoot;
 
+/**
+ * ESDATA is a decomposed mesh stored to one binary file.
+ *
+ * The file starts with the header [IDENTIFIER, number of MPI processes, offsets of processes' chunks].
+ * Each chunk contains local nodes, elements, regions and domains decomposition
+ * of one MPI process in the same order as they are in the already preprocessed mesh.
+ * Hence, the mesh can be loaded by the same number of MPI processes without any balancing or partitioning.
+ */
 class ESPRESOBinaryFormat {
 
 public:
+	static const size_t IDENTIFIER;
+
 	static void store(const Mesh &mesh, const ECFRoot &configuration);
 
 };
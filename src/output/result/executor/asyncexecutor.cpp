@@ -2,6 +2,7 @@
 #include "asyncexecutor.h"
 
 #include "../../../basis/utilities/utils.h"
+#include "../../../basis/logging/timeeval.h"
 #include "../../../assembler/step.h"
 #include "../../../config/ecf/root.h"
 
@@ -11,6 +12,8 @@
 #include "../../../mesh/store/elementsregionstore.h"
 #include "../../../mesh/store/boundaryregionstore.h"
 
+#include <cstring>
+
 using namespace espreso;
 
 std::vector<int> AsyncBufferManager::_indices(Buffer::SIZE, -1);
@@ -63,28 +66,104 @@ void AsyncStore::updateMesh()
 		}
 	}
 
+	// the executor has a new mesh -> send all solution fields again
+	_fields.clear();
+	_sent.clear();
+
 	call(ExecParameters(AsyncBufferManager::NODES, AsyncBufferManager::ELEMENTS, AsyncBufferManager::ELEMENTREGIONS, AsyncBufferManager::BOUNDARYREGIONS));
 }
 
+void AsyncStore::solutionFields(std::vector<SolutionField> &fields, std::vector<const double*> &values)
+{
+	auto push = [&] (SolutionField::Type type, int data, int domain, const std::vector<double> &vector) {
+		fields.push_back({ type, data, domain, 0, fields.size() ? fields.back().offset + fields.back().size : 0, vector.size() });
+		values.push_back(vector.data());
+	};
+
+	// only named data are sent to the executor (see NodeStore::pack and ElementStore::pack)
+	for (size_t i = 0, n = 0; i < _mesh.nodes->data.size(); i++) {
+		if (_mesh.nodes->data[i]->names.size()) {
+			if (isCollected()) {
+				push(SolutionField::Type::GATHERED_NODE_DATA, n, 0, _mesh.nodes->data[i]->gatheredData);
+			}
+			if (isSeparated()) {
+				for (size_t d = 0; d < _mesh.nodes->data[i]->decomposedData->size(); d++) {
+					push(SolutionField::Type::DECOMPOSED_NODE_DATA, n, d, (*_mesh.nodes->data[i]->decomposedData)[d]);
+				}
+			}
+			++n;
+		}
+	}
+	for (size_t i = 0, n = 0; i < _mesh.elements->data.size(); i++) {
+		if (_mesh.elements->data[i]->names.size()) {
+			push(SolutionField::Type::ELEMENT_DATA, n++, 0, *_mesh.elements->data[i]->data);
+		}
+	}
+}
+
 void AsyncStore::updateSolution(const Step &step)
 {
-	wait();
+	std::vector<SolutionField> fields;
+	std::vector<const double*> values;
+	solutionFields(fields, values);
 
-	prepareBuffer(AsyncBufferManager::NODEDATA, sizeof(Step) + _mesh.nodes->packedDataSize(isCollected(), isSeparated()));
-	_buffer = managedBuffer<char*>(AsyncBufferManager::buffer(AsyncBufferManager::NODEDATA));
-	Esutils::pack(step, _buffer);
-	_mesh.nodes->packData(_buffer, isCollected(), isSeparated());
+	size_t header = sizeof(Step) + sizeof(size_t) + fields.size() * sizeof(SolutionField);
+	size_t size = header + (fields.size() ? fields.back().offset + fields.back().size : 0) * sizeof(double);
+
+	bool sameLayout = fields.size() == _fields.size();
+	for (size_t f = 0; sameLayout && f < fields.size(); f++) {
+		sameLayout = fields[f].sameLayout(_fields[f]);
+	}
+	if (!sameLayout) {
+		_fields = fields;
+		_sent.assign(fields.size(), -1);
+	}
 
-	prepareBuffer(AsyncBufferManager::ELEMENTDATA, sizeof(Step) + _mesh.elements->packedDataSize());
-	_buffer = managedBuffer<char*>(AsyncBufferManager::buffer(AsyncBufferManager::ELEMENTDATA));
+	// the executor is storing the other buffer -> this one is free (see 'wait' below)
+	int current = _solutionBuffer = (_solutionBuffer + 1) % 2;
+	AsyncBufferManager::Buffer buffer = current ? AsyncBufferManager::SOLUTION1 : AsyncBufferManager::SOLUTION0;
+	AsyncBufferManager::Buffer other = current ? AsyncBufferManager::SOLUTION0 : AsyncBufferManager::SOLUTION1;
+
+	int index = AsyncBufferManager::buffer(buffer);
+	if (index == -1 || bufferSize(index) != size) {
+		// ASYNC cannot change buffers while the executor is running
+		wait();
+		prepareBuffer(buffer, size);
+	}
+
+	char *data[2];
+	data[current] = managedBuffer<char*>(AsyncBufferManager::buffer(buffer)) + header;
+	data[1 - current] = AsyncBufferManager::buffer(other) == -1 ? NULL : managedBuffer<char*>(AsyncBufferManager::buffer(other)) + header;
+
+	// The executor only reads the other buffer, hence it can be compared with the actual values.
+	// Unchanged fields are not copied (and not unpacked by the executor).
+	#pragma omp parallel for
+	for (size_t f = 0; f < fields.size(); f++) {
+		size_t bytes = fields[f].size * sizeof(double);
+		if (_sent[f] != -1 && memcmp(data[_sent[f]] + fields[f].offset * sizeof(double), values[f], bytes) == 0) {
+			fields[f].changed = 0;
+		} else {
+			memcpy(data[current] + fields[f].offset * sizeof(double), values[f], bytes);
+			fields[f].changed = 1;
+			_sent[f] = current;
+		}
+	}
+
+	_buffer = managedBuffer<char*>(AsyncBufferManager::buffer(buffer));
 	Esutils::pack(step, _buffer);
-	_mesh.elements->packData(_buffer);
+	Esutils::pack(fields.size(), _buffer);
+	memcpy(_buffer, fields.data(), fields.size() * sizeof(SolutionField));
 
-	call(ExecParameters(AsyncBufferManager::NODEDATA, AsyncBufferManager::ELEMENTDATA));
+	TimeEvent event("Wait for asynchronous output");
+	event.startWithoutBarrier();
+	wait();
+	event.endWithoutBarrier();
+	call(ExecParameters(buffer));
 }
 
 AsyncStore::AsyncStore(const Mesh &mesh, const OutputConfiguration &configuration)
-: ResultStoreExecutor(mesh, configuration), _executor(mesh.configuration), _buffer(NULL)
+: ResultStoreExecutor(mesh, configuration), _executor(mesh.configuration), _buffer(NULL),
+  _solutionBuffer(1)
 {
 	async::Module<AsyncExecutor, InitParameters, ExecParameters>::init();
 	callInit(InitParameters());
@@ -129,6 +208,9 @@ void AsyncExecutor::execInit(const async::ExecInfo &info, const InitParameters &
 
 void AsyncExecutor::exec(const async::ExecInfo &info, const ExecParameters &parameters)
 {
+	TimeEvent event("Asynchronous output");
+	event.startWithoutBarrier();
+
 	if (parameters.updatedBuffers & 1 << AsyncBufferManager::NODES) {
 		_mesh.nodes->unpack(_buffer = static_cast<const char*>(info.buffer(AsyncBufferManager::buffer(AsyncBufferManager::NODES))));
 	}
@@ -162,23 +244,42 @@ void AsyncExecutor::exec(const async::ExecInfo &info, const ExecParameters &para
 		updateMesh();
 	}
 
-	Step step;
-	if (parameters.updatedBuffers & 1 << AsyncBufferManager::NODEDATA) {
-		_buffer = static_cast<const char*>(info.buffer(AsyncBufferManager::buffer(AsyncBufferManager::NODEDATA)));
-		Esutils::unpack(step, _buffer);
-		_mesh.nodes->unpackData(_buffer, isCollected(), isSeparated());
-	}
+	for (int b = AsyncBufferManager::SOLUTION0; b <= AsyncBufferManager::SOLUTION1; b++) {
+		if (parameters.updatedBuffers & 1 << b) {
+			_buffer = static_cast<const char*>(info.buffer(AsyncBufferManager::buffer(static_cast<AsyncBufferManager::Buffer>(b))));
 
-	if (parameters.updatedBuffers & 1 << AsyncBufferManager::ELEMENTDATA) {
-		_buffer = static_cast<const char*>(info.buffer(AsyncBufferManager::buffer(AsyncBufferManager::ELEMENTDATA)));
-		Esutils::unpack(step, _buffer);
-		_mesh.elements->unpackData(_buffer);
+			Step step;
+			size_t nfields;
+			Esutils::unpack(step, _buffer);
+			Esutils::unpack(nfields, _buffer);
+			const SolutionField *fields = reinterpret_cast<const SolutionField*>(_buffer);
+			const double *values = reinterpret_cast<const double*>(_buffer + nfields * sizeof(SolutionField));
+
+			for (size_t f = 0; f < nfields; f++) {
+				if (fields[f].changed) {
+					solutionField(fields[f]).assign(values + fields[f].offset, values + fields[f].offset + fields[f].size);
+				}
+			}
+
+			updateSolution(step);
+		}
 	}
 
-	if (
-			(parameters.updatedBuffers & 1 << AsyncBufferManager::NODEDATA) ||
-			(parameters.updatedBuffers & 1 << AsyncBufferManager::ELEMENTDATA)) {
+	event.endWithoutBarrier();
+}
 
-		updateSolution(step);
+std::vector<double>& AsyncExecutor::solutionField(const SolutionField &field)
+{
+	switch (field.type) {
+	case SolutionField::Type::GATHERED_NODE_DATA:
+		return _mesh.nodes->data[field.data]->gatheredData;
+	case SolutionField::Type::DECOMPOSED_NODE_DATA:
+		if (_mesh.nodes->data[field.data]->decomposedData->size() <= (size_t)field.domain) {
+			_mesh.nodes->data[field.data]->decomposedData->resize(field.domain + 1);
+		}
+		return (*_mesh.nodes->data[field.data]->decomposedData)[field.domain];
+	case SolutionField::Type::ELEMENT_DATA:
+	default:
+		return *_mesh.elements->data[field.data]->data;
 	}
 }
@@ -19,8 +19,9 @@ public:
 		ELEMENTREGIONS,
 		BOUNDARYREGIONS,
 
-		NODEDATA,
-		ELEMENTDATA,
+		// the solution is packed to one buffer while the other is stored
+		SOLUTION0,
+		SOLUTION1,
 
 		SIZE
 	};
@@ -35,6 +36,28 @@ protected:
 struct InitParameters
 { };
 
+/**
+ * Header of one data vector in a solution buffer.
+ * Only changed vectors are copied to the buffer - the others keep the values from previous steps.
+ */
+struct SolutionField
+{
+	enum class Type: int {
+		GATHERED_NODE_DATA,
+		DECOMPOSED_NODE_DATA,
+		ELEMENT_DATA
+	};
+
+	Type type;
+	int data, domain, changed;
+	size_t offset, size;
+
+	bool sameLayout(const SolutionField &other) const
+	{
+		return type == other.type && data == other.data && domain == other.domain && offset == other.offset && size == other.size;
+	}
+};
+
 struct ExecParameters
 {
 	int updatedBuffers;
@@ -56,6 +79,8 @@ public:
 	const Mesh& mesh() const { return _mesh; }
 
 protected:
+	std::vector<double>& solutionField(const SolutionField &field);
+
 	Mesh _mesh;
 	const char *_buffer;
 };
@@ -82,9 +107,14 @@ protected:
 	void setUp() { setExecutor(_executor); };
 
 	void prepareBuffer(AsyncBufferManager::Buffer buffer, size_t size);
+	void solutionFields(std::vector<SolutionField> &fields, std::vector<const double*> &values);
 
 	AsyncExecutor _executor;
 	char *_buffer;
+
+	int _solutionBuffer; // the solution buffer filled by the last step
+	std::vector<SolutionField> _fields; // the layout of solution buffers
+	std::vector<int> _sent; // the solution buffer with the last sent values of a field (-1 if no buffer has actual values)
 };
 
 }
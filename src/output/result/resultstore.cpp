@@ -15,6 +15,7 @@
 #include "visualization/collected/stl.h"
 #include "visualization/separated/insitu.h"
 #include "visualization/separated/vtklegacy.h"
+#include "visualization/separated/vtkxml.h"
 
 
 using namespace espreso;
@@ -81,6 +82,9 @@ ResultStore* ResultStore::createAsynchronizedStore(const Mesh &mesh, const Outpu
 		case OutputConfiguration::FORMAT::STL_SURFACE:
 			executor->addResultStore(new STL(Logging::name, mesh, configuration));
 			break;
+		case OutputConfiguration::FORMAT::VTK_XML_BINARY:
+			executor->addResultStore(new VTKXML(Logging::name, mesh, configuration));
+			break;
 		default:
 			ESINFO(GLOBAL_ERROR) << "ESPRESO internal error: implement the selected output format.";
 		}
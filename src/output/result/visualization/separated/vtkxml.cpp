@@ -0,0 +1,321 @@
+
+#include "vtkxml.h"
+
+#include "../vtkwritter.h"
+
+#include "../../../../basis/containers/point.h"
+#include "../../../../basis/containers/serializededata.h"
+#include "../../../../basis/logging/logging.h"
+#include "../../../../basis/utilities/utils.h"
+
+#include "../../../../config/ecf/environment.h"
+#include "../../../../config/ecf/output.h"
+
+#include "../../../../assembler/step.h"
+
+#include "../../../../mesh/mesh.h"
+#include "../../../../mesh/elements/element.h"
+#include "../../../../mesh/store/nodestore.h"
+#include "../../../../mesh/store/elementstore.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include "zlib.h"
+#endif
+
+using namespace espreso;
+
+double VTKXML::clusterShrinkRatio = 0.95;
+double VTKXML::domainShrinkRatio = 0.9;
+
+// uncompressed size of blocks compressed by zlib (the same as VTK uses)
+static const size_t VTK_BLOCK_SIZE = 32768;
+
+template <typename TType> static const char* vtktype();
+template <> const char* vtktype<float>()         { return "Float32"; }
+template <> const char* vtktype<double>()        { return "Float64"; }
+template <> const char* vtktype<int>()           { return "Int32"; }
+template <> const char* vtktype<long>()          { return "Int64"; }
+template <> const char* vtktype<unsigned char>() { return "UInt8"; }
+
+template <typename TType>
+static VTKXML::DataArray dataarray(const std::string &name, int components, const std::vector<TType> &data)
+{
+	return { vtktype<TType>(), name, components, reinterpret_cast<const char*>(data.data()), data.size() * sizeof(TType) };
+}
+
+VTKXML::VTKXML(const std::string &name, const Mesh &mesh, const OutputConfiguration &configuration)
+: SeparatedVisualization(mesh, configuration), _path(Logging::outputRoot() + "/"), _name(name), _counter(0)
+{
+#ifndef HAVE_ZLIB
+	if (_configuration.compression) {
+		ESINFO(ALWAYS_ON_ROOT) << Info::TextColor::YELLOW << "ESPRESO is built without zlib. VTK XML output is stored uncompressed.";
+	}
+#endif
+}
+
+void VTKXML::updateMesh()
+{
+	_doffset.resize(_mesh.elements->ndomains + 1);
+	_doffset[0] = 0;
+	for (eslocal d = 0; d < _mesh.elements->ndomains; d++) {
+		const DomainInterval &last = _mesh.nodes->dintervals[d].back();
+		_doffset[d + 1] = _doffset[d] + last.DOFOffset + last.end - last.begin;
+	}
+
+	_points.resize(3 * _doffset.back());
+	_connectivity.resize(_mesh.elements->nodes->datatarray().size());
+	_offsets.resize(_mesh.elements->size);
+	_types.resize(_mesh.elements->size);
+	_domains.resize(_mesh.elements->size);
+	_clusters.resize(_mesh.elements->size, environment->MPIrank);
+
+	const auto &coordinates = _mesh.nodes->coordinates->datatarray();
+	const auto &eboundaries = _mesh.elements->nodes->boundarytarray();
+	const auto &enodes = _mesh.elements->nodes->datatarray();
+	const auto &epointers = _mesh.elements->epointers->datatarray();
+
+	#pragma omp parallel for
+	for (eslocal d = 0; d < _mesh.elements->ndomains; d++) {
+		const std::vector<DomainInterval> &intervals = _mesh.nodes->dintervals[d];
+		for (size_t i = 0; i < intervals.size(); ++i) {
+			for (eslocal n = intervals[i].begin, index = _doffset[d] + intervals[i].DOFOffset; n < intervals[i].end; ++n, ++index) {
+				Point p = shrink(coordinates[n], _mesh.nodes->center, _mesh.nodes->dcenter[d], clusterShrinkRatio, domainShrinkRatio);
+				_points[3 * index + 0] = p.x;
+				_points[3 * index + 1] = p.y;
+				_points[3 * index + 2] = p.z;
+			}
+		}
+
+		for (eslocal e = _mesh.elements->elementsDistribution[d]; e < _mesh.elements->elementsDistribution[d + 1]; ++e) {
+			for (eslocal n = eboundaries[e]; n < eboundaries[e + 1]; ++n) {
+				auto it = std::lower_bound(intervals.begin(), intervals.end(), enodes[n], [] (const DomainInterval &interval, eslocal node) { return interval.end <= node; });
+				_connectivity[n] = _doffset[d] + it->DOFOffset + enodes[n] - it->begin;
+			}
+			_offsets[e] = eboundaries[e + 1];
+			_types[e] = VTKWritter::ecode(epointers[e]->code);
+			_domains[e] = _mesh.elements->firstDomain + d;
+		}
+	}
+}
+
+void VTKXML::updateSolution(const Step &step)
+{
+	if (!Visualization::storeStep(_configuration, step)) {
+		return;
+	}
+
+	std::vector<DataArray> pointData, cellData;
+
+	_nodeData.resize(_mesh.nodes->data.size());
+	for (size_t di = 0; di < _mesh.nodes->data.size(); di++) {
+		const NodeData *data = _mesh.nodes->data[di];
+		if (data->names.size() == 0 || data->decomposedData == NULL) {
+			continue;
+		}
+		// ParaView accepts only 3D vectors
+		int dimension = data->dimension, components = dimension == 2 ? 3 : dimension;
+		_nodeData[di].resize(components * _doffset.back());
+
+		#pragma omp parallel for
+		for (eslocal d = 0; d < _mesh.elements->ndomains; d++) {
+			const std::vector<double> &values = (*data->decomposedData)[d];
+			for (size_t i = 0; i < _mesh.nodes->dintervals[d].size(); ++i) {
+				const DomainInterval &interval = _mesh.nodes->dintervals[d][i];
+				for (eslocal n = 0; n < interval.end - interval.begin; ++n) {
+					eslocal index = _doffset[d] + interval.DOFOffset + n;
+					for (int s = 0; s < dimension; ++s) {
+						_nodeData[di][components * index + s] = values[dimension * (interval.DOFOffset + n) + s];
+					}
+					for (int s = dimension; s < components; ++s) {
+						_nodeData[di][components * index + s] = 0;
+					}
+				}
+			}
+		}
+		pointData.push_back(dataarray(data->names.front(), components, _nodeData[di]));
+	}
+
+	_elementData.resize(_mesh.elements->data.size());
+	for (size_t di = 0; di < _mesh.elements->data.size(); di++) {
+		const ElementData *data = _mesh.elements->data[di];
+		if (data->names.size() == 0 || data->data == NULL) {
+			continue;
+		}
+		int dimension = data->dimension, components = dimension == 2 ? 3 : dimension;
+		_elementData[di].resize(components * _mesh.elements->size);
+
+		#pragma omp parallel for
+		for (eslocal e = 0; e < _mesh.elements->size; ++e) {
+			for (int s = 0; s < dimension; ++s) {
+				_elementData[di][components * e + s] = (*data->data)[dimension * e + s];
+			}
+			for (int s = dimension; s < components; ++s) {
+				_elementData[di][components * e + s] = 0;
+			}
+		}
+		cellData.push_back(dataarray(data->names.front(), components, _elementData[di]));
+	}
+	cellData.push_back(dataarray("DOMAINS", 1, _domains));
+	cellData.push_back(dataarray("CLUSTERS", 1, _clusters));
+
+	std::stringstream name;
+	name << _name << "." << std::setw(4) << std::setfill('0') << ++_counter;
+
+	storeVTU(_path + _directory + name.str() + "." + std::to_string(environment->MPIrank) + ".vtu", pointData, cellData);
+	if (environment->MPIrank == 0) {
+		storePVTU(_path + name.str() + ".pvtu", _directory + name.str() + ".%r.vtu", pointData, cellData);
+		_collection << "    <DataSet timestep=\"" << step.currentTime << "\" file=\"" << name.str() << ".pvtu\"/>\n";
+		storePVD();
+	}
+}
+
+void VTKXML::encode(const DataArray &array, std::vector<char> &data)
+{
+#ifdef HAVE_ZLIB
+	if (_configuration.compression) {
+		size_t blocks = (array.bytes + VTK_BLOCK_SIZE - 1) / VTK_BLOCK_SIZE;
+		std::vector<std::vector<char> > compressed(blocks);
+
+		#pragma omp parallel for
+		for (size_t b = 0; b < blocks; b++) {
+			size_t bytes = std::min(VTK_BLOCK_SIZE, array.bytes - b * VTK_BLOCK_SIZE);
+			uLongf size = compressBound(bytes);
+			compressed[b].resize(size);
+			compress2(reinterpret_cast<Bytef*>(compressed[b].data()), &size, reinterpret_cast<const Bytef*>(array.data + b * VTK_BLOCK_SIZE), bytes, Z_DEFAULT_COMPRESSION);
+			compressed[b].resize(size);
+		}
+
+		std::vector<uint64_t> header = { blocks, VTK_BLOCK_SIZE, array.bytes % VTK_BLOCK_SIZE };
+		for (size_t b = 0; b < blocks; b++) {
+			header.push_back(compressed[b].size());
+		}
+		data.insert(data.end(), reinterpret_cast<const char*>(header.data()), reinterpret_cast<const char*>(header.data() + header.size()));
+		for (size_t b = 0; b < blocks; b++) {
+			data.insert(data.end(), compressed[b].begin(), compressed[b].end());
+		}
+		return;
+	}
+#endif
+
+	uint64_t bytes = array.bytes;
+	size_t offset = data.size();
+	data.resize(offset + sizeof(uint64_t) + bytes);
+	memcpy(data.data() + offset, &bytes, sizeof(uint64_t));
+	memcpy(data.data() + offset + sizeof(uint64_t), array.data, bytes);
+}
+
+void VTKXML::storeVTU(const std::string &file, const std::vector<DataArray> &pointData, const std::vector<DataArray> &cellData)
+{
+	std::vector<char> appended;
+	std::stringstream os;
+
+	auto store = [&] (const DataArray &array, const std::string &indent) {
+		os << indent << "<DataArray type=\"" << array.type << "\" Name=\"" << array.name << "\" NumberOfComponents=\"" << array.components;
+		os << "\" format=\"appended\" offset=\"" << appended.size() << "\"/>\n";
+		encode(array, appended);
+	};
+
+	int endianness = 1;
+	os << "<?xml version=\"1.0\"?>\n";
+	os << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << (*reinterpret_cast<char*>(&endianness) ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\"";
+#ifdef HAVE_ZLIB
+	if (_configuration.compression) {
+		os << " compressor=\"vtkZLibDataCompressor\"";
+	}
+#endif
+	os << ">\n";
+	os << "  <UnstructuredGrid>\n";
+	os << "    <Piece NumberOfPoints=\"" << _doffset.back() << "\" NumberOfCells=\"" << _mesh.elements->size << "\">\n";
+
+	os << "      <PointData>\n";
+	for (size_t i = 0; i < pointData.size(); i++) {
+		store(pointData[i], "        ");
+	}
+	os << "      </PointData>\n";
+
+	os << "      <CellData>\n";
+	for (size_t i = 0; i < cellData.size(); i++) {
+		store(cellData[i], "        ");
+	}
+	os << "      </CellData>\n";
+
+	os << "      <Points>\n";
+	store(dataarray("Points", 3, _points), "        ");
+	os << "      </Points>\n";
+
+	os << "      <Cells>\n";
+	store(dataarray("connectivity", 1, _connectivity), "        ");
+	store(dataarray("offsets", 1, _offsets), "        ");
+	store(dataarray("types", 1, _types), "        ");
+	os << "      </Cells>\n";
+
+	os << "    </Piece>\n";
+	os << "  </UnstructuredGrid>\n";
+	os << "  <AppendedData encoding=\"raw\">\n";
+	os << "_";
+
+	std::string header = os.str(), footer = "\n  </AppendedData>\n</VTKFile>\n";
+	std::vector<char> buffer(header.size() + appended.size() + footer.size());
+	memcpy(buffer.data(), header.data(), header.size());
+	memcpy(buffer.data() + header.size(), appended.data(), appended.size());
+	memcpy(buffer.data() + header.size() + appended.size(), footer.data(), footer.size());
+
+	std::ofstream vtu(file, std::ios::binary);
+	vtu.write(buffer.data(), buffer.size());
+}
+
+void VTKXML::storePVTU(const std::string &file, const std::string &piece, const std::vector<DataArray> &pointData, const std::vector<DataArray> &cellData)
+{
+	std::ofstream os(file);
+
+	auto store = [&] (const DataArray &array) {
+		os << "      <PDataArray type=\"" << array.type << "\" Name=\"" << array.name << "\" NumberOfComponents=\"" << array.components << "\"/>\n";
+	};
+
+	os << "<?xml version=\"1.0\"?>\n";
+	os << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\">\n";
+	os << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
+
+	os << "    <PPointData>\n";
+	for (size_t i = 0; i < pointData.size(); i++) {
+		store(pointData[i]);
+	}
+	os << "    </PPointData>\n";
+
+	os << "    <PCellData>\n";
+	for (size_t i = 0; i < cellData.size(); i++) {
+		store(cellData[i]);
+	}
+	os << "    </PCellData>\n";
+
+	os << "    <PPoints>\n";
+	os << "      <PDataArray type=\"" << vtktype<float>() << "\" NumberOfComponents=\"3\"/>\n";
+	os << "    </PPoints>\n";
+
+	for (int r = 0; r < environment->MPIsize; r++) {
+		std::string source = piece;
+		source.replace(source.find("%r"), 2, std::to_string(r));
+		os << "    <Piece Source=\"" << source << "\"/>\n";
+	}
+
+	os << "  </PUnstructuredGrid>\n";
+	os << "</VTKFile>\n";
+}
+
+void VTKXML::storePVD()
+{
+	std::ofstream os(_path + _name + ".pvd");
+
+	os << "<?xml version=\"1.0\"?>\n";
+	os << "<VTKFile type=\"Collection\" version=\"1.0\">\n";
+	os << "  <Collection>\n";
+	os << _collection.str();
+	os << "  </Collection>\n";
+	os << "</VTKFile>\n";
+}
@@ -0,0 +1,64 @@
+
+#ifndef SRC_OUTPUT_RESULT_VISUALIZATION_SEPARATED_VTKXML_H_
+#define SRC_OUTPUT_RESULT_VISUALIZATION_SEPARATED_VTKXML_H_
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "separatedvisualization.h"
+
+namespace espreso {
+
+struct Step;
+class Mesh;
+
+/**
+ * Each MPI process stores its domains (shrunk) to an unstructured grid in VTK XML format (.vtu)
+ * with all data arrays in the raw appended section (optionally compressed by zlib).
+ * The root process stores the parallel index (.pvtu) and the collection of time steps (.pvd).
+ */
+struct VTKXML: public SeparatedVisualization {
+
+	static double clusterShrinkRatio, domainShrinkRatio;
+
+	struct DataArray {
+		std::string type, name;
+		int components;
+		const char *data;
+		size_t bytes;
+	};
+
+	VTKXML(const std::string &name, const Mesh &mesh, const OutputConfiguration &configuration);
+
+	void updateMesh();
+	void updateSolution(const Step &step);
+
+protected:
+	void storeVTU(const std::string &file, const std::vector<DataArray> &pointData, const std::vector<DataArray> &cellData);
+	void storePVTU(const std::string &file, const std::string &piece, const std::vector<DataArray> &pointData, const std::vector<DataArray> &cellData);
+	void storePVD();
+
+	void encode(const DataArray &array, std::vector<char> &data);
+
+	std::string _path;
+	std::string _name;
+
+	// mesh buffers are filled once in 'updateMesh'
+	std::vector<eslocal> _doffset;
+	std::vector<float> _points;
+	std::vector<eslocal> _connectivity, _offsets;
+	std::vector<unsigned char> _types;
+	std::vector<int> _domains, _clusters;
+
+	// solution buffers are reused for each time step
+	std::vector<std::vector<double> > _nodeData, _elementData;
+
+	std::stringstream _collection;
+	int _counter;
+};
+
+}
+
+
+#endif /* SRC_OUTPUT_RESULT_VISUALIZATION_SEPARATED_VTKXML_H_ */
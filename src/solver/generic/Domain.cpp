@@ -62,6 +62,7 @@ Domain::Domain(const FETISolverConfiguration &configuration, Instance *instance_
 		domain_global_index = domain_index_in;
 		USE_HFETI 		 	= USE_HTFETI_in;
 		isOnACC          	= 0;
+		implicitPrec		= false;
 }
 
 void Domain::SetDomain() {
@@ -215,6 +216,33 @@ void Domain::SetDomain() {
 }
 
 
+// Update the domain after values of matrix K are changed (the pattern of K is kept)
+// - constraints and their compression are kept from the previous SetDomain
+void Domain::UpdateDomain() {
+
+	std::stringstream ss;
+	ss << "K matrix refactorization -> rank: " << environment->MPIrank << ", subdomain: " << domain_global_index;
+
+	instance->computeKernel(configuration.regularization, configuration.sc_size, domain_global_index, configuration.method == FETI_METHOD::HYBRID_FETI);
+	Kplus.Refactorization(K, ss.str());
+
+	if (	configuration.conjugate_projector == FETI_CONJ_PROJECTOR::CONJ_R ||
+			configuration.conjugate_projector == FETI_CONJ_PROJECTOR::CONJ_K)
+		instance->computeKernelFromOrigK(configuration.regularization, configuration.sc_size, domain_global_index, configuration.method == FETI_METHOD::HYBRID_FETI);
+
+	// *** Kernel setup
+	if ( configuration.orthogonal_K_kernels ) {
+		Kplus_R.GramSchmidtOrtho();
+		if (Kplus_R2.nnz > 0)
+			Kplus_R2.GramSchmidtOrtho();
+	}
+
+	Kplus_Rb  = Kplus_R;
+	Kplus_Rb2 = Kplus_R2;
+	// *** END - Kernel setup
+}
+
+
 void Domain::multKplusLocal(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out) {
 
     if (configuration.mp_pseudoinverse) {
@@ -268,6 +296,23 @@ void Domain::multKplusLocal(SEQ_VECTOR <double> & x_in_y_out) {
     }
 }
 
+// 'n_rhs' vectors are stored one after another
+void Domain::multKplusLocalBlock(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, eslocal n_rhs) {
+
+	if (!configuration.mp_pseudoinverse && configuration.Ksolver == FETI_KSOLVER::DIRECT_DP) {
+		Kplus.Solve(x_in, y_out, n_rhs);
+		return;
+	}
+
+	size_t size = x_in.size() / n_rhs;
+	SEQ_VECTOR <double> x(size), y(size);
+	for (eslocal v = 0; v < n_rhs; v++) {
+		std::copy(x_in.begin() + v * size, x_in.begin() + (v + 1) * size, x.begin());
+		multKplusLocal(x, y);
+		std::copy(y.begin(), y.end(), y_out.begin() + v * size);
+	}
+}
+
 void Domain::multKplusLocalCore(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out) {
 
 
@@ -416,6 +461,18 @@ void Domain::multKplusLocalCore(SEQ_VECTOR <double> & x_in_y_out) {
 
 
 
+void Domain::multPrecImplicit(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out) {
+
+	// y = K_ss * x - K_sr * inv(K_rr) * K_rs * x
+	Prec.MatVec(x_in, y_out, 'N');
+	if (Prec_K_rs.nnz) {
+		Prec_K_rs.MatVec(x_in, Prec_tmp_r1, 'N');
+		Prec_K_rr.Solve(Prec_tmp_r1, Prec_tmp_r2, 0, 0);
+		Prec_K_sr.MatVec(Prec_tmp_r2, y_out, 'N', 0, 0, 1.0);
+	}
+
+}
+
 // TODO: Obsolete functions - to be removed
 
 
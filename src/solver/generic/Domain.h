@@ -39,14 +39,18 @@ public:
 
 	// Methods of the class
 	void SetDomain();
+	void UpdateDomain();
 
 	void multKplusLocal( SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, eslocal x_in_vector_start_index, eslocal y_out_vector_start_index );
 	void multKplusLocal( SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out );
 	void multKplusLocal( SEQ_VECTOR <double> & x_in_y_out);
+	void multKplusLocalBlock( SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, eslocal n_rhs);
 
 	void multKplusLocalCore( SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out );
 	void multKplusLocalCore( SEQ_VECTOR <double> & x_in_y_out);
 
+	void multPrecImplicit( SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out );
+
     const FETISolverConfiguration &configuration;
 	Instance 		    *instance;
 
@@ -126,6 +130,13 @@ public:
 	SparseMatrix M;
 	SparseMatrix Prec;
 
+	// implicit Dirichlet preconditioner: S = K_ss - K_sr * inv(K_rr) * K_rs, where K_ss is stored in Prec
+	bool implicitPrec;
+	SparseSolverCPU Prec_K_rr;
+	SparseMatrix Prec_K_rs;
+	SparseMatrix Prec_K_sr; // stored with the negative sign
+	SEQ_VECTOR <double> Prec_tmp_r1, Prec_tmp_r2;
+
 	SEQ_VECTOR <eslocal>	map_vector_e0;
 	SEQ_VECTOR <eslocal>	map_vector;
 
@@ -6,8 +6,11 @@
  */
 //#include <Driver/DissectionSolver.hpp>
 #include "../../basis/utilities/utils.h"
+#include "../../basis/logging/logging.h"
 #include "FETISolver.h"
 
+#include <numeric>
+
 //#include <Eigen/Dense>
 //using Eigen::MatrixXd;
 
@@ -17,13 +20,17 @@ FETISolver::FETISolver(Instance *instance, const FETISolverConfiguration &config
 : instance(instance),
   timeEvalMain("ESPRESO Solver Overal Timing"),
   cluster(NULL),
-  solver(NULL)
+  solver(NULL),
+  coldIterations(0),
+  operatorStored(false)
 {
 	this->configuration = configuration;
 }
 
 FETISolver::~FETISolver() {
 
+	clearOperators();
+
 	if (cluster != NULL) {
 		delete cluster;
 	}
@@ -37,6 +44,8 @@ FETISolver::~FETISolver() {
 // make full initialization of solver
 void FETISolver::init()
 {
+	clearOperators();
+
 	if (cluster != NULL) {
 		delete cluster;
 	}
@@ -60,7 +69,23 @@ void FETISolver::update(Matrices matrices)
 {
 	// TODO update appropriate solver objects and stop steeling matrices! :)
 
-	if (matrices & (Matrices::K | Matrices::N)) {
+	if (matrices & (Matrices::K | Matrices::N | Matrices::B0 | Matrices::B1)) {
+		recycled.operatorChanged = true;
+	}
+
+	if (matrices & (Matrices::B0 | Matrices::B1)) {
+		// cached operators have invalid gluing
+		clearOperators();
+	}
+
+	if ((matrices & (Matrices::K | Matrices::N)) && operatorStored) {
+		// the current operator stays in the cache, hence a new one has to be created
+		operatorStored = false;
+		cluster = NULL;
+		solver = NULL;
+	}
+
+	if ((matrices & (Matrices::K | Matrices::N)) && !isNumericalUpdateSufficient(matrices)) {
 		// factorization and preconditioners and HFETI preprocessing
 
 		delete cluster;
@@ -74,6 +99,13 @@ void FETISolver::update(Matrices matrices)
 
 	} else {
 
+		if (matrices & Matrices::K) {
+			// only values of K are changed -> keep G1, GGt and symbolic factorization
+			setup_RefactorizationOfStiffnessMatrices();
+			setup_Preconditioner();
+			setup_LocalSchurComplement();
+		}
+
 		if (matrices & Matrices::B1) { // N is kernel of matrix K
 			// updateGGt();
 			setup_CreateG_GGt_CompressG();
@@ -115,6 +147,99 @@ void FETISolver::update(Matrices matrices)
 	//	init(instance->neighbours);
 }
 
+// Check whether the solver can be updated without re-initialization.
+// It is possible only if the kernels (and hence G1 and GGt) do not depend on values of K.
+bool FETISolver::isNumericalUpdateSufficient(Matrices matrices) const
+{
+	if (!configuration.reuse_symbolic_factorization || cluster == NULL || solver == NULL) {
+		return false;
+	}
+	if (matrices & (Matrices::N | Matrices::B1 | Matrices::B0)) {
+		return false;
+	}
+	// HFETI preprocessing (G0, F0, Salfa) is not able to be recomputed in place
+	if (configuration.method != FETI_METHOD::TOTAL_FETI) {
+		return false;
+	}
+	if (configuration.regularization != FETI_REGULARIZATION::ANALYTIC) {
+		return false;
+	}
+	if (configuration.conjugate_projector != FETI_CONJ_PROJECTOR::NONE) {
+		return false;
+	}
+	return true;
+}
+
+void FETISolver::storeOperator(double key)
+{
+	if (configuration.cached_operators == 0 || cluster == NULL) {
+		return;
+	}
+	if (operatorStored) {
+		cachedOperators.front().key = key;
+		return;
+	}
+
+	cachedOperators.push_front(CachedOperator{ key, cluster, solver, instance->K, instance->N1, instance->N2, instance->origKN1, instance->origKN2, instance->RegMat });
+	operatorStored = true;
+
+	// the least recently used operators are removed
+	while (cachedOperators.size() > configuration.cached_operators + 1) {
+		delete cachedOperators.back().cluster;
+		delete cachedOperators.back().solver;
+		cachedOperators.pop_back();
+	}
+}
+
+bool FETISolver::restoreOperator(double key)
+{
+	// keys are usually computed values (e.g. time steps)
+	auto equal = [&] (const CachedOperator &op) { return std::fabs(op.key - key) <= 1e-8 * std::fabs(key); };
+
+	if (operatorStored && equal(cachedOperators.front())) {
+		return true;
+	}
+	auto it = std::find_if(cachedOperators.begin(), cachedOperators.end(), equal);
+	if (it == cachedOperators.end()) {
+		return false;
+	}
+
+	if (!operatorStored) {
+		delete cluster;
+		delete solver;
+	}
+	cluster = it->cluster;
+	solver = it->solver;
+
+	// domains of the cluster refer to matrices in the instance
+	#pragma omp parallel for
+	for (size_t d = 0; d < instance->domains; d++) {
+		instance->K[d] = it->K[d];
+		instance->N1[d] = it->N1[d];
+		instance->N2[d] = it->N2[d];
+		instance->origKN1[d] = it->origKN1[d];
+		instance->origKN2[d] = it->origKN2[d];
+		instance->RegMat[d] = it->RegMat[d];
+	}
+
+	cachedOperators.splice(cachedOperators.begin(), cachedOperators, it);
+	operatorStored = true;
+	recycled.operatorChanged = true;
+	return true;
+}
+
+void FETISolver::clearOperators()
+{
+	for (auto it = cachedOperators.begin(); it != cachedOperators.end(); ++it) {
+		if (it->cluster != cluster) {
+			delete it->cluster;
+			delete it->solver;
+		}
+	}
+	cachedOperators.clear();
+	operatorStored = false;
+}
+
 // run solver and store primal and dual solution
 void FETISolver::solve()
 {
@@ -126,6 +251,10 @@ void FETISolver::solve()
 		ESINFO(ERROR) << "Invalid Linear Solver configuration: Only GMRES and BICGSTAB can solve unsymmetric system.";
 	}
 
+	if (configuration.store_instance) {
+		instance->storeSnapshot(Logging::outputRoot() + "/instance", configuration);
+	}
+
 	Solve(instance->f, instance->primalSolution, instance->dualSolution);
 
 	double mmax = std::numeric_limits<double>::min(), gmax = std::numeric_limits<double>::min();
@@ -146,6 +275,10 @@ void FETISolver::solve()
 			instance->primalSolution[d][i] = std::trunc(dplaces * instance->primalSolution[d][i]) / dplaces;
 		}
 	}
+
+	if (configuration.store_instance) {
+		instance->storeSnapshotSolution(Logging::outputRoot() + "/instance");
+	}
 }
 
 
@@ -568,6 +701,22 @@ void FETISolver::setup_FactorizationOfStiffnessMatrices() {
 }
 
 
+void FETISolver::setup_RefactorizationOfStiffnessMatrices() {
+// K Factorization with the symbolic factorization from the previous one
+		 TimeEvent timeSolKproc(string("Solver - K refactorization")); timeSolKproc.start();
+		 ESINFO(PROGRESS3) << "Refactorize K";
+
+		#pragma omp parallel for
+		for (size_t d = 0; d < cluster->domains.size(); d++) {
+			cluster->domains[d]->UpdateDomain();
+		}
+
+		 ESLOG(MEMORY) << "After K refactorization process " << environment->MPIrank << " uses " << Measure::processMemory() << " MB";
+		 ESLOG(MEMORY) << "Total used RAM " << Measure::usedRAM() << "/" << Measure::availableRAM() << " [MB]";
+		 timeSolKproc.endWithBarrier();
+		 timeEvalMain.addEvent(timeSolKproc);
+}
+
 void FETISolver::setup_SetDirichletBoundaryConditions() {
 // Set Dirichlet Boundary Condition
 
@@ -734,6 +883,22 @@ void FETISolver::init(const std::vector<int> &neighbours)
 
 }
 
+void FETISolver::solve(std::vector<std::vector<std::vector<double> > > &f, std::vector<std::vector<std::vector<double> > > &primalSolutions)
+{
+	if (std::any_of(instance->K.begin(), instance->K.end(), [] (const SparseMatrix &K) { return K.mtype == MatrixType::REAL_UNSYMMETRIC; })) {
+		ESINFO(ERROR) << "Invalid Linear Solver configuration: Multiple right-hand sides can be solved only for symmetric system.";
+	}
+
+	TimeEvent timeSolCG(string("Solver - CG Solver runtime (multiple RHS)"));
+	timeSolCG.start();
+
+	std::vector<std::vector<std::vector<double> > > dualSolutions;
+	solver->Solve_MultiRHS(*cluster, f, primalSolutions, dualSolutions);
+
+	timeSolCG.endWithBarrier();
+	timeEvalMain.addEvent(timeSolCG);
+}
+
 void FETISolver::Solve( std::vector < std::vector < double > >  & f_vec,
 		                  std::vector < std::vector < double > >  & prim_solution)
 {
@@ -749,13 +914,72 @@ void FETISolver::Solve( std::vector < std::vector < double > >  & f_vec,
 	 	 TimeEvent timeSolCG(string("Solver - CG Solver runtime"));
 	 	 timeSolCG.start();
 
+	// solvers with the conjugate projector do not support the initial guess
+	bool warmStart = configuration.warm_start && configuration.conjugate_projector == FETI_CONJ_PROJECTOR::NONE;
+	bool guess = warmStart && setInitialGuess();
+
+	if (configuration.recycling_size && configuration.iterative_solver == FETI_ITERATIVE_SOLVER::PCG && configuration.conjugate_projector == FETI_CONJ_PROJECTOR::NONE) {
+		solver->recycled = &recycled;
+	}
+
 	 solver->Solve    ( *cluster, f_vec, prim_solution, dual_solution );
 
+	if (warmStart) {
+		if (guess) {
+			ESINFO(CONVERGENCE) << "Warm start of the dual solver: " << solver->iterations << " iterations, "
+					<< coldIterations - solver->iterations << " iterations saved with respect to the last cold start.";
+		} else {
+			coldIterations = solver->iterations;
+		}
+		storeDualSolution();
+	}
+
 	 	 timeSolCG.endWithBarrier();
 	 	 timeEvalMain.addEvent(timeSolCG);
 
 }
 
+// The previous solution is mapped by global IDs of lambdas since the solver (and the layout of lambdas) can be re-created.
+bool FETISolver::setInitialGuess()
+{
+	const SEQ_VECTOR <eslocal> &lambdas = cluster->my_lamdas_indices;
+
+	// projection of the guess is collective -> all processes have to use it
+	int guess = lastLambdaIDs.size() || lambdas.empty(), allguess;
+	MPI_Allreduce(&guess, &allguess, 1, MPI_INT, MPI_MIN, environment->MPICommunicator);
+
+	solver->dual_initial_guess.clear();
+	if (!allguess) {
+		return false;
+	}
+
+	solver->dual_initial_guess.resize(lambdas.size(), 0);
+	#pragma omp parallel for
+	for (size_t i = 0; i < lambdas.size(); i++) {
+		auto it = std::lower_bound(lastLambdaIDs.begin(), lastLambdaIDs.end(), lambdas[i]);
+		if (it != lastLambdaIDs.end() && *it == lambdas[i]) {
+			solver->dual_initial_guess[i] = lastLambda[it - lastLambdaIDs.begin()];
+		}
+	}
+	return true;
+}
+
+void FETISolver::storeDualSolution()
+{
+	const SEQ_VECTOR <eslocal> &lambdas = cluster->my_lamdas_indices;
+
+	std::vector<eslocal> permutation(lambdas.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(), [&] (eslocal i, eslocal j) { return lambdas[i] < lambdas[j]; });
+
+	lastLambdaIDs.resize(lambdas.size());
+	lastLambda.resize(lambdas.size());
+	for (size_t i = 0; i < permutation.size(); i++) {
+		lastLambdaIDs[i] = lambdas[permutation[i]];
+		lastLambda[i] = solver->dual_soultion_compressed_parallel[permutation[i]];
+	}
+}
+
 void FETISolver::Postprocessing( ) {
 
 }
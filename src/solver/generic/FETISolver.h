@@ -14,6 +14,8 @@
 
 #include "../../assembler/instance.h"
 
+#include <list>
+
 
 namespace espreso {
 
@@ -28,12 +30,19 @@ public:
 
 	void update(Matrices matrices);
 	void solve();
+	// solve systems with the same matrices and multiple right-hand sides (e.g. load cases)
+	void solve(std::vector<std::vector<std::vector<double> > > &f, std::vector<std::vector<std::vector<double> > > &primalSolutions);
 
 	bool glueDomainsByLagrangeMultipliers() const { return true; }
 	bool applyB1Scaling() const { return configuration.scaling; }
 	bool applyB1LagrangeRedundancy() const { return configuration.redundant_lagrange; }
 
 	double& precision() { return configuration.precision; }
+	// the number of iterations of the last solve
+	eslocal iterations() const { return solver != NULL ? solver->iterations : 0; }
+
+	void storeOperator(double key);
+	bool restoreOperator(double key);
 
 	virtual ~FETISolver();
 
@@ -69,10 +78,38 @@ private:
 	void setup_LocalSchurComplement();
 	void setup_Preconditioner();
 	void setup_FactorizationOfStiffnessMatrices();
+	void setup_RefactorizationOfStiffnessMatrices();
 	void setup_SetDirichletBoundaryConditions();
 
 	void setup_CreateG_GGt_CompressG();
 	void setup_InitClusterAndSolver();
+
+	bool isNumericalUpdateSufficient(Matrices matrices) const;
+
+	bool setInitialGuess();
+	void storeDualSolution();
+
+	// the dual solution of the last solve (sorted by global IDs of lambdas) used by the warm start
+	std::vector<eslocal> lastLambdaIDs;
+	std::vector<double> lastLambda;
+	eslocal coldIterations;
+
+	// search directions recycled by the next solve
+	RecycledDirections recycled;
+
+	// factorized operator together with matrices referenced by its domains
+	struct CachedOperator {
+		double key;
+		SuperCluster *cluster;
+		IterSolver *solver;
+		std::vector<SparseMatrix> K, N1, N2, origKN1, origKN2, RegMat;
+	};
+
+	void clearOperators();
+
+	// the most recently used operator is the first; if 'operatorStored' is set, it is the current one
+	std::list<CachedOperator> cachedOperators;
+	bool operatorStored;
 };
 
 }
@@ -1171,6 +1171,25 @@ void SparseMatrix::DenseMatVec(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> &
 }
 
 
+// Y = A * X, where X and Y contain 'n_vectors' vectors stored one after another (column major)
+void SparseMatrix::DenseMatMultiVec(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, eslocal n_vectors) {
+
+	if (type == 'G' && !USE_FLOAT) {
+		cblas_dgemm
+			(CblasColMajor, CblasNoTrans, CblasNoTrans,
+			rows, n_vectors, cols,
+			1.0, &dense_values[0], rows,
+			&x_in[0], cols,
+			0.0, &y_out[0], rows);
+	} else {
+		// packed symmetric and float matrices have no matrix-matrix kernel
+		for (eslocal v = 0; v < n_vectors; v++) {
+			DenseMatVec(x_in, y_out, 'N', v * cols, v * rows);
+		}
+	}
+}
+
+
 void SparseMatrix::DenseMatMat(SparseMatrix & A_in, char trans_A, SparseMatrix & B_in, char trans_B) {
 
 
@@ -126,6 +126,7 @@ public:
 	void DenseMatVec(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, char T_for_transpose_N_for_not_transpose, eslocal x_in_vector_start_index, eslocal y_out_vector_start_index, double beta);
 	void DenseMatVec(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, char T_for_transpose_N_for_not_transpose, eslocal x_in_vector_start_index, eslocal y_out_vector_start_index, double beta, double alpha);
 
+	void DenseMatMultiVec(SEQ_VECTOR <double> & x_in, SEQ_VECTOR <double> & y_out, eslocal n_vectors);
 	void DenseMatMat(SparseMatrix & A_in, char trans_A, SparseMatrix & B_in, char trans_B);
 
 
@@ -755,8 +755,14 @@ void ClusterBase::multKplusGlobal_l(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in) {
 	// Kplus_x
 	mkl_set_num_threads(1);
 	if (Measure::report(CLUSTER)) { loop_2_1_time.start(); }
-	#pragma omp parallel for
-	for (size_t d = 0; d < domains.size(); d++)
+
+	SEQ_VECTOR <eslocal> kerindices (domains.size() + 1, 0);
+	for (size_t k = 1; k < kerindices.size(); k++) {
+		kerindices[k] = kerindices[k-1] + domains[k-1].Kplus_R.cols;
+	}
+
+	// domains differ in factor sizes -> the most expensive are solved first
+	kplus_scheduler.run(domains.size(), [&] (size_t d) { return domains[d].K.nnz; }, [&] (size_t d)
 	{
 		eslocal domain_size = domains[d].domain_prim_size;
 
@@ -771,12 +777,6 @@ void ClusterBase::multKplusGlobal_l(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in) {
 
 		domains[d].multKplusLocal(tm1[d] , tm2[d]);
 
-		SEQ_VECTOR <eslocal> kerindices (domains.size() + 1, 0);
-		kerindices[0] = 0;
-		for (size_t k = 1; k < kerindices.size(); k++) {
-			kerindices[k] = kerindices[k-1] + domains[k-1].Kplus_R.cols;
-		}
-
 		eslocal e0_start	= kerindices[d];
 		//eslocal e0_start	=  d	* domains[d].Kplus_R.cols;
 
@@ -786,7 +786,7 @@ void ClusterBase::multKplusGlobal_l(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in) {
 			x_in[d][i] = tm2[d][i] + tm3[d][i];
 
 		//ESINFO(PROGRESS3) << Info::plain() << ".";
-	}
+	}, Measure::report(CLUSTER) ? &cluster_time : NULL);
 	//ESINFO(PROGRESS3);
 	if (Measure::report(CLUSTER)) { loop_2_1_time.end(); }
 
@@ -24,6 +24,7 @@ using std::make_pair;
 #include "../generic/SparseMatrix.h"
 #include "../generic/Domain.h"
 #include "densesolvers.h"
+#include "domainscheduler.h"
 
 #include "../../basis/logging/timeeval.h"
 #include "../generic/utils.h"
@@ -208,6 +209,8 @@ using std::make_pair;
 
         TimeEval cluster_time;
 
+        DomainScheduler kplus_scheduler;
+
         // Functions of the class
 
         void InitClusterPC   ( eslocal * subdomains_global_indices, eslocal number_of_subdomains );
@@ -0,0 +1,362 @@
+
+#include "coarseproblem.h"
+
+#include "../../basis/logging/logging.h"
+#include "../../basis/utilities/communication.h"
+#include "../../config/ecf/environment.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+using namespace espreso;
+
+MultilevelCoarseProblem::MultilevelCoarseProblem()
+: _leader(false), _node(MPI_COMM_NULL), _leaders(MPI_COMM_NULL),
+  _interfaceSize(0), _interfaceOffset(0)
+{
+
+}
+
+MultilevelCoarseProblem::~MultilevelCoarseProblem()
+{
+	clear();
+}
+
+void MultilevelCoarseProblem::clear()
+{
+	int finalized;
+	MPI_Finalized(&finalized);
+	if (finalized) {
+		return;
+	}
+
+	if (_node != MPI_COMM_NULL) {
+		MPI_Comm_free(&_node);
+	}
+	if (_leaders != MPI_COMM_NULL) {
+		MPI_Comm_free(&_leaders);
+	}
+	_leader = false;
+	_nodeCounts.clear();
+	_nodeDispls.clear();
+	_interior.clear();
+	_interface.clear();
+	_interfaceCounts.clear();
+	_interfaceDispls.clear();
+	_interfaceSize = _interfaceOffset = 0;
+}
+
+void MultilevelCoarseProblem::fillMatrix(SparseMatrix &A, Rows &rows, int cols, MatrixType mtype)
+{
+	bool symmetric = mtype != MatrixType::REAL_UNSYMMETRIC;
+
+	A.Clear();
+	A.rows = rows.size();
+	A.cols = cols;
+	A.type = symmetric ? 'S' : 'G';
+	A.mtype = mtype;
+	A.CSR_I_row_indices.push_back(1);
+	for (size_t r = 0; r < rows.size(); r++) {
+		std::sort(rows[r].begin(), rows[r].end());
+		for (size_t i = 0; i < rows[r].size(); i++) {
+			if (symmetric && rows[r][i].first < (int)r) {
+				continue;
+			}
+			if (A.CSR_I_row_indices.back() - 1 < (eslocal)A.CSR_J_col_indices.size() && A.CSR_J_col_indices.back() == rows[r][i].first + 1) {
+				A.CSR_V_values.back() += rows[r][i].second;
+			} else {
+				A.CSR_J_col_indices.push_back(rows[r][i].first + 1);
+				A.CSR_V_values.push_back(rows[r][i].second);
+			}
+		}
+		A.CSR_I_row_indices.push_back(A.CSR_J_col_indices.size() + 1);
+	}
+	A.nnz = A.CSR_V_values.size();
+}
+
+bool MultilevelCoarseProblem::init(SparseMatrix &rows, int offset, int size, MatrixType mtype)
+{
+	clear();
+
+	MPIGroup &node = MPITools::withinNodes();
+	MPI_Comm_dup(node.communicator, &_node);
+	_leader = node.rank == 0;
+	MPI_Comm_split(environment->MPICommunicator, _leader ? 0 : MPI_UNDEFINED, environment->MPIrank, &_leaders);
+
+	// gather rows of the node to the leader
+	int local = rows.rows;
+	std::vector<int> rLength(local), rColumns;
+	std::vector<double> rValues;
+	for (int r = 0; r < local; r++) {
+		rLength[r] = rows.CSR_I_row_indices[r + 1] - rows.CSR_I_row_indices[r];
+		for (eslocal i = rows.CSR_I_row_indices[r] - 1; i < rows.CSR_I_row_indices[r + 1] - 1; i++) {
+			rColumns.push_back(rows.CSR_J_col_indices[i] - 1);
+			rValues.push_back(rows.CSR_V_values[i]);
+		}
+	}
+
+	int nnz = rColumns.size();
+	std::vector<int> nodeOffsets(node.size), nnzCounts(node.size), nnzDispls(node.size);
+	_nodeCounts.resize(node.size);
+	_nodeDispls.resize(node.size);
+	MPI_Gather(&local, 1, MPI_INT, _nodeCounts.data(), 1, MPI_INT, 0, _node);
+	MPI_Gather(&offset, 1, MPI_INT, nodeOffsets.data(), 1, MPI_INT, 0, _node);
+	MPI_Gather(&nnz, 1, MPI_INT, nnzCounts.data(), 1, MPI_INT, 0, _node);
+	for (int r = 1; r < node.size; r++) {
+		_nodeDispls[r] = _nodeDispls[r - 1] + _nodeCounts[r - 1];
+		nnzDispls[r] = nnzDispls[r - 1] + nnzCounts[r - 1];
+	}
+
+	int nodeRows = _leader ? _nodeDispls.back() + _nodeCounts.back() : 0;
+	int nodeNnz = _leader ? nnzDispls.back() + nnzCounts.back() : 0;
+	std::vector<int> length(nodeRows), columns(nodeNnz);
+	std::vector<double> values(nodeNnz);
+	MPI_Gatherv(rLength.data(), local, MPI_INT, length.data(), _nodeCounts.data(), _nodeDispls.data(), MPI_INT, 0, _node);
+	MPI_Gatherv(rColumns.data(), nnz, MPI_INT, columns.data(), nnzCounts.data(), nnzDispls.data(), MPI_INT, 0, _node);
+	MPI_Gatherv(rValues.data(), nnz, MPI_DOUBLE, values.data(), nnzCounts.data(), nnzDispls.data(), MPI_DOUBLE, 0, _node);
+
+	int fits = 1;
+	if (_leader) {
+		// position of a global row within the node (-1 for rows of other nodes)
+		auto position = [&] (int row) {
+			for (int r = 0; r < node.size; r++) {
+				if (nodeOffsets[r] <= row && row < nodeOffsets[r] + _nodeCounts[r]) {
+					return _nodeDispls[r] + row - nodeOffsets[r];
+				}
+			}
+			return -1;
+		};
+
+		std::vector<int> rowBegin(nodeRows + 1, 0), columnPosition(nodeNnz);
+		std::partial_sum(length.begin(), length.end(), rowBegin.begin() + 1);
+
+		std::vector<int> index(nodeRows, -1); // index to interior (>= 0) or interface (< -1) rows
+		for (int r = 0; r < nodeRows; r++) {
+			bool isInterface = false;
+			for (int i = rowBegin[r]; i < rowBegin[r + 1]; i++) {
+				columnPosition[i] = position(columns[i]);
+				isInterface |= columnPosition[i] == -1;
+			}
+			if (isInterface) {
+				index[r] = -2 - (int)_interface.size();
+				_interface.push_back(r);
+			} else {
+				index[r] = _interior.size();
+				_interior.push_back(r);
+			}
+		}
+
+		// numbering of interface rows of all nodes
+		int nB = _interface.size(), nI = _interior.size();
+		int leaders;
+		MPI_Comm_size(_leaders, &leaders);
+		_interfaceCounts.resize(leaders);
+		_interfaceDispls.resize(leaders);
+		MPI_Allgather(&nB, 1, MPI_INT, _interfaceCounts.data(), 1, MPI_INT, _leaders);
+		for (int l = 1; l < leaders; l++) {
+			_interfaceDispls[l] = _interfaceDispls[l - 1] + _interfaceCounts[l - 1];
+		}
+		int leader;
+		MPI_Comm_rank(_leaders, &leader);
+		_interfaceOffset = _interfaceDispls[leader];
+		_interfaceSize = _interfaceDispls.back() + _interfaceCounts.back();
+
+		// all leaders get the same decision
+		size_t interiorDense = (size_t)nI * nB, maxInteriorDense, interfaceDense = 0;
+		MPI_Allreduce(&interiorDense, &maxInteriorDense, 1, MPI_UNSIGNED_LONG, MPI_MAX, _leaders);
+		for (int l = 0; l < leaders; l++) {
+			interfaceDense += (size_t)_interfaceCounts[l] * _interfaceCounts[l];
+		}
+		fits = maxInteriorDense <= DENSE_LIMIT && interfaceDense <= DENSE_LIMIT;
+
+		if (fits) {
+			std::vector<int> myInterface(nB), allInterface(_interfaceSize);
+			for (int i = 0; i < nB; i++) {
+				int r = std::upper_bound(_nodeDispls.begin(), _nodeDispls.end(), _interface[i]) - _nodeDispls.begin() - 1;
+				myInterface[i] = nodeOffsets[r] + _interface[i] - _nodeDispls[r];
+			}
+			MPI_Allgatherv(myInterface.data(), nB, MPI_INT, allInterface.data(), _interfaceCounts.data(), _interfaceDispls.data(), MPI_INT, _leaders);
+			std::vector<std::pair<int, int> > interfaceIndex(_interfaceSize);
+			for (int i = 0; i < _interfaceSize; i++) {
+				interfaceIndex[i] = std::make_pair(allInterface[i], i);
+			}
+			std::sort(interfaceIndex.begin(), interfaceIndex.end());
+
+			Rows II(nI), IB(nI), BI(nB), S(nB);
+			for (int i = 0; i < nI; i++) {
+				int r = _interior[i];
+				for (int c = rowBegin[r]; c < rowBegin[r + 1]; c++) {
+					int col = index[columnPosition[c]];
+					if (col >= 0) {
+						II[i].push_back(std::make_pair(col, values[c]));
+					} else {
+						IB[i].push_back(std::make_pair(-2 - col, values[c]));
+					}
+				}
+			}
+			for (int i = 0; i < nB; i++) {
+				int r = _interface[i];
+				for (int c = rowBegin[r]; c < rowBegin[r + 1]; c++) {
+					if (columnPosition[c] == -1) {
+						auto it = std::lower_bound(interfaceIndex.begin(), interfaceIndex.end(), std::make_pair(columns[c], 0));
+						if (it == interfaceIndex.end() || it->first != columns[c]) {
+							ESINFO(ERROR) << "ESPRESO internal error: GGt has not symmetric pattern across nodes.";
+						}
+						S[i].push_back(std::make_pair(it->second, values[c]));
+						continue;
+					}
+					int col = index[columnPosition[c]];
+					if (col >= 0) {
+						BI[i].push_back(std::make_pair(col, values[c]));
+					} else {
+						S[i].push_back(std::make_pair(_interfaceOffset - 2 - col, values[c]));
+					}
+				}
+			}
+
+			fillMatrix(_A_IB, IB, nB, MatrixType::REAL_UNSYMMETRIC);
+			fillMatrix(_A_BI, BI, nI, MatrixType::REAL_UNSYMMETRIC);
+
+			std::stringstream ss;
+			ss << "Create node-level GGt -> rank: " << environment->MPIrank;
+			if (nI) {
+				SparseMatrix A_II;
+				fillMatrix(A_II, II, nI, mtype);
+				_interiorSolver.ImportMatrix(A_II);
+				_interiorSolver.SetThreaded();
+				_interiorSolver.Factorization(ss.str());
+			}
+
+			// S_BB = A_BB - A_BI * inv(A_II) * A_IB
+			if (nI && nB && _A_BI.nnz) {
+				std::vector<double> AIB(nI * nB, 0), X(nI * nB), C(nB * nB);
+				for (int i = 0; i < nI; i++) {
+					for (size_t c = 0; c < IB[i].size(); c++) {
+						AIB[IB[i][c].first * nI + i] += IB[i][c].second;
+					}
+				}
+				_interiorSolver.Solve(AIB, X, nB);
+				for (int c = 0; c < nB; c++) {
+					_A_BI.MatVec(X, C, 'N', c * nI, c * nB);
+				}
+				for (int i = 0; i < nB; i++) {
+					for (int c = 0; c < nB; c++) {
+						S[i].push_back(std::make_pair(_interfaceOffset + c, -C[c * nB + i]));
+					}
+				}
+			}
+
+			// the global coarse problem is assembled from rows of all leaders
+			std::vector<int> sLength(nB), sColumns;
+			std::vector<double> sValues;
+			for (int i = 0; i < nB; i++) {
+				sLength[i] = S[i].size();
+				for (size_t c = 0; c < S[i].size(); c++) {
+					sColumns.push_back(S[i][c].first);
+					sValues.push_back(S[i][c].second);
+				}
+			}
+			int sNnz = sColumns.size();
+			std::vector<int> sNnzCounts(leaders), sNnzDispls(leaders);
+			MPI_Allgather(&sNnz, 1, MPI_INT, sNnzCounts.data(), 1, MPI_INT, _leaders);
+			for (int l = 1; l < leaders; l++) {
+				sNnzDispls[l] = sNnzDispls[l - 1] + sNnzCounts[l - 1];
+			}
+			std::vector<int> gLength(_interfaceSize), gColumns(sNnzDispls.back() + sNnzCounts.back());
+			std::vector<double> gValues(gColumns.size());
+			MPI_Allgatherv(sLength.data(), nB, MPI_INT, gLength.data(), _interfaceCounts.data(), _interfaceDispls.data(), MPI_INT, _leaders);
+			MPI_Allgatherv(sColumns.data(), sNnz, MPI_INT, gColumns.data(), sNnzCounts.data(), sNnzDispls.data(), MPI_INT, _leaders);
+			MPI_Allgatherv(sValues.data(), sNnz, MPI_DOUBLE, gValues.data(), sNnzCounts.data(), sNnzDispls.data(), MPI_DOUBLE, _leaders);
+
+			if (_interfaceSize) {
+				Rows G(_interfaceSize);
+				for (int r = 0, c = 0; r < _interfaceSize; r++) {
+					for (int i = 0; i < gLength[r]; i++, c++) {
+						G[r].push_back(std::make_pair(gColumns[c], gValues[c]));
+					}
+				}
+				SparseMatrix A_S;
+				fillMatrix(A_S, G, _interfaceSize, mtype);
+				_interfaceSolver.ImportMatrix(A_S);
+				_interfaceSolver.SetThreaded();
+				ss << " (interface)";
+				_interfaceSolver.Factorization(ss.str());
+			}
+
+			_x.resize(nodeRows);
+			_y.resize(nodeRows);
+			_xI.resize(nI);
+			_tI.resize(nI);
+			_rB.resize(nB);
+			_yB.resize(nB);
+			_r.resize(_interfaceSize);
+		}
+	}
+
+	MPI_Bcast(&fits, 1, MPI_INT, 0, _node);
+	if (!fits) {
+		ESINFO(ALWAYS_ON_ROOT) << Info::TextColor::YELLOW << "Three-level coarse problem has too big dense parts, the explicit inverse of GGt is used.";
+		clear();
+		return false;
+	}
+
+	MPI_Bcast(&_interfaceSize, 1, MPI_INT, 0, _node);
+	ESINFO(DETAILS) << "Three-level coarse problem: global size " << size << ", interface size " << _interfaceSize;
+	return true;
+}
+
+void MultilevelCoarseProblem::solve(const std::vector<double> &x, std::vector<double> &y)
+{
+	int local = x.size();
+	MPI_Gatherv(const_cast<double*>(x.data()), local, MPI_DOUBLE, _x.data(), _nodeCounts.data(), _nodeDispls.data(), MPI_DOUBLE, 0, _node);
+
+	if (_leader) {
+		size_t nI = _interior.size(), nB = _interface.size();
+		for (size_t i = 0; i < nI; i++) {
+			_xI[i] = _x[_interior[i]];
+		}
+
+		if (_interfaceSize) {
+			// r_B = x_B - A_BI * inv(A_II) * x_I
+			for (size_t i = 0; i < nB; i++) {
+				_rB[i] = _x[_interface[i]];
+			}
+			if (nI && nB && _A_BI.nnz) {
+				_interiorSolver.Solve(_xI, _tI, 1);
+				std::vector<double> tB(nB);
+				_A_BI.MatVec(_tI, tB, 'N');
+				for (size_t i = 0; i < nB; i++) {
+					_rB[i] -= tB[i];
+				}
+			}
+
+			MPI_Allgatherv(_rB.data(), nB, MPI_DOUBLE, _r.data(), _interfaceCounts.data(), _interfaceDispls.data(), MPI_DOUBLE, _leaders);
+			_interfaceSolver.Solve(_r);
+
+			for (size_t i = 0; i < nB; i++) {
+				_yB[i] = _r[_interfaceOffset + i];
+				_y[_interface[i]] = _yB[i];
+			}
+
+			// x_I = x_I - A_IB * y_B
+			if (nI && nB && _A_IB.nnz) {
+				std::vector<double> tI(nI);
+				_A_IB.MatVec(_yB, tI, 'N');
+				for (size_t i = 0; i < nI; i++) {
+					_xI[i] -= tI[i];
+				}
+			}
+		}
+
+		if (nI) {
+			_interiorSolver.Solve(_xI, _tI, 1);
+			for (size_t i = 0; i < nI; i++) {
+				_y[_interior[i]] = _tI[i];
+			}
+		}
+	}
+
+	y.resize(local);
+	MPI_Scatterv(_y.data(), _nodeCounts.data(), _nodeDispls.data(), MPI_DOUBLE, y.data(), local, MPI_DOUBLE, 0, _node);
+}
@@ -0,0 +1,75 @@
+
+#ifndef SRC_SOLVER_SPECIFIC_COARSEPROBLEM_H_
+#define SRC_SOLVER_SPECIFIC_COARSEPROBLEM_H_
+
+#include "mpi.h"
+
+#include "sparsesolvers.h"
+
+#include <vector>
+
+namespace espreso {
+
+/**
+ * Three-level solver of the coarse problem GGt.
+ *
+ * Rows of GGt are grouped by compute nodes. Rows coupled only with rows of the same node (interior)
+ * are eliminated by a node-level factorization on the node leader. The Schur complement on rows
+ * coupled with other nodes (interface) forms a small global coarse problem that is assembled
+ * and factorized on all node leaders (a subcommunicator of leaders).
+ *
+ * A solve consists of gather within node -> interior solve -> allgather of the interface residual among leaders
+ * -> global solve -> interior back-substitution -> scatter within node.
+ *
+ * The coupling between interior and interface rows and the Schur complement are dense,
+ * hence the problem is not created if they exceed DENSE_LIMIT values (the explicit inverse has to be used).
+ */
+class MultilevelCoarseProblem {
+
+public:
+	MultilevelCoarseProblem();
+	~MultilevelCoarseProblem();
+
+	static const size_t DENSE_LIMIT = 1 << 26;
+
+	// 'rows' are local rows of GGt in CSR with global (1-based) column indices, 'offset' is the global index of the first row
+	// returns false (on all processes) if dense parts of the problem are too big
+	bool init(SparseMatrix &rows, int offset, int size, MatrixType mtype);
+	bool initialized() const { return _node != MPI_COMM_NULL; }
+
+	// y = inv(GGt) * x, both vectors contain only local rows
+	void solve(const std::vector<double> &x, std::vector<double> &y);
+
+	// dimension of the global (interface) coarse problem
+	int interfaceSize() const { return _interfaceSize; }
+
+protected:
+	typedef std::vector<std::vector<std::pair<int, double> > > Rows;
+
+	void clear();
+	void fillMatrix(SparseMatrix &A, Rows &rows, int cols, MatrixType mtype);
+
+	bool _leader;
+	MPI_Comm _node, _leaders;
+
+	// local rows of processes within the node
+	std::vector<int> _nodeCounts, _nodeDispls;
+
+	// node leader data
+	std::vector<int> _interior, _interface; // positions of node rows
+	SparseMatrix _A_II, _A_IB, _A_BI;
+	SparseSolverCPU _interiorSolver;
+
+	// global coarse problem on interface rows of all nodes
+	int _interfaceSize, _interfaceOffset;
+	std::vector<int> _interfaceCounts, _interfaceDispls;
+	SparseSolverCPU _interfaceSolver;
+
+	std::vector<double> _x, _y, _xI, _tI, _rB, _r, _yB;
+};
+
+}
+
+
+
+#endif /* SRC_SOLVER_SPECIFIC_COARSEPROBLEM_H_ */
@@ -5,6 +5,31 @@
 
 using namespace espreso;
 
+static size_t patternHash(MKL_INT rows, const MKL_INT *I_row_indices, const MKL_INT *J_col_indices)
+{
+	size_t hash = rows;
+	for (MKL_INT i = 0; i <= rows; i++) {
+		hash = 31 * hash + I_row_indices[i];
+	}
+	for (MKL_INT i = 0; i < I_row_indices[rows] - I_row_indices[0]; i++) {
+		hash = 31 * hash + J_col_indices[i];
+	}
+	return hash;
+}
+
+static MKL_INT pardisoMatrixType(espreso::MatrixType mtype)
+{
+	switch (mtype) {
+	case espreso::MatrixType::REAL_SYMMETRIC_POSITIVE_DEFINITE:
+		return 2;
+	case espreso::MatrixType::REAL_SYMMETRIC_INDEFINITE:
+		return -2;
+	case espreso::MatrixType::REAL_UNSYMMETRIC:
+		return 11;
+	}
+	return 11;
+}
+
 SparseSolverMKL::SparseSolverMKL(){
 
 	keep_factors=true;
@@ -84,6 +109,7 @@ SparseSolverMKL::SparseSolverMKL(){
 
 	m_nRhs		 = 1;
 	m_factorized = 0;
+	m_pattern_hash = 0;
 }
 
 SparseSolverMKL::~SparseSolverMKL() {
@@ -355,6 +381,7 @@ int SparseSolverMKL::Factorization(const std::string &str) {
 		exit (EXIT_FAILURE);
 	} else {
 		initialized = true;
+		m_pattern_hash = patternHash(rows, CSR_I_row_indices, CSR_J_col_indices);
 	}
 
 	/* -------------------------------------------------------------------- */
@@ -401,6 +428,50 @@ int SparseSolverMKL::Factorization(const std::string &str) {
   return 0;
 }
 
+int SparseSolverMKL::Refactorization(SparseMatrix & A, const std::string &str) {
+
+	// The symbolic factorization (phase 11) can be reused only for the same pattern
+	if (
+			!initialized || USE_FLOAT || import_with_copy ||
+			A.rows != rows || A.cols != cols ||
+			pardisoMatrixType(A.mtype) != mtype ||
+			(MKL_INT)A.CSR_I_row_indices.size() != CSR_I_row_indices_size ||
+			(MKL_INT)A.CSR_J_col_indices.size() != CSR_J_col_indices_size ||
+			patternHash(A.rows, A.CSR_I_row_indices.data(), A.CSR_J_col_indices.data()) != m_pattern_hash) {
+
+		Clear();
+		ImportMatrix_wo_Copy(A);
+		return Factorization(str);
+	}
+
+	double ddum;			/* Double dummy */
+	MKL_INT idum;			/* Integer dummy. */
+
+	nnz = A.nnz;
+	CSR_V_values_size = A.CSR_V_values.size();
+
+	CSR_I_row_indices = &A.CSR_I_row_indices[0];
+	CSR_J_col_indices = &A.CSR_J_col_indices[0];
+	CSR_V_values	  = &A.CSR_V_values[0];
+
+	/* -------------------------------------------------------------------- */
+	/* .. Numerical factorization. */
+	/* -------------------------------------------------------------------- */
+	phase = 22;
+
+	PARDISO (pt, &maxfct, &mnum, &mtype, &phase,
+		&rows, CSR_V_values, CSR_I_row_indices, CSR_J_col_indices, &idum, &m_nRhs, iparm, &msglvl, &ddum, &ddum, &error);
+
+	if (error != 0) {
+		ESINFO(ERROR) << error << " during numerical factorization of " << str;
+		return error;
+	}
+
+	m_factorized = 1;
+	tmp_sol.resize(m_Kplus_size);
+	return 0;
+}
+
 void SparseSolverMKL::Solve( SEQ_VECTOR <double> & rhs_sol) {
 
 	if( USE_FLOAT ) {
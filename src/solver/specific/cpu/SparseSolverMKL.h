@@ -25,6 +25,7 @@ public:
 	void ExportMatrix(espreso::SparseMatrix & A);
 
 	int Factorization(const std::string &str);
+	int Refactorization(SparseMatrix & A, const std::string &str);
 	void Clear();
 	void SetThreaded();
 
@@ -106,6 +107,9 @@ public:
 	MKL_INT m_nRhs;
 	MKL_INT m_factorized;
 	MKL_INT m_Kplus_size;
+
+	// fingerprint of the pattern analyzed by the symbolic factorization (phase 11)
+	size_t m_pattern_hash;
 	// END - MKL DSS Solver Variables
 
 	// Matrices
@@ -164,6 +164,30 @@ void ClusterCPU::SetupKsolvers ( ) {
 }
 
 
+// the dense Schur complement is replaced by its implicit form if it needs much more memory than interior DOFs
+static bool isDirichletImplicit(const FETISolverConfiguration &configuration, SparseMatrix &K_modif, eslocal nonsing_size)
+{
+	switch (configuration.dirichlet_mode) {
+	case FETI_DIRICHLET_MODE::EXPLICIT:
+		return false;
+	case FETI_DIRICHLET_MODE::IMPLICIT:
+		return true;
+	default:
+		break;
+	}
+
+	eslocal offset = K_modif.CSR_I_row_indices[0];
+	double interior = 0, interface = K_modif.rows - nonsing_size;
+	for (eslocal r = 0; r < nonsing_size; r++) {
+		for (eslocal c = K_modif.CSR_I_row_indices[r]; c < K_modif.CSR_I_row_indices[r + 1]; c++) {
+			if (K_modif.CSR_J_col_indices[c - offset] - offset < nonsing_size) {
+				++interior;
+			}
+		}
+	}
+	return interface * interface > configuration.dirichlet_implicit_ratio * interior;
+}
+
 void ClusterCPU::CreateDirichletPrec( Instance *instance ) {
 
 #pragma omp parallel for
@@ -253,13 +277,43 @@ for (size_t d = 0; d < domains.size(); d++) {
 
 	eslocal sc_size = perm_vec.size();
 
+	domains[d].implicitPrec = false;
+	domains[d].Prec_K_rr.Clear();
+	domains[d].Prec_K_rs.Clear();
+	domains[d].Prec_K_sr.Clear();
+
 	if (sc_size == instance->K[domains[d].domain_global_index].rows) {
 		domains[d].Prec = instance->K[domains[d].domain_global_index];
 		domains[d].Prec.ConvertCSRToDense(1);
 		// if physics.K[d] does not contain inner DOF
 	} else {
 
-		if (configuration.preconditioner == FETI_PRECONDITIONER::DIRICHLET) {
+		if (configuration.preconditioner == FETI_PRECONDITIONER::DIRICHLET && isDirichletImplicit(configuration, K_modif, K_modif.rows - sc_size)) {
+			// S is not assembled, K_rr is factorized and the other blocks are kept as sparse matrices
+			eslocal nonsing_size = K_modif.rows - sc_size;
+			SparseMatrix K_rr;
+
+			domains[d].implicitPrec = true;
+			K_rr.getSubDiagBlockmatrix(K_modif, K_rr, 0, nonsing_size);
+			K_rr.mtype = K_modif.mtype;
+			domains[d].Prec.getSubDiagBlockmatrix(K_modif, domains[d].Prec, nonsing_size, sc_size);
+			domains[d].Prec_K_rs.getSubBlockmatrix_rs(K_modif, domains[d].Prec_K_rs, 0, nonsing_size, nonsing_size, sc_size);
+			if (SYMMETRIC_SYSTEM) {
+				domains[d].Prec_K_rs.MatTranspose(domains[d].Prec_K_sr);
+			} else {
+				domains[d].Prec_K_sr.getSubBlockmatrix_rs(K_modif, domains[d].Prec_K_sr, nonsing_size, sc_size, 0, nonsing_size);
+			}
+			for (size_t i = 0; i < domains[d].Prec_K_sr.CSR_V_values.size(); i++) {
+				domains[d].Prec_K_sr.CSR_V_values[i] = -domains[d].Prec_K_sr.CSR_V_values[i];
+			}
+
+			domains[d].Prec_K_rr.ImportMatrix(K_rr);
+			std::stringstream ss;
+			ss << "Implicit Dirichlet preconditioner -> rank: " << environment->MPIrank << ", subdomain: " << d;
+			domains[d].Prec_K_rr.Factorization(ss.str());
+			domains[d].Prec_tmp_r1.resize(nonsing_size);
+			domains[d].Prec_tmp_r2.resize(nonsing_size);
+		} else if (configuration.preconditioner == FETI_PRECONDITIONER::DIRICHLET) {
 			SparseSolverMKL createSchur;
 //          createSchur.msglvl=1;
 			eslocal sc_size = perm_vec.size();
@@ -321,7 +375,7 @@ for (size_t d = 0; d < domains.size(); d++) {
 	if (environment->print_matrices) {
 		std::ofstream osS(Logging::prepareFile(domains[d].domain_global_index, "S"));
 		SparseMatrix SC = domains[d].Prec;
-		if (configuration.preconditioner == FETI_PRECONDITIONER::DIRICHLET) {
+		if (configuration.preconditioner == FETI_PRECONDITIONER::DIRICHLET && !domains[d].implicitPrec) {
 			SC.ConvertDenseToCSR(1);
 		}
 		osS << SC;
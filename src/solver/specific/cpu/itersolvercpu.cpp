@@ -10,16 +10,16 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
 
 	 time_eval.totalTime.start();
 
+    // domains' results are stored in domains' compressed_tmp and gathered to cluster.compressed_tmp without write conflicts
     if (cluster.USE_KINV == 1 && cluster.USE_HFETI == 1) {
          time_eval.timeEvents[0].start();
-        #pragma omp parallel for
-        for (size_t d = 0; d < cluster.domains.size(); d++) {
+        cluster.dual_scheduler.run(cluster.domains.size(), [&] (size_t d) { return (double)cluster.domains[d]->B1Kplus.rows * cluster.domains[d]->B1Kplus.cols; }, [&] (size_t d) {
             for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++) {
                 cluster.domains[d]->compressed_tmp2[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]];
             }
             cluster.domains[d]->B1Kplus.DenseMatVec (cluster.domains[d]->compressed_tmp2, cluster.domains[d]->compressed_tmp);
             cluster.domains[d]->B1_comp_dom.MatVec  (cluster.domains[d]->compressed_tmp2, *cluster.x_prim_cluster1[d], 'T');
-        }
+        }, &time_eval);
          time_eval.timeEvents[0].end();
 
          time_eval.timeEvents[1].start();
@@ -27,20 +27,11 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
          time_eval.timeEvents[1].end();
 
          time_eval.timeEvents[2].start();
-        std::fill( cluster.compressed_tmp.begin(), cluster.compressed_tmp.end(), 0.0);
-        for (size_t d = 0; d < cluster.domains.size(); d++) {
-            for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-                cluster.compressed_tmp[ cluster.domains[d]->lambda_map_sub_local[i] ] += cluster.domains[d]->compressed_tmp[i];
-        }
-
-        SEQ_VECTOR < double > y_out_tmp;
+        #pragma omp parallel for
         for (size_t d = 0; d < cluster.domains.size(); d++) {
-            y_out_tmp.resize( cluster.domains[d]->B1_comp_dom.rows );
-            cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster1[d], y_out_tmp, 'N', 0, 0, 0.0); // will add (summation per elements) all partial results into y_out
-
-            for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-                cluster.compressed_tmp[ cluster.domains[d]->lambda_map_sub_local[i] ] += y_out_tmp[i];
+            cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster1[d], cluster.domains[d]->compressed_tmp, 'N', 0, 0, 1.0); // add to B1Kplus * x
         }
+        cluster.GatherDomainsLambdas();
          time_eval.timeEvents[2].end();
 
     }
@@ -51,21 +42,15 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
          time_eval.timeEvents[0].end();
 
          time_eval.timeEvents[1].start();
-        #pragma omp parallel for
-        for (size_t d = 0; d < cluster.domains.size(); d++) {
-            SEQ_VECTOR < double > x_in_tmp ( cluster.domains[d]->B1_comp_dom.rows );
+        cluster.dual_scheduler.run(cluster.domains.size(), [&] (size_t d) { return (double)cluster.domains[d]->B1Kplus.rows * cluster.domains[d]->B1Kplus.cols; }, [&] (size_t d) {
             for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-                x_in_tmp[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]];
-            cluster.domains[d]->B1Kplus.DenseMatVec ( x_in_tmp, cluster.domains[d]->compressed_tmp);
-        }
+                cluster.domains[d]->compressed_tmp2[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]];
+            cluster.domains[d]->B1Kplus.DenseMatVec ( cluster.domains[d]->compressed_tmp2, cluster.domains[d]->compressed_tmp);
+        }, &time_eval);
          time_eval.timeEvents[1].end();
 
          time_eval.timeEvents[2].start();
-        std::fill( cluster.compressed_tmp.begin(), cluster.compressed_tmp.end(), 0.0);
-        for (size_t d = 0; d < cluster.domains.size(); d++) {
-            for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-                cluster.compressed_tmp[ cluster.domains[d]->lambda_map_sub_local[i] ] += cluster.domains[d]->compressed_tmp[i];
-        }
+        cluster.GatherDomainsLambdas();
          time_eval.timeEvents[2].end();
     }
 
@@ -74,16 +59,20 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
     	 time_eval.timeEvents[0].start();
  		#pragma omp parallel for
 		for (size_t d = 0; d < cluster.domains.size(); d++) {
-			SEQ_VECTOR < double > x_in_tmp ( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+			// temporary vectors are allocated only during the first call
+			if (cluster.domains[d]->compressed_tmp2.size() < (size_t)cluster.domains[d]->B1_comp_dom.rows) {
+				cluster.domains[d]->compressed_tmp2.resize( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+				cluster.domains[d]->compressed_tmp.resize( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+			}
 			for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-				x_in_tmp[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]];
-			cluster.domains[d]->B1_comp_dom.MatVec (x_in_tmp, *cluster.x_prim_cluster1[d], 'T');
+				cluster.domains[d]->compressed_tmp2[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]];
+			cluster.domains[d]->B1_comp_dom.MatVec (cluster.domains[d]->compressed_tmp2, *cluster.x_prim_cluster1[d], 'T');
 		}
          time_eval.timeEvents[0].end();
 
          time_eval.timeEvents[1].start();
         if (cluster.USE_HFETI == 0) {
-        	cluster.multKplusFETI (cluster.x_prim_cluster1);
+        	cluster.multKplusFETI (cluster.x_prim_cluster1, &time_eval);
 		} else {
     		cluster.multKplusHFETI(cluster.x_prim_cluster1);
         }
@@ -91,17 +80,11 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
 
 
          time_eval.timeEvents[2].start();
-		std::fill( cluster.compressed_tmp.begin(), cluster.compressed_tmp.end(), 0.0);
-
-		SEQ_VECTOR < double > y_out_tmp;
+		#pragma omp parallel for
 		for (size_t d = 0; d < cluster.domains.size(); d++) {
-			y_out_tmp.resize( cluster.domains[d]->B1_comp_dom.rows );
-			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster1[d], y_out_tmp, 'N', 0, 0, 0.0); // will add (summation per elements) all partial results into y_out
-
-			for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-				cluster.compressed_tmp[ cluster.domains[d]->lambda_map_sub_local[i] ] += y_out_tmp[i];
+			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster1[d], cluster.domains[d]->compressed_tmp, 'N', 0, 0, 0.0);
 		}
-
+		cluster.GatherDomainsLambdas();
 		time_eval.timeEvents[2].end();
     }
 
@@ -114,6 +97,69 @@ void IterSolverCPU::apply_A_l_comp_dom_B( TimeEval & time_eval, SuperCluster & c
 }
 
 
+// Domains process all vectors at once: dense B1Kplus is applied by GEMM, K+ by the multiple right-hand sides solve.
+void IterSolverCPU::apply_A_l_comp_dom_B_block( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<SEQ_VECTOR<double>*> & x_in, SEQ_VECTOR<SEQ_VECTOR<double>*> & y_out) {
+
+	if (cluster.USE_HFETI == 1 || x_in.size() == 1) {
+		IterSolverBase::apply_A_l_comp_dom_B_block(time_eval, cluster, x_in, y_out);
+		return;
+	}
+
+	 time_eval.totalTime.start();
+
+	eslocal n = x_in.size();
+	SEQ_VECTOR<SEQ_VECTOR<double> > Y(cluster.domains.size());
+
+	 time_eval.timeEvents[1].start();
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t d = 0; d < cluster.domains.size(); d++) {
+		Domain *domain = cluster.domains[d];
+		eslocal lambdas = domain->B1_comp_dom.rows;
+		SEQ_VECTOR<double> X(lambdas * n, 0.0);
+		Y[d].resize(lambdas * n);
+		for (eslocal v = 0; v < n; v++) {
+			for (size_t i = 0; i < domain->lambda_map_sub_local.size(); i++) {
+				X[v * lambdas + i] = (*x_in[v])[domain->lambda_map_sub_local[i]];
+			}
+		}
+
+		if (cluster.USE_KINV == 1) {
+			domain->B1Kplus.DenseMatMultiVec(X, Y[d], n);
+		} else {
+			eslocal primal = domain->B1_comp_dom.cols;
+			SEQ_VECTOR<double> BtX(primal * n), KplusBtX(primal * n);
+			for (eslocal v = 0; v < n; v++) {
+				domain->B1_comp_dom.MatVec(X, BtX, 'T', v * lambdas, v * primal);
+			}
+			domain->multKplusLocalBlock(BtX, KplusBtX, n);
+			for (eslocal v = 0; v < n; v++) {
+				domain->B1_comp_dom.MatVec(KplusBtX, Y[d], 'N', v * primal, v * lambdas);
+			}
+		}
+	}
+	 time_eval.timeEvents[1].end();
+
+	for (eslocal v = 0; v < n; v++) {
+		 time_eval.timeEvents[2].start();
+		#pragma omp parallel for
+		for (size_t l = 0; l < cluster.compressed_tmp.size(); l++) {
+			double sum = 0;
+			for (eslocal i = cluster.lambda_gather_boundaries[l]; i < cluster.lambda_gather_boundaries[l + 1]; i++) {
+				sum += Y[cluster.lambda_gather_domains[i]][v * cluster.domains[cluster.lambda_gather_domains[i]]->B1_comp_dom.rows + cluster.lambda_gather_positions[i]];
+			}
+			cluster.compressed_tmp[l] = sum;
+		}
+		 time_eval.timeEvents[2].end();
+
+		 time_eval.timeEvents[3].start();
+		All_Reduce_lambdas_compB(cluster, cluster.compressed_tmp, *y_out[v]);
+		 time_eval.timeEvents[3].end();
+	}
+
+	 time_eval.totalTime.end();
+}
+
+
 void IterSolverCPU::apply_A_l_comp_dom_B_P( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<double> & x_in, SEQ_VECTOR<double> & y_out) {
 
 	 time_eval.totalTime.start();
@@ -523,9 +569,29 @@ void IterSolverCPU::Apply_Prec( TimeEval & time_eval, SuperCluster & cluster, SE
 
 	 time_eval.timeEvents[0].start();
 
-	#pragma omp parallel for
-	for (size_t d = 0; d < cluster.domains.size(); d++) {
-		SEQ_VECTOR < double > x_in_tmp ( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+	// domains' results are stored in domains' compressed_tmp and gathered to cluster.compressed_tmp without write conflicts
+	cluster.prec_scheduler.run(cluster.domains.size(), [&] (size_t d) -> double {
+		switch (USE_PREC) {
+		case FETI_PRECONDITIONER::DIRICHLET:
+			if (cluster.domains[d]->implicitPrec) {
+				// a solve with K_rr is estimated by its non-zeros
+				return (double)cluster.domains[d]->Prec.nnz + 4 * cluster.domains[d]->Prec_K_rs.nnz + cluster.domains[d]->K.nnz;
+			}
+			return (double)cluster.domains[d]->Prec.rows * cluster.domains[d]->Prec.cols;
+		case FETI_PRECONDITIONER::SUPER_DIRICHLET:
+		case FETI_PRECONDITIONER::MAGIC:
+			return cluster.domains[d]->Prec.nnz;
+		default:
+			return cluster.domains[d]->K.nnz;
+		}
+	}, [&] (size_t d) {
+		SEQ_VECTOR < double > &x_in_tmp = cluster.domains[d]->compressed_tmp2;
+		SEQ_VECTOR < double > &y_out_tmp = cluster.domains[d]->compressed_tmp;
+		// temporary vectors are allocated only during the first call
+		if (x_in_tmp.size() < (size_t)cluster.domains[d]->B1_comp_dom.rows) {
+			x_in_tmp.resize( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+			y_out_tmp.resize( cluster.domains[d]->B1_comp_dom.rows, 0.0 );
+		}
 		for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
 			x_in_tmp[i] = x_in[ cluster.domains[d]->lambda_map_sub_local[i]] * cluster.domains[d]->B1_scale_vec[i]; // includes B1 scaling
 
@@ -536,59 +602,44 @@ void IterSolverCPU::Apply_Prec( TimeEval & time_eval, SuperCluster & cluster, SE
 			if (cluster.domains[d]->_RegMat.nnz > 0) {
 				cluster.domains[d]->_RegMat.MatVecCOO(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d],'N', 1.0, -1.0);
 			}
+			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'N', 0, 0, 0.0);
 			break;
 		case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
 			cluster.domains[d]->B1_comp_dom.MatVec (x_in_tmp, *cluster.x_prim_cluster2[d], 'T');
+			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'N', 0, 0, 0.0);
 			break;
+		//TODO  check if MatVec is correct (DenseMatVec!!!)
 		case FETI_PRECONDITIONER::DIRICHLET:
 			cluster.domains[d]->B1t_DirPr.MatVec (x_in_tmp, *cluster.x_prim_cluster1[d], 'N');
-			cluster.domains[d]->Prec.DenseMatVec(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d],'N');
+			if (cluster.domains[d]->implicitPrec) {
+				cluster.domains[d]->multPrecImplicit(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d]);
+			} else {
+				cluster.domains[d]->Prec.DenseMatVec(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d],'N');
+			}
+			cluster.domains[d]->B1t_DirPr.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'T', 0, 0, 0.0);
 			break;
 		case FETI_PRECONDITIONER::SUPER_DIRICHLET:
 			cluster.domains[d]->B1t_DirPr.MatVec (x_in_tmp, *cluster.x_prim_cluster1[d], 'N');
 			cluster.domains[d]->Prec.MatVec(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d],'N');
+			cluster.domains[d]->B1t_DirPr.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'T', 0, 0, 0.0);
 			break;
 		case FETI_PRECONDITIONER::MAGIC:
 			cluster.domains[d]->B1_comp_dom.MatVec (x_in_tmp, *cluster.x_prim_cluster1[d], 'T');
 			cluster.domains[d]->Prec.MatVec(*cluster.x_prim_cluster1[d], *cluster.x_prim_cluster2[d],'N');
+			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'N', 0, 0, 0.0);
 			break;
 		case FETI_PRECONDITIONER::NONE:
+			std::fill(y_out_tmp.begin(), y_out_tmp.end(), 0.0);
 			break;
 		default:
 			ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
 		}
 
-	}
-
-	std::fill( cluster.compressed_tmp.begin(), cluster.compressed_tmp.end(), 0.0);
-	SEQ_VECTOR < double > y_out_tmp;
-	for (size_t d = 0; d < cluster.domains.size(); d++) {
-		y_out_tmp.resize( cluster.domains[d]->B1_comp_dom.rows );
-
-
-		switch (USE_PREC) {
-		case FETI_PRECONDITIONER::LUMPED:
-		case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
-		case FETI_PRECONDITIONER::MAGIC:
-			cluster.domains[d]->B1_comp_dom.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'N', 0, 0, 0.0); // will add (summation per elements) all partial results into y_out
-			break;
-		//TODO  check if MatVec is correct (DenseMatVec!!!)
-		case FETI_PRECONDITIONER::DIRICHLET:
-			cluster.domains[d]->B1t_DirPr.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'T', 0, 0, 0.0); // will add (summation per elements) all partial results into y_out
-			break;
-		case FETI_PRECONDITIONER::SUPER_DIRICHLET:
-			cluster.domains[d]->B1t_DirPr.MatVec (*cluster.x_prim_cluster2[d], y_out_tmp, 'T', 0, 0, 0.0); // will add (summation per elements) all partial results into y_out
-			break;
-		case FETI_PRECONDITIONER::NONE:
-			break;
-		default:
-			ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
-		}
-
-
 		for (size_t i = 0; i < cluster.domains[d]->lambda_map_sub_local.size(); i++)
-			cluster.compressed_tmp[ cluster.domains[d]->lambda_map_sub_local[i] ] += y_out_tmp[i] * cluster.domains[d]->B1_scale_vec[i]; // includes B1 scaling
-	}
+			y_out_tmp[i] *= cluster.domains[d]->B1_scale_vec[i]; // includes B1 scaling
+	}, &time_eval);
+
+	cluster.GatherDomainsLambdas();
 	 time_eval.timeEvents[0].end();
 
 
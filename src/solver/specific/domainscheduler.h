@@ -0,0 +1,90 @@
+
+#ifndef SRC_SOLVER_SPECIFIC_DOMAINSCHEDULER_H_
+#define SRC_SOLVER_SPECIFIC_DOMAINSCHEDULER_H_
+
+#include <omp.h>
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "../../basis/logging/timeeval.h"
+
+namespace espreso {
+
+/**
+ * Dispatch of per-domain operations to threads.
+ *
+ * Domains are processed from the most expensive one and threads take them dynamically,
+ * hence a thread that finishes early steals remaining (cheap) domains.
+ * The initial costs are estimated (e.g. by a size of a factor or a Schur complement),
+ * later they are replaced by measured times of previous runs.
+ */
+class DomainScheduler {
+
+public:
+	DomainScheduler(): _measured(false) {}
+
+	template <typename TEstimate, typename TOperation>
+	void run(size_t domains, TEstimate estimate, TOperation operation, TimeEval *eval = NULL)
+	{
+		if (_cost.size() != domains) {
+			_cost.resize(domains);
+			for (size_t d = 0; d < domains; d++) {
+				_cost[d] = estimate(d);
+			}
+			_time.resize(domains);
+			_measured = false;
+			sort();
+		}
+
+		_busy.resize(omp_get_max_threads());
+		std::fill(_busy.begin(), _busy.end(), 0);
+
+		double start = TimeEvent::time();
+		#pragma omp parallel
+		{
+			double busy = 0;
+			#pragma omp for schedule(dynamic, 1) nowait
+			for (size_t i = 0; i < _order.size(); i++) {
+				double dstart = TimeEvent::time();
+				operation(_order[i]);
+				_time[_order[i]] = TimeEvent::time() - dstart;
+				busy += _time[_order[i]];
+			}
+			_busy[omp_get_thread_num()] = busy;
+		}
+		double total = TimeEvent::time() - start;
+
+		if (eval != NULL) {
+			eval->addThreadsIdleTime(_busy, total);
+		}
+
+		// measured times are smoothed in order to not reorder domains by a noise
+		for (size_t d = 0; d < domains; d++) {
+			_cost[d] = _measured ? 0.5 * (_cost[d] + _time[d]) : _time[d];
+		}
+		_measured = true;
+		sort();
+	}
+
+	const std::vector<size_t>& order() const { return _order; }
+
+protected:
+	void sort()
+	{
+		_order.resize(_cost.size());
+		std::iota(_order.begin(), _order.end(), 0);
+		std::stable_sort(_order.begin(), _order.end(), [&] (size_t d1, size_t d2) { return _cost[d1] > _cost[d2]; });
+	}
+
+	bool _measured;
+	std::vector<double> _cost, _time, _busy;
+	std::vector<size_t> _order;
+};
+
+}
+
+
+
+#endif /* SRC_SOLVER_SPECIFIC_DOMAINSCHEDULER_H_ */
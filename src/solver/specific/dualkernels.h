@@ -0,0 +1,66 @@
+
+#ifndef SRC_SOLVER_SPECIFIC_DUALKERNELS_H_
+#define SRC_SOLVER_SPECIFIC_DUALKERNELS_H_
+
+#include <cstddef>
+
+namespace espreso {
+
+/**
+ * Fused kernels for vector operations of the dual CG.
+ *
+ * Dual vectors are long and operations are cheap, hence each sweep is bound by the memory bandwidth.
+ * Kernels update or reduce several vectors in one pass and use vectorized OpenMP loops.
+ * The 'mask' is the filter of lambdas (1 for lambdas owned by the process, 0 otherwise),
+ * so reductions are local and have to be summed over processes by the caller.
+ */
+
+// yw = (y, w), ww = (w, w)
+inline void dualDotAndNorm(size_t size, const double *mask, const double *y, const double *w, double &yw, double &ww)
+{
+	double syw = 0, sww = 0;
+	#pragma omp parallel for simd reduction(+:syw, sww)
+	for (size_t i = 0; i < size; i++) {
+		double mw = mask[i] * w[i];
+		syw += mw * y[i];
+		sww += mw * w[i];
+	}
+	yw = syw;
+	ww = sww;
+}
+
+// (a, b)
+inline double dualDot(size_t size, const double *mask, const double *a, const double *b)
+{
+	double sum = 0;
+	#pragma omp parallel for simd reduction(+:sum)
+	for (size_t i = 0; i < size; i++) {
+		sum += mask[i] * a[i] * b[i];
+	}
+	return sum;
+}
+
+// p = y + beta * p
+inline void dualXPBY(size_t size, const double *y, double beta, double *p)
+{
+	#pragma omp parallel for simd
+	for (size_t i = 0; i < size; i++) {
+		p[i] = y[i] + beta * p[i];
+	}
+}
+
+// x = x + alpha * p, r = r - alpha * Ap
+inline void dualUpdate(size_t size, double alpha, const double *p, const double *Ap, double *x, double *r)
+{
+	#pragma omp parallel for simd
+	for (size_t i = 0; i < size; i++) {
+		x[i] += alpha * p[i];
+		r[i] -= alpha * Ap[i];
+	}
+}
+
+}
+
+
+
+#endif /* SRC_SOLVER_SPECIFIC_DUALKERNELS_H_ */
@@ -3,6 +3,7 @@
 //#include <crtdbg.h>
 
 #include "itersolver.h"
+#include "dualkernels.h"
 
 #include "../../basis/utilities/utils.h"
 #include "../../basis/logging/logging.h"
@@ -37,9 +38,12 @@ IterSolverBase::IterSolverBase(const FETISolverConfiguration &configuration):
 	proj2_time		("Projector_l - after PREC "),
 	prec_time		("Preconditioner "),
 	ddot_alpha		("2x ddot for Alpha "),
-	ddot_beta		("2x ddot for Beta ")
+	ddot_beta		("2x ddot for Beta "),
+	replace_time	("Residual replacement ")
 {
 	this->configuration = configuration;
+	iterations = 0;
+	recycled = NULL;
 	// Timing objects
 	// Main timing object for main CG loop
 	timeEvalAppa.addEvent(apa_B1t);
@@ -111,7 +115,12 @@ void IterSolverBase::Solve ( SuperCluster & cluster,
 			Solve_RegCG ( cluster, in_right_hand_side_primal );
 		break;
 	case FETI_ITERATIVE_SOLVER::pipePCG:
-		Solve_PipeCG_singular_dom( cluster, in_right_hand_side_primal );
+		if (
+				configuration.conjugate_projector == FETI_CONJ_PROJECTOR::CONJ_R ||
+				configuration.conjugate_projector == FETI_CONJ_PROJECTOR::CONJ_K)
+			Solve_RegCG_ConjProj( cluster, in_right_hand_side_primal );
+		else
+			Solve_PipeCG_singular_dom( cluster, in_right_hand_side_primal );
 		break;
 	case FETI_ITERATIVE_SOLVER::orthogonalPCG:
 		Solve_full_ortho_CG_singular_dom (cluster, in_right_hand_side_primal );
@@ -1403,6 +1412,359 @@ void IterSolverBase::Solve_QPCE_singular_dom ( SuperCluster & cluster,
 
 
 
+// x = x_im + P * lambda_prev, where x_im is the particular solution (G' * x_im = e)
+// The projected initial guess keeps the constraint G' * x = e.
+bool IterSolverBase::WarmStart ( SuperCluster & cluster, SEQ_VECTOR <double> & x_l )
+{
+	if (dual_initial_guess.size() != x_l.size()) {
+		return false;
+	}
+
+	SEQ_VECTOR <double> Px_l (x_l.size(), 0);
+	if (USE_GGtINV == 1) {
+		Projector_Inv( timeEvalProj, cluster, dual_initial_guess, Px_l, 0 );
+	} else {
+		Projector    ( timeEvalProj, cluster, dual_initial_guess, Px_l, 0 );
+	}
+
+	#pragma omp parallel for
+	for (size_t i = 0; i < x_l.size(); i++) {
+		x_l[i] += Px_l[i];
+	}
+	return true;
+}
+
+// Recycled directions are F-orthonormalized by the Cholesky factorization of E = W' * F * W.
+// Linearly dependent directions (small pivots) are dropped.
+void IterSolverBase::Recycling_Setup ( SuperCluster & cluster )
+{
+	RecycledDirections &rd = *recycled;
+
+	// all processes have to keep the same number of directions
+	int keep = rd.lambdas == cluster.my_lamdas_indices, allkeep;
+	MPI_Allreduce(&keep, &allkeep, 1, MPI_INT, MPI_MIN, environment->MPICommunicator);
+	if (!allkeep) {
+		rd.W.clear();
+		rd.FW.clear();
+		rd.lambdas = cluster.my_lamdas_indices;
+	}
+	rd.newW.clear();
+	rd.newFW.clear();
+
+	size_t k = rd.W.size();
+	if (k == 0) {
+		return;
+	}
+
+	// the kernel of K (and hence the projector) can be changed too
+	if (rd.operatorChanged) {
+		rd.FW.resize(k);
+		for (size_t i = 0; i < k; i++) {
+			rd.FW[i].resize(rd.W[i].size());
+			if (USE_GGtINV == 1) {
+				Projector_Inv( timeEvalProj, cluster, rd.W[i], rd.FW[i], 0 );
+			} else {
+				Projector    ( timeEvalProj, cluster, rd.W[i], rd.FW[i], 0 );
+			}
+			rd.W[i].swap(rd.FW[i]);
+			apply_A_l_comp_dom_B(timeEvalAppa, cluster, rd.W[i], rd.FW[i]);
+		}
+	}
+
+	SEQ_VECTOR <double> E(k * k), L(k * k, 0);
+	for (size_t i = 0; i < k; i++) {
+		SEQ_VECTOR <double> row(k);
+		parallel_ddot_compressed_multi(cluster, rd.FW, rd.W[i], row);
+		for (size_t j = 0; j < k; j++) {
+			E[i * k + j] += row[j] / 2;
+			E[j * k + i] += row[j] / 2;
+		}
+	}
+
+	SEQ_VECTOR <size_t> kept;
+	for (size_t i = 0; i < k; i++) {
+		double d = E[i * k + i];
+		for (size_t j = 0; j < kept.size(); j++) {
+			d -= L[i * k + kept[j]] * L[i * k + kept[j]];
+		}
+		if (d <= 1e-12 * E[i * k + i]) {
+			continue;
+		}
+		L[i * k + i] = sqrt(d);
+		for (size_t m = i + 1; m < k; m++) {
+			double v = E[m * k + i];
+			for (size_t j = 0; j < kept.size(); j++) {
+				v -= L[m * k + kept[j]] * L[i * k + kept[j]];
+			}
+			L[m * k + i] = v / L[i * k + i];
+		}
+		kept.push_back(i);
+	}
+
+	// W = W * inv(L')
+	SEQ_VECTOR <SEQ_VECTOR <double> > W(kept.size()), FW(kept.size());
+	for (size_t n = 0; n < kept.size(); n++) {
+		size_t i = kept[n];
+		W[n].swap(rd.W[i]);
+		FW[n].swap(rd.FW[i]);
+		#pragma omp parallel for
+		for (size_t l = 0; l < W[n].size(); l++) {
+			for (size_t j = 0; j < n; j++) {
+				W[n][l]  -= L[i * k + kept[j]] * W[j][l];
+				FW[n][l] -= L[i * k + kept[j]] * FW[j][l];
+			}
+			W[n][l]  /= L[i * k + i];
+			FW[n][l] /= L[i * k + i];
+		}
+	}
+	rd.W.swap(W);
+	rd.FW.swap(FW);
+}
+
+// x = x + W * (W' * r), r = r - F * W * (W' * r)
+void IterSolverBase::Recycling_Deflate ( SuperCluster & cluster, SEQ_VECTOR <double> & x_l, SEQ_VECTOR <double> & r_l )
+{
+	RecycledDirections &rd = *recycled;
+	if (rd.W.empty()) {
+		return;
+	}
+
+	SEQ_VECTOR <double> c(rd.W.size());
+	parallel_ddot_compressed_multi(cluster, rd.W, r_l, c);
+
+	#pragma omp parallel for
+	for (size_t l = 0; l < x_l.size(); l++) {
+		for (size_t i = 0; i < rd.W.size(); i++) {
+			x_l[l] += c[i] * rd.W[i][l];
+			r_l[l] -= c[i] * rd.FW[i][l];
+		}
+	}
+}
+
+// p = p - W * (FW' * y) -> p is F-conjugate to W
+void IterSolverBase::Recycling_Correct ( SuperCluster & cluster, SEQ_VECTOR <double> & y_l, SEQ_VECTOR <double> & p_l )
+{
+	RecycledDirections &rd = *recycled;
+	if (rd.W.empty()) {
+		return;
+	}
+
+	SEQ_VECTOR <double> mu(rd.W.size());
+	parallel_ddot_compressed_multi(cluster, rd.FW, y_l, mu);
+
+	#pragma omp parallel for
+	for (size_t l = 0; l < p_l.size(); l++) {
+		for (size_t i = 0; i < rd.W.size(); i++) {
+			p_l[l] -= mu[i] * rd.W[i][l];
+		}
+	}
+}
+
+void IterSolverBase::Recycling_Collect ( SEQ_VECTOR <double> & p_l, SEQ_VECTOR <double> & Ap_l, double pAp )
+{
+	RecycledDirections &rd = *recycled;
+	if (rd.newW.size() == configuration.recycling_size || pAp <= 0) {
+		return;
+	}
+
+	double scale = 1 / sqrt(pAp);
+	rd.newW.push_back(p_l);
+	rd.newFW.push_back(Ap_l);
+	#pragma omp parallel for
+	for (size_t l = 0; l < p_l.size(); l++) {
+		rd.newW.back()[l] *= scale;
+		rd.newFW.back()[l] *= scale;
+	}
+}
+
+// directions of the last solve are kept first, the oldest directions are dropped
+void IterSolverBase::Recycling_Finish ()
+{
+	RecycledDirections &rd = *recycled;
+	for (size_t i = 0; i < rd.W.size() && rd.newW.size() < configuration.recycling_size; i++) {
+		rd.newW.push_back(SEQ_VECTOR <double> ());
+		rd.newFW.push_back(SEQ_VECTOR <double> ());
+		rd.newW.back().swap(rd.W[i]);
+		rd.newFW.back().swap(rd.FW[i]);
+	}
+	rd.W.swap(rd.newW);
+	rd.FW.swap(rd.newFW);
+	rd.newW.clear();
+	rd.newFW.clear();
+	rd.operatorChanged = false;
+}
+
+void IterSolverBase::apply_A_l_comp_dom_B_block( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<SEQ_VECTOR<double>*> & x_in, SEQ_VECTOR<SEQ_VECTOR<double>*> & y_out)
+{
+	for (size_t v = 0; v < x_in.size(); v++) {
+		apply_A_l_comp_dom_B(time_eval, cluster, *x_in[v], *y_out[v]);
+	}
+}
+
+// CG in the Chronopoulos-Gear form applied to all right-hand sides in lock-step.
+// The operator is applied to the block of vectors of not converged systems and all dot products
+// of one iteration are reduced by one MPI call.
+void IterSolverBase::Solve_MultiRHS ( SuperCluster & cluster,
+		SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & in_right_hand_sides_primal,
+		SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & out_primal_solutions_parallel,
+		SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & out_dual_solutions_parallel)
+{
+	size_t nrhs = in_right_hand_sides_primal.size();
+	size_t dl_size = cluster.my_lamdas_indices.size();
+
+	SEQ_VECTOR <SEQ_VECTOR <double> > x_l(nrhs, SEQ_VECTOR <double> (dl_size, 0)), b_l = x_l, r_l = x_l, w_l = x_l, y_l = x_l, s_l = x_l, p_l = x_l, Ap_l = x_l;
+	SEQ_VECTOR <double> z_l(dl_size, 0);
+	SEQ_VECTOR <double> tol(nrhs), gama(nrhs, 0), alpha(nrhs, 0);
+
+	auto project = [&] (SEQ_VECTOR <double> & in, SEQ_VECTOR <double> & out, eslocal mode) {
+		if (USE_GGtINV == 1) {
+			Projector_Inv( timeEvalProj, cluster, in, out, mode );
+		} else {
+			Projector    ( timeEvalProj, cluster, in, out, mode );
+		}
+	};
+
+	auto applyA = [&] (SEQ_VECTOR <size_t> & systems, SEQ_VECTOR <SEQ_VECTOR <double> > & in, SEQ_VECTOR <SEQ_VECTOR <double> > & out) {
+		appA_time.start();
+		SEQ_VECTOR <SEQ_VECTOR <double>*> pin, pout;
+		for (size_t k = 0; k < systems.size(); k++) {
+			pin.push_back(&in[systems[k]]);
+			pout.push_back(&out[systems[k]]);
+		}
+		apply_A_l_comp_dom_B_block(timeEvalAppa, cluster, pin, pout);
+		appA_time.end();
+	};
+
+	SEQ_VECTOR <size_t> active(nrhs);
+	for (size_t k = 0; k < nrhs; k++) {
+		active[k] = k;
+		cluster.CreateVec_b_perCluster ( in_right_hand_sides_primal[k] );
+		cluster.CreateVec_d_perCluster ( in_right_hand_sides_primal[k] );
+		project(cluster.vec_d, x_l[k], 1);
+		All_Reduce_lambdas_compB(cluster, cluster.vec_b_compressed, b_l[k]);
+	}
+
+	// r = b - Ax, the stop condition is the same as in regular CG
+	applyA(active, x_l, s_l);
+	SEQ_VECTOR <double> norms(2 * nrhs), gnorms(2 * nrhs);
+	for (size_t k = 0; k < nrhs; k++) {
+		#pragma omp parallel for
+		for (size_t i = 0; i < dl_size; i++) {
+			r_l[k][i] = b_l[k][i] - s_l[k][i];
+		}
+		project(r_l[k], w_l[k], 0);
+		for (size_t i = 0; i < dl_size; i++) {
+			norms[2 * k + 0] += w_l[k][i] * w_l[k][i] * cluster.my_lamdas_ddot_filter[i];
+			norms[2 * k + 1] += b_l[k][i] * b_l[k][i] * cluster.my_lamdas_ddot_filter[i];
+		}
+	}
+	MPI_Allreduce(norms.data(), gnorms.data(), 2 * nrhs, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
+	for (size_t k = 0; k < nrhs; k++) {
+		tol[k] = precision * sqrt(std::min(gnorms[2 * k], gnorms[2 * k + 1]));
+	}
+
+	ESINFO(CONVERGENCE) << "Solve " << nrhs << " systems with multiple right-hand sides.";
+
+	SEQ_VECTOR <double> dots, gdots;
+	for (eslocal iter = 0; iter < CG_max_iter && active.size(); iter++) {
+		timing.totalTime.start();
+
+		for (size_t a = 0; a < active.size(); a++) {
+			size_t k = active[a];
+			proj_time.start();
+			project(r_l[k], w_l[k], 0);
+			proj_time.end();
+			if (USE_PREC == FETI_PRECONDITIONER::NONE) {
+				y_l[k] = w_l[k];
+			} else {
+				prec_time.start();
+				Apply_Prec(timeEvalPrec, cluster, w_l[k], z_l);
+				prec_time.end();
+				proj_time.start();
+				project(z_l, y_l[k], 0);
+				proj_time.end();
+			}
+		}
+
+		applyA(active, y_l, s_l);
+
+		// gamma = (y, w), delta = (y, s), norm = (w, w)
+		ddot_time.start();
+		dots.assign(3 * active.size(), 0);
+		gdots.resize(3 * active.size());
+		for (size_t a = 0; a < active.size(); a++) {
+			size_t k = active[a];
+			double g = 0, d = 0, nw = 0;
+			#pragma omp parallel for reduction(+:g,d,nw)
+			for (size_t i = 0; i < dl_size; i++) {
+				g  += y_l[k][i] * w_l[k][i] * cluster.my_lamdas_ddot_filter[i];
+				d  += y_l[k][i] * s_l[k][i] * cluster.my_lamdas_ddot_filter[i];
+				nw += w_l[k][i] * w_l[k][i] * cluster.my_lamdas_ddot_filter[i];
+			}
+			dots[3 * a + 0] = g;
+			dots[3 * a + 1] = d;
+			dots[3 * a + 2] = nw;
+		}
+		MPI_Allreduce(dots.data(), gdots.data(), dots.size(), MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
+		ddot_time.end();
+
+		vec_time.start();
+		double maxratio = 0;
+		SEQ_VECTOR <size_t> next;
+		for (size_t a = 0; a < active.size(); a++) {
+			size_t k = active[a];
+			double norm = sqrt(gdots[3 * a + 2]);
+			maxratio = std::max(maxratio, norm / tol[k]);
+			if (norm < tol[k]) {
+				continue;
+			}
+			next.push_back(k);
+
+			double gama_p = gama[k], alpha_p = alpha[k];
+			gama[k] = gdots[3 * a + 0];
+			double beta = iter ? gama[k] / gama_p : 0;
+			alpha[k] = iter ? gama[k] / (gdots[3 * a + 1] - beta * gama[k] / alpha_p) : gama[k] / gdots[3 * a + 1];
+
+			#pragma omp parallel for
+			for (size_t i = 0; i < dl_size; i++) {
+				p_l[k][i]  = y_l[k][i] + beta * p_l[k][i];
+				Ap_l[k][i] = s_l[k][i] + beta * Ap_l[k][i];
+				x_l[k][i] += alpha[k] * p_l[k][i];
+				r_l[k][i] -= alpha[k] * Ap_l[k][i];
+			}
+		}
+		vec_time.end();
+
+		timing.totalTime.end();
+
+		ESINFO(CONVERGENCE)
+			<< "   " << std::setw(6) << iter + 1
+			<< "   " << std::setw(6) << active.size() << " systems"
+			<< "   " << std::fixed << std::setprecision(6) << maxratio * precision
+			<< "   " << std::fixed << std::setprecision(5) << timing.totalTime.getLastStat();
+
+		active.swap(next);
+	}
+
+	// *** save solutions - in dual and amplitudes, then get primal solutions ************************
+	out_primal_solutions_parallel.resize(nrhs);
+	out_dual_solutions_parallel.resize(nrhs);
+	for (size_t k = 0; k < nrhs; k++) {
+		dual_soultion_compressed_parallel = x_l[k];
+		dual_residuum_compressed_parallel = r_l[k];
+		project(r_l[k], amplitudes, 2);
+		GetSolution_Primal_singular_parallel(cluster, in_right_hand_sides_primal[k], out_primal_solutions_parallel[k], out_dual_solutions_parallel[k]);
+	}
+
+	timing.addEvent(ddot_time);
+	timing.addEvent(proj_time);
+	if (USE_PREC != FETI_PRECONDITIONER::NONE) {
+		timing.addEvent(prec_time);
+	}
+	timing.addEvent(appA_time);
+	timing.addEvent(vec_time );
+}
+
 void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 	    SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal)
 {
@@ -1416,10 +1778,8 @@ void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 	SEQ_VECTOR <double> r_l  (dl_size, 0);
 
 	SEQ_VECTOR <double> w_l  (dl_size, 0);
-	SEQ_VECTOR <double> wp_l (dl_size, 0);
 
 	SEQ_VECTOR <double> y_l  (dl_size, 0);
-	SEQ_VECTOR <double> yp_l (dl_size, 0);
 	SEQ_VECTOR <double> z_l  (dl_size, 0);
 	SEQ_VECTOR <double> p_l  (dl_size, 0);
 
@@ -1432,6 +1792,10 @@ void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 	double norm_l;
 	double tol;
 
+	// (y, w) of the previous iteration is the denominator of beta
+	double yw_l[2], yw_g[2], ywp_g = 0;
+	const double *mask = cluster.my_lamdas_ddot_mask.data();
+
 	cluster.CreateVec_b_perCluster ( in_right_hand_side_primal );
 	cluster.CreateVec_d_perCluster ( in_right_hand_side_primal );
 
@@ -1503,6 +1867,18 @@ void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 	else
 		tol = tol2;
 
+	// the stop condition is given by the residuum of the particular solution in order to be the same as for the cold start
+	if (WarmStart(cluster, x_l)) {
+		apply_A_l_comp_dom_B(timeEvalAppa, cluster, x_l, Ax_l);
+		#pragma omp parallel for
+		for (size_t i = 0; i < r_l.size(); i++)
+			r_l[i] = b_l[i] - Ax_l[i];
+	}
+
+	if (recycled != NULL) {
+		Recycling_Setup(cluster);
+		Recycling_Deflate(cluster, x_l, r_l);
+	}
 
 
 
@@ -1537,12 +1913,6 @@ void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 	for (int iter = 0; iter < CG_max_iter; iter++) {
 		timing.totalTime.start();
 
-		#pragma omp parallel for
-		for (size_t i = 0; i < r_l.size(); i++) {
-			wp_l[i] = w_l[i];				//	wp = w;
-			yp_l[i] = y_l[i];				//	yp = y
-		}
-
 		switch (USE_PREC) {
 		case FETI_PRECONDITIONER::LUMPED:
 		case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
@@ -1591,23 +1961,22 @@ void IterSolverBase::Solve_RegCG ( SuperCluster & cluster,
 
 
 		//------------------------------------------
-		if (iter == 0) {									// if outputs.n_it==1;
-
-			#pragma omp parallel for
-for (size_t i = 0; i < y_l.size(); i++)
-				p_l[i] = y_l[i];							// p = y;
+		// (y, w) and (w, w) in one sweep and one reduction, w is not changed till the end of the iteration
+		ddot_beta.start();
+		dualDotAndNorm(dl_size, mask, y_l.data(), w_l.data(), yw_l[0], yw_l[1]);
+		MPI_Allreduce(yw_l, yw_g, 2, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
+		ddot_beta.end();
 
+		if (iter == 0) {									// if outputs.n_it==1;
+			beta_l = 0;										// p = y;
 		} else {
+			beta_l = yw_g[0] / ywp_g;
+		}
+		dualXPBY(dl_size, y_l.data(), beta_l, p_l.data());	// p = y + beta * p;
+		ywp_g = yw_g[0];
 
-			ddot_beta.start();
-			beta_l =          parallel_ddot_compressed(cluster, y_l, w_l);
-			beta_l = beta_l / parallel_ddot_compressed(cluster, yp_l, wp_l);
-			ddot_beta.end();
-
-			#pragma omp parallel for
-for (size_t i = 0; i < p_l.size(); i++)
-				p_l[i] = y_l[i] + beta_l * p_l[i];			// p = y + beta * p;
-
+		if (recycled != NULL) {
+			Recycling_Correct(cluster, y_l, p_l);
 		}
 
 
@@ -1619,10 +1988,15 @@ for (size_t i = 0; i < p_l.size(); i++)
 
 		//------------------------------------------
 		 ddot_alpha.start();
-		alpha_l =           parallel_ddot_compressed(cluster, y_l, w_l);
-		alpha_l = alpha_l / parallel_ddot_compressed(cluster, p_l, Ap_l);
+		double pAp_l = dualDot(dl_size, mask, p_l.data(), Ap_l.data());
+		MPI_Allreduce(MPI_IN_PLACE, &pAp_l, 1, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
+		alpha_l = yw_g[0] / pAp_l;
 		 ddot_alpha.end();
 
+		if (recycled != NULL) {
+			Recycling_Collect(p_l, Ap_l, pAp_l);
+		}
+
 		//-----------------------------------------
 		// *** up0 pro ukoncovani v primaru
 
@@ -1658,15 +2032,9 @@ for (size_t i = 0; i < p_l.size(); i++)
 
 
 		//------------------------------------------
-		#pragma omp parallel for
-		 for (size_t i = 0; i < x_l.size(); i++) {
-			x_l[i] = x_l[i] + alpha_l * p_l[i];
-			r_l[i] = r_l[i] - alpha_l * Ap_l[i];
-		}
+		dualUpdate(dl_size, alpha_l, p_l.data(), Ap_l.data(), x_l.data(), r_l.data());
 
-		 norm_time.start();
-		norm_l = parallel_norm_compressed(cluster, w_l);
-		 norm_time.end();
+		norm_l = sqrt(yw_g[1]);
 
 		 timing.totalTime.end();
 
@@ -1678,12 +2046,17 @@ for (size_t i = 0; i < p_l.size(); i++)
 			<< indent << std::fixed << std::setprecision(5) << timing.totalTime.getLastStat();
 
 		// *** Stop condition ******************************************************************
+		iterations = iter + 1;
 		if (norm_l < tol)
 			break;
 
 	} // end of CG iterations
 
 
+	if (recycled != NULL) {
+		Recycling_Finish();
+	}
+
 	// *** save solution - in dual and amplitudes *********************************************
 	dual_soultion_compressed_parallel   = x_l;
 	dual_residuum_compressed_parallel   = r_l;
@@ -3572,11 +3945,18 @@ for (size_t i = 0; i < g_l.size(); i++){
 void IterSolverBase::Solve_PipeCG_singular_dom ( SuperCluster & cluster,
 	    SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal)
 {
+	switch (USE_PREC) {
+	case FETI_PRECONDITIONER::NONE:
+	case FETI_PRECONDITIONER::LUMPED:
+	case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
+	case FETI_PRECONDITIONER::DIRICHLET:
+	case FETI_PRECONDITIONER::SUPER_DIRICHLET:
+	case FETI_PRECONDITIONER::MAGIC:
+		break;
+	default:
+		ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
+	}
 
-#ifdef USE_MPI_3
-	if (mpi_rank == mpi_root)
-		ESINFO(DETAILS) << "Note: PipeCG is using non-blocking AllReduce";
-#endif
 	size_t dl_size = cluster.my_lamdas_indices.size();
 
 	SEQ_VECTOR <double> x_l (dl_size, 0);
@@ -3584,26 +3964,23 @@ void IterSolverBase::Solve_PipeCG_singular_dom ( SuperCluster & cluster,
 	SEQ_VECTOR <double> b_l  (dl_size, 0);
 
 	SEQ_VECTOR <double> Ax_l (dl_size, 0);
-	SEQ_VECTOR <double> Ap_l (dl_size, 0);
 	SEQ_VECTOR <double> r_l  (dl_size, 0);
-
+	SEQ_VECTOR <double> u_l  (dl_size, 0);
 	SEQ_VECTOR <double> w_l  (dl_size, 0);
-	SEQ_VECTOR <double> wp_l (dl_size, 0);
 
-	SEQ_VECTOR <double> y_l  (dl_size, 0);
-	SEQ_VECTOR <double> yp_l (dl_size, 0);
+	SEQ_VECTOR <double> m_l  (dl_size, 0);
+	SEQ_VECTOR <double> n_l  (dl_size, 0);
 
 	SEQ_VECTOR <double> z_l  (dl_size, 0);
-	SEQ_VECTOR <double> p_l  (dl_size, 0);
-
-	SEQ_VECTOR <double> s_l  (dl_size, 0);
 	SEQ_VECTOR <double> q_l  (dl_size, 0);
-	SEQ_VECTOR <double> m_l  (dl_size, 0);
-	SEQ_VECTOR <double> n_l  (dl_size, 0);
+	SEQ_VECTOR <double> s_l  (dl_size, 0);
+	SEQ_VECTOR <double> p_l  (dl_size, 0);
 
-	SEQ_VECTOR <double> u_l  (dl_size, 0);
 	SEQ_VECTOR <double> tmp_l(dl_size, 0);
 
+	SEQ_VECTOR <double> reduction_tmp (3, 0);
+	SEQ_VECTOR <double> send_buf      (3, 0);
+	MPI_Request mpi_req;
 
 	double gama_l  = 0;
 	double gama_lp = 0;
@@ -3617,6 +3994,57 @@ void IterSolverBase::Solve_PipeCG_singular_dom ( SuperCluster & cluster,
 	double norm_l;
 	double tol = 1;
 
+	// The preconditioned operator is split to M = P * Prec and A = P * F (without the preconditioner: M = P, A = F).
+	// All vectors below are updated by recurrences: u = M * r, w = A * u, m = M * w, n = A * m, s = A * p, q = M * s, z = A * q
+	auto project = [&] (SEQ_VECTOR <double> & in, SEQ_VECTOR <double> & out) {
+		proj_time.start();
+		if (USE_GGtINV == 1) {
+			Projector_Inv( timeEvalProj, cluster, in, out, 0 );
+		} else {
+			Projector    ( timeEvalProj, cluster, in, out, 0 );
+		}
+		proj_time.end();
+	};
+
+	auto applyM = [&] (SEQ_VECTOR <double> & in, SEQ_VECTOR <double> & out) {
+		if (USE_PREC == FETI_PRECONDITIONER::NONE) {
+			project(in, out);
+		} else {
+			prec_time.start();
+			Apply_Prec(timeEvalPrec, cluster, in, tmp_l);
+			prec_time.end();
+			project(tmp_l, out);
+		}
+	};
+
+	auto applyA = [&] (SEQ_VECTOR <double> & in, SEQ_VECTOR <double> & out) {
+		appA_time.start();
+		if (USE_PREC == FETI_PRECONDITIONER::NONE) {
+			apply_A_l_comp_dom_B(timeEvalAppa, cluster, in, out);
+		} else {
+			apply_A_l_comp_dom_B(timeEvalAppa, cluster, in, tmp_l);
+			project(tmp_l, out);
+		}
+		appA_time.end();
+	};
+
+	// r = b - Ax (projected if the preconditioner is used)
+	auto residuum = [&] () {
+		apply_A_l_comp_dom_B(timeEvalAppa, cluster, x_l, Ax_l);
+		if (USE_PREC == FETI_PRECONDITIONER::NONE) {
+			#pragma omp parallel for
+			for (size_t i = 0; i < r_l.size(); i++) {
+				r_l[i] = b_l[i] - Ax_l[i];
+			}
+		} else {
+			#pragma omp parallel for
+			for (size_t i = 0; i < r_l.size(); i++) {
+				tmp_l[i] = b_l[i] - Ax_l[i];
+			}
+			project(tmp_l, r_l);
+		}
+	};
+
 	cluster.CreateVec_b_perCluster ( in_right_hand_side_primal );
 	cluster.CreateVec_d_perCluster ( in_right_hand_side_primal );
 
@@ -3633,66 +4061,20 @@ void IterSolverBase::Solve_PipeCG_singular_dom ( SuperCluster & cluster,
 	// *** Combine vectors b from all clusters ************************************
 	All_Reduce_lambdas_compB(cluster, cluster.vec_b_compressed, b_l);
 
+	residuum();
+	applyM(r_l, u_l);
 
-	// *** Ax = apply_A(CLUSTER,Bt,x); ********************************************
-	apply_A_l_comp_dom_B(timeEvalAppa, cluster, x_l, Ax_l); //apply_A_l_compB(timeEvalAppa, cluster, x_l, Ax_l);
-
-
-	// *** r = b - Ax; ************************************************************
-	switch (USE_PREC) {
-	case FETI_PRECONDITIONER::LUMPED:
-	case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
-	case FETI_PRECONDITIONER::DIRICHLET:
-	case FETI_PRECONDITIONER::SUPER_DIRICHLET:
-	case FETI_PRECONDITIONER::MAGIC:
-
-		#pragma omp parallel for
-for (size_t i = 0; i < r_l.size(); i++) {
-			tmp_l[i] = b_l[i] - Ax_l[i];
-		}
-
-		if (USE_GGtINV == 1) {
-			Projector_Inv( timeEvalProj, cluster, tmp_l, r_l, 0 );
-		} else {
-			Projector    ( timeEvalProj, cluster, tmp_l, r_l, 0 );
-		}
-
-		tol = precision * parallel_norm_compressed(cluster, r_l);
-
-		Apply_Prec(timeEvalPrec, cluster, r_l, tmp_l);
-		if (USE_GGtINV == 1) {
-			Projector_Inv( timeEvalProj, cluster, tmp_l, u_l, 0 );
-		} else {
-			Projector    ( timeEvalProj, cluster, tmp_l, u_l, 0 );
-		}
-
-		apply_A_l_comp_dom_B(timeEvalAppa, cluster, u_l, tmp_l); //apply_A_l_compB(timeEvalAppa, cluster, u_l, tmp_l);
-		if (USE_GGtINV == 1) {
-			Projector_Inv( timeEvalProj, cluster, tmp_l, w_l, 0 );
-		} else {
-			Projector    ( timeEvalProj, cluster, tmp_l, w_l, 0 );
-		}
-
-		break;
-	case FETI_PRECONDITIONER::NONE:
-		#pragma omp parallel for
-		for (size_t i = 0; i < r_l.size(); i++) {
-			r_l[i] = b_l[i] - Ax_l[i];
-		}
-
-		if (USE_GGtINV == 1) {
-			Projector_Inv( timeEvalProj, cluster, r_l, u_l, 0 );
-		} else {
-			Projector    ( timeEvalProj, cluster, r_l, u_l, 0 );
-		}
-		tol = precision * parallel_norm_compressed(cluster, u_l);
+	// the norm of the projected residuum (the same stop condition as in regular CG)
+	SEQ_VECTOR <double> & norm_vec = USE_PREC == FETI_PRECONDITIONER::NONE ? u_l : r_l;
+	double tol1 = precision * parallel_norm_compressed(cluster, norm_vec);
+	double tol2 = precision * parallel_norm_compressed(cluster, b_l);
+	tol = std::min(tol1, tol2);
 
-		apply_A_l_comp_dom_B(timeEvalAppa, cluster, u_l, w_l); 	//apply_A_l_compB(timeEvalAppa, cluster, u_l, w_l);
-		break;
-	default:
-		ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
+	if (WarmStart(cluster, x_l)) {
+		residuum();
+		applyM(r_l, u_l);
 	}
-
+	applyA(u_l, w_l);
 
 	int precisionWidth = ceil(log(1 / precision) / log(10)) + 1;
 	int iterationWidth = ceil(log(CG_max_iter) / log(10));
@@ -3717,79 +4099,29 @@ for (size_t i = 0; i < r_l.size(); i++) {
 	for (eslocal iter = 0; iter < CG_max_iter; iter++) {
 
 		timing.totalTime.start();
+		iterations = iter + 1;
 
 		alpha_lp = alpha_l;
 		gama_lp  = gama_l;
 
 		//------------------------------------------
+		// gamma = (r, u), delta = (w, u) and the norm are reduced by one non-blocking reduction
 		ddot_time.start();
-		MPI_Request mpi_req;
-
-		SEQ_VECTOR <double> reduction_tmp (3,0);
-		SEQ_VECTOR <double> send_buf      (3,0);
-
-		switch (USE_PREC) {
-		case FETI_PRECONDITIONER::LUMPED:
-		case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
-		case FETI_PRECONDITIONER::DIRICHLET:
-	  case FETI_PRECONDITIONER::SUPER_DIRICHLET:
-		case FETI_PRECONDITIONER::MAGIC:
-			parallel_ddot_compressed_non_blocking(cluster, r_l, u_l, w_l, u_l, r_l, &mpi_req, reduction_tmp, send_buf); // norm_l = parallel_norm_compressed(cluster, r_l);
-			ddot_time.end();
-
-			prec_time.start();
-			Apply_Prec(timeEvalPrec, cluster, w_l, tmp_l);
-			prec_time.end();
-
-			proj_time.start();
-			if (USE_GGtINV == 1) {
-				Projector_Inv( timeEvalProj, cluster, tmp_l, m_l, 0 );
-			} else {
-				Projector    ( timeEvalProj, cluster, tmp_l, m_l, 0 );
-			}
-			proj_time.end();
+		send_buf[0] = send_buf[1] = send_buf[2] = 0;
+		parallel_ddot_compressed_non_blocking(cluster, r_l, u_l, w_l, u_l, norm_vec, &mpi_req, reduction_tmp, send_buf);
+		ddot_time.end();
 
-			appA_time.start();
-			apply_A_l_comp_dom_B(timeEvalAppa, cluster, m_l, tmp_l); //apply_A_l_compB(timeEvalAppa, cluster, m_l, tmp_l);
-			appA_time.end();
-
-			proj_time.start();
-			if (USE_GGtINV == 1) {
-				Projector_Inv( timeEvalProj, cluster, tmp_l, n_l, 0 );
-			} else {
-				Projector    ( timeEvalProj, cluster, tmp_l, n_l, 0 );
-			}
-			proj_time.end();
-
-			break;
-		case FETI_PRECONDITIONER::NONE:
-			parallel_ddot_compressed_non_blocking(cluster, r_l, u_l, w_l, u_l, u_l, &mpi_req, reduction_tmp, send_buf); // norm_l = parallel_norm_compressed(cluster, u_l);
-			ddot_time.end();
-
-			proj_time.start();
-
-			if (USE_GGtINV == 1) {
-				Projector_Inv( timeEvalProj, cluster, w_l, m_l, 0 );
-			} else {
-				Projector    ( timeEvalProj, cluster, w_l, m_l, 0 );
-			}
-
-			proj_time.end();
-
-			//------------------------------------------
-			appA_time.start();
-			apply_A_l_comp_dom_B(timeEvalAppa, cluster, m_l, n_l); //apply_A_l_compB(timeEvalAppa, cluster, m_l, n_l);
-			appA_time.end();
-			break;
-		default:
-			ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
-		}
+		// the reduction is overlapped by the preconditioner and by the operator (including exchange of neighbours' lambdas)
+		applyM(w_l, m_l);
+		applyA(m_l, n_l);
 
+		ddot_time.start();
 #ifndef WIN32
-#ifdef USE_MPI_3
-		MPI_Wait(&mpi_req, &mpi_stat);
+#if MPI_VERSION >= 3
+		MPI_Wait(&mpi_req, MPI_STATUS_IGNORE);
 #endif
 #endif
+		ddot_time.end();
 
 		norm_l  = sqrt(reduction_tmp[2]);
 		if (norm_l < tol) {
@@ -3817,7 +4149,7 @@ for (size_t i = 0; i < r_l.size(); i++) {
 		}
 
 		#pragma omp parallel for
-for (size_t i = 0; i < r_l.size(); i++) {
+		for (size_t i = 0; i < r_l.size(); i++) {
 			z_l[i] = n_l[i] + beta_l  * z_l[i];
 			q_l[i] = m_l[i] + beta_l  * q_l[i];
 			s_l[i] = w_l[i] + beta_l  * s_l[i];
@@ -3829,8 +4161,17 @@ for (size_t i = 0; i < r_l.size(); i++) {
 		}
 		vec_time.end();
 
-		norm_time.start();
-		norm_time.end();
+		// rounding errors of recurrences are accumulated -> replace them by true values
+		if (configuration.residual_replacement && (iter + 1) % configuration.residual_replacement == 0) {
+			replace_time.start();
+			residuum();
+			applyM(r_l, u_l);
+			applyA(u_l, w_l);
+			applyA(p_l, s_l);
+			applyM(s_l, q_l);
+			applyA(q_l, z_l);
+			replace_time.end();
+		}
 
 		 timing.totalTime.end();
 
@@ -3865,29 +4206,15 @@ for (size_t i = 0; i < r_l.size(); i++) {
 
 	// *** Preslocal out the timing for the iteration loop ***************************************
 	timing.addEvent(ddot_time);
-
-	// *** Preslocal out the timing for the iteration loop ***************************************
-
-	switch (USE_PREC) {
-	case FETI_PRECONDITIONER::LUMPED:
-	case FETI_PRECONDITIONER::WEIGHT_FUNCTION:
-	case FETI_PRECONDITIONER::DIRICHLET:
-	case FETI_PRECONDITIONER::SUPER_DIRICHLET:
-	case FETI_PRECONDITIONER::MAGIC:
-		//timing.addEvent(proj1_time);
-		timing.addEvent(proj_time);
-		timing.addEvent(prec_time );
-		//timing.addEvent(proj2_time);
-		break;
-	case FETI_PRECONDITIONER::NONE:
-		timing.addEvent(proj_time);
-		break;
-	default:
-		ESINFO(GLOBAL_ERROR) << "Not implemented preconditioner.";
+	timing.addEvent(proj_time);
+	if (USE_PREC != FETI_PRECONDITIONER::NONE) {
+		timing.addEvent(prec_time);
 	}
-
 	timing.addEvent(appA_time);
 	timing.addEvent(vec_time );
+	if (configuration.residual_replacement) {
+		timing.addEvent(replace_time);
+	}
 
 }
 
@@ -5017,6 +5344,27 @@ void IterSolverBase::CreateGGt_Inv( SuperCluster & cluster )
 	}
 	 GGtLocAsm.end(); GGtLocAsm.printStatMPI(); preproc_timing.addEvent(GGtLocAsm);
 
+	// the explicit inverse is applied transposed, the three-level coarse problem solves only symmetric GGt
+	if (configuration.coarse_problem == FETI_COARSE_PROBLEM::THREE_LEVEL && !cluster.SYMMETRIC_SYSTEM) {
+		ESINFO(ALWAYS_ON_ROOT) << Info::TextColor::YELLOW << "Three-level coarse problem is not supported for unsymmetric systems, the explicit inverse of GGt is used.";
+	}
+	if (configuration.coarse_problem == FETI_COARSE_PROBLEM::THREE_LEVEL && cluster.SYMMETRIC_SYSTEM) {
+		// rows of GGt are factorized per node, only interface kernels form the global coarse problem
+		 TimeEvent multilevel_time("Create three-level coarse problem"); multilevel_time.start();
+		MKL_Set_Num_Threads(PAR_NUM_THREADS);
+		bool created = coarseProblem.init(GGt_l, global_ker_size, global_GGt_size, cluster.mtype);
+		MKL_Set_Num_Threads(1);
+		 multilevel_time.end(); multilevel_time.printStatMPI(); preproc_timing.addEvent(multilevel_time);
+
+		if (created) {
+			GGtsize  = global_GGt_size;
+			GGt.cols = global_GGt_size;
+			GGt.rows = global_GGt_size;
+			cluster.GGtinvM.cols = 0;
+			return;
+		}
+	}
+
 	 // Collecting pieces of GGt from all clusters to master (MPI rank 0) node - using binary tree reduction
 	 TimeEvent collectGGt_time("Collect GGt pieces to master"); 	collectGGt_time.start();
 	int count_cv_l = 0;
@@ -5544,7 +5892,7 @@ void IterSolverBase::Projector_Inv (TimeEval & time_eval, SuperCluster & cluster
 	 time_eval.totalTime.start();
 	eslocal d_local_size = cluster.G1_comp.rows;
 	SEQ_VECTOR<double> d_local( d_local_size );
-	SEQ_VECTOR<double> d_mpi  ( GGtsize );
+	SEQ_VECTOR<double> d_mpi;
 	 time_eval.timeEvents[0].start();
 
 	if (   output_in_kerr_dim_2_input_in_kerr_dim_1_inputoutput_in_dual_dim_0 == 1
@@ -5566,33 +5914,41 @@ void IterSolverBase::Projector_Inv (TimeEval & time_eval, SuperCluster & cluster
 
 	 time_eval.timeEvents[0].end();
 
-	//TODO: Udelat poradne
-	 time_eval.timeEvents[1].start();
-	SEQ_VECTOR<int> ker_size_per_clusters(environment->MPIsize,0);
-	MPI_Allgather(&d_local_size, 1, MPI_INT, &ker_size_per_clusters[0], 1, MPI_INT, environment->MPICommunicator );
+	if (coarseProblem.initialized()) {
+		 time_eval.timeEvents[2].start();
+		SEQ_VECTOR<double> d_in(d_local);
+		coarseProblem.solve(d_in, d_local);
+		 time_eval.timeEvents[2].end();
+	} else {
+		//TODO: Udelat poradne
+		 time_eval.timeEvents[1].start();
+		d_mpi.resize(GGtsize);
+		SEQ_VECTOR<int> ker_size_per_clusters(environment->MPIsize,0);
+		MPI_Allgather(&d_local_size, 1, MPI_INT, &ker_size_per_clusters[0], 1, MPI_INT, environment->MPICommunicator );
 
-	SEQ_VECTOR<int> displs (environment->MPIsize,0);
-	displs[0] = 0;
+		SEQ_VECTOR<int> displs (environment->MPIsize,0);
+		displs[0] = 0;
 
-	for (size_t i=1; i<displs.size(); ++i) {
-		displs[i] = displs[i-1] + ker_size_per_clusters[i-1];
-	}
-	MPI_Allgatherv(&d_local[0], d_local_size, MPI_DOUBLE, &d_mpi[0], &ker_size_per_clusters[0], &displs[0], MPI_DOUBLE, environment->MPICommunicator);
-	// TODO: END
+		for (size_t i=1; i<displs.size(); ++i) {
+			displs[i] = displs[i-1] + ker_size_per_clusters[i-1];
+		}
+		MPI_Allgatherv(&d_local[0], d_local_size, MPI_DOUBLE, &d_mpi[0], &ker_size_per_clusters[0], &displs[0], MPI_DOUBLE, environment->MPICommunicator);
+		// TODO: END
 
-	time_eval.timeEvents[1].end();
-	// TODO: END
+		time_eval.timeEvents[1].end();
+		// TODO: END
 
-	 time_eval.timeEvents[2].start();
+		 time_eval.timeEvents[2].start();
 
-	if (cluster.GGtinvM.cols != 0) {
-		cluster.GGtinvM.DenseMatVec(d_mpi, d_local, 'T');
-	}
-	 time_eval.timeEvents[2].end();
+		if (cluster.GGtinvM.cols != 0) {
+			cluster.GGtinvM.DenseMatVec(d_mpi, d_local, 'T');
+		}
+		 time_eval.timeEvents[2].end();
 
-	 time_eval.timeEvents[3].start();
-	//MPI_Scatter( &d_mpi[0],      d_local_size, MPI_DOUBLE, &d_local[0], d_local_size, MPI_DOUBLE, mpi_root, environment->MPICommunicator);
-	 time_eval.timeEvents[3].end();
+		 time_eval.timeEvents[3].start();
+		//MPI_Scatter( &d_mpi[0],      d_local_size, MPI_DOUBLE, &d_local[0], d_local_size, MPI_DOUBLE, mpi_root, environment->MPICommunicator);
+		 time_eval.timeEvents[3].end();
+	}
 
 	if (output_in_kerr_dim_2_input_in_kerr_dim_1_inputoutput_in_dual_dim_0 == 2
 		 ||
@@ -6372,37 +6728,7 @@ void   BcastMatrix ( eslocal rank, eslocal mpi_root, eslocal source_rank, Sparse
 
 void   All_Reduce_lambdas_compB( SuperCluster & cluster, SEQ_VECTOR<double> & x_in, SEQ_VECTOR<double> & y_out )
 {
-
-	for (size_t i = 0; i < cluster.my_comm_lambdas_indices_comp.size(); i++) {
-		for (size_t j = 0; j < cluster.my_comm_lambdas_indices_comp[i].size(); j++) {
-			cluster.my_comm_lambdas[i][j] = x_in[cluster.my_comm_lambdas_indices_comp[i][j]];
-		}
-	}
-
-	SEQ_VECTOR < MPI_Request > request ( 2 * cluster.my_neighs.size() );
-
-	//cluster.iter_cnt_comm++;
-	eslocal tag = 1;
-
-	for (size_t neigh_i = 0; neigh_i < cluster.my_neighs.size(); neigh_i++ ) {
-		MPI_Isend(
-			&cluster.my_comm_lambdas[neigh_i][0], cluster.my_comm_lambdas[neigh_i].size(), MPI_DOUBLE, cluster.my_neighs[neigh_i], tag, environment->MPICommunicator, &request[ 0                        + neigh_i] );
-	}
-
-	for (size_t neigh_i = 0; neigh_i < cluster.my_neighs.size(); neigh_i++ ) {
-		MPI_Irecv(
-			&cluster.my_recv_lambdas[neigh_i][0], cluster.my_recv_lambdas[neigh_i].size(), MPI_DOUBLE, cluster.my_neighs[neigh_i], tag, environment->MPICommunicator, &request[ cluster.my_neighs.size() + neigh_i] );
-	}
-
-	MPI_Waitall( 2 * cluster.my_neighs.size(), &request[0], MPI_STATUSES_IGNORE);
-
-	y_out = x_in; // TODO: POZOR pozor
-	for (size_t i = 0; i < cluster.my_comm_lambdas_indices_comp.size(); i++) {
-		for (size_t j = 0; j < cluster.my_comm_lambdas_indices_comp[i].size(); j++) {
-			y_out[cluster.my_comm_lambdas_indices_comp[i][j]] += cluster.my_recv_lambdas[i][j];
-		}
-	}
-
+	cluster.lambdaExchange.exchange(x_in, y_out);
 }
 
 void   compress_lambda_vector  ( SuperCluster & cluster, SEQ_VECTOR <double> & decompressed_vec_lambda)
@@ -6466,6 +6792,23 @@ double parallel_ddot_compressed( SuperCluster & cluster, SEQ_VECTOR<double> & in
 	return a1g;
 }
 
+// all dot products are reduced by one MPI call
+void parallel_ddot_compressed_multi( SuperCluster & cluster, SEQ_VECTOR<SEQ_VECTOR<double> > & input_vectors, SEQ_VECTOR<double> & input_vector, SEQ_VECTOR<double> & output )
+{
+	SEQ_VECTOR<double> local(input_vectors.size(), 0);
+	for (size_t v = 0; v < input_vectors.size(); v++) {
+		double a1 = 0;
+		#pragma omp parallel for reduction(+:a1)
+		for (size_t i = 0; i < cluster.my_lamdas_indices.size(); i++)  {
+			a1 += input_vectors[v][i] * input_vector[i] * cluster.my_lamdas_ddot_filter[i];
+		}
+		local[v] = a1;
+	}
+
+	output.resize(input_vectors.size());
+	MPI_Allreduce(local.data(), output.data(), local.size(), MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
+}
+
 void   parallel_ddot_compressed_non_blocking( SuperCluster & cluster,
 	SEQ_VECTOR<double> & input_vector_1a, SEQ_VECTOR<double> & input_vector_1b,
 	SEQ_VECTOR<double> & input_vector_2a, SEQ_VECTOR<double> & input_vector_2b,
@@ -6476,18 +6819,23 @@ void   parallel_ddot_compressed_non_blocking( SuperCluster & cluster,
 	SEQ_VECTOR <double> & send_buf)
 {
 
+	double ddot1 = 0, ddot2 = 0, norm = 0;
+	#pragma omp parallel for reduction(+:ddot1,ddot2,norm)
 	for (size_t i = 0; i < cluster.my_lamdas_indices.size(); i++)  {
-		send_buf[0] = send_buf[0] + (input_vector_1a[i] * input_vector_1b[i] * cluster.my_lamdas_ddot_filter[i]); // ddot 1
-		send_buf[1] = send_buf[1] + (input_vector_2a[i] * input_vector_2b[i] * cluster.my_lamdas_ddot_filter[i]); // ddot 2
-		send_buf[2] = send_buf[2] + (input_norm_vec[i]  * input_norm_vec[i]  * cluster.my_lamdas_ddot_filter[i]); // norm
+		ddot1 += input_vector_1a[i] * input_vector_1b[i] * cluster.my_lamdas_ddot_filter[i];
+		ddot2 += input_vector_2a[i] * input_vector_2b[i] * cluster.my_lamdas_ddot_filter[i];
+		norm  += input_norm_vec[i]  * input_norm_vec[i]  * cluster.my_lamdas_ddot_filter[i];
 	}
+	send_buf[0] += ddot1;
+	send_buf[1] += ddot2;
+	send_buf[2] += norm;
 
 
 #ifdef WIN32
 	MPI_Barrier(environment->MPICommunicator);
 	MPI_Allreduce( &send_buf[0], &output[0], 3, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
 #else
-#ifdef USE_MPI_3
+#if MPI_VERSION >= 3
 	MPI_Iallreduce( &send_buf[0], &output[0], 3, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator, mpi_req);
 #else
 	MPI_Allreduce( &send_buf[0], &output[0], 3, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
@@ -6506,17 +6854,21 @@ void   parallel_ddot_compressed_non_blocking( SuperCluster & cluster,
 	SEQ_VECTOR <double> & send_buf)
 {
 
+	double ddot1 = 0, ddot2 = 0;
+	#pragma omp parallel for reduction(+:ddot1,ddot2)
 	for (size_t i = 0; i < cluster.my_lamdas_indices.size(); i++)  {
-		send_buf[0] = send_buf[0] + (input_vector_1a[i] * input_vector_1b[i] * cluster.my_lamdas_ddot_filter[i]);
-		send_buf[1] = send_buf[1] + (input_vector_2a[i] * input_vector_2b[i] * cluster.my_lamdas_ddot_filter[i]);
+		ddot1 += input_vector_1a[i] * input_vector_1b[i] * cluster.my_lamdas_ddot_filter[i];
+		ddot2 += input_vector_2a[i] * input_vector_2b[i] * cluster.my_lamdas_ddot_filter[i];
 	}
+	send_buf[0] += ddot1;
+	send_buf[1] += ddot2;
 
 
 #ifdef WIN32
 	MPI_Barrier(environment->MPICommunicator);
 	MPI_Allreduce( &send_buf[0], &output[0], 2, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
 #else
-#ifdef USE_MPI_3
+#if MPI_VERSION >= 3
 	MPI_Iallreduce( &send_buf[0], &output[0], 2, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator, mpi_req);
 #else
 	MPI_Allreduce( &send_buf[0], &output[0], 2, MPI_DOUBLE, MPI_SUM, environment->MPICommunicator);
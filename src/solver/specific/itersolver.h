@@ -27,12 +27,24 @@ using std::make_pair;
 #include "sparsesolvers.h"
 #include "clusters.h"
 #include "superclusters.h"
+#include "coarseproblem.h"
 #include "../generic/utils.h"
 
 namespace espreso {
 
 //class SuperCluster;
 
+// Search directions of the dual operator F recycled from previous solves (deflation space).
+// Directions are F-orthonormal (W' * F * W = I) and stored together with their products with F.
+struct RecycledDirections {
+	SEQ_VECTOR <eslocal> lambdas; // layout of lambdas of stored vectors
+	SEQ_VECTOR <SEQ_VECTOR <double> > W, FW;
+	SEQ_VECTOR <SEQ_VECTOR <double> > newW, newFW; // directions of the current solve
+	bool operatorChanged; // FW has to be recomputed
+
+	RecycledDirections(): operatorChanged(true) {}
+};
+
 class IterSolverBase
 {
 public:
@@ -55,6 +67,11 @@ public:
 	SEQ_VECTOR <double> dual_soultion_compressed_parallel;
 	SEQ_VECTOR <double> dual_residuum_compressed_parallel;
 
+	// the initial guess of the dual solution (compressed, empty for the cold start)
+	SEQ_VECTOR <double> dual_initial_guess;
+	eslocal iterations; // the number of iterations of the last solve
+	RecycledDirections *recycled; // NULL if search directions are not recycled
+
 	SEQ_VECTOR < SEQ_VECTOR <double> > primal_solution_parallel;
 	SEQ_VECTOR <double> amplitudes;
 
@@ -62,6 +79,7 @@ public:
 	SparseMatrix	GGt_Mat;
 	SparseSolverCPU	GGt;
 	eslocal 		GGtsize;
+	MultilevelCoarseProblem coarseProblem; // used instead of GGtinvM by the three-level coarse problem
 
 	// *** Setup variables
 	eslocal  USE_KINV;
@@ -129,6 +147,7 @@ public:
 	TimeEvent prec_time; //  (string("Preconditioner "));
 	TimeEvent ddot_alpha; // (string("2x ddot for Alpha "));
 	TimeEvent ddot_beta; //  (string("2x ddot for Beta "));
+	TimeEvent replace_time; // (string("Residual replacement "));
 
 	//preproc_timing.totalTime.AddEnd(omp_get_wtime());
 
@@ -171,6 +190,7 @@ public:
 	virtual void apply_A_l_comp_dom_B_P      ( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<double> & x_in, SEQ_VECTOR<double> & y_out) =0;
 	virtual void apply_A_l_comp_dom_B_P_local( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<double> & x_in, SEQ_VECTOR<double> & y_out) =0;
 	virtual void apply_A_l_comp_dom_B_P_local_sparse( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<eslocal> & tmp_in_indices, SEQ_VECTOR<double> & tmp_in_values, SEQ_VECTOR<eslocal> & tmp_out_indices, SEQ_VECTOR<double> & tmp_out_values) =0;
+	virtual void apply_A_l_comp_dom_B_block  ( TimeEval & time_eval, SuperCluster & cluster, SEQ_VECTOR<SEQ_VECTOR<double>*> & x_in, SEQ_VECTOR<SEQ_VECTOR<double>*> & y_out);
 
 	void apply_A_l_Mat		 ( TimeEval & time_eval, SuperCluster & cluster, SparseMatrix       & X_in, SparseMatrix       & Y_out) ;
 	void apply_A_l_Mat_local ( TimeEval & time_eval, SuperCluster & cluster, SparseMatrix       & X_in, SparseMatrix       & Y_out) ;
@@ -185,6 +205,12 @@ public:
 
 	void Solve     ( SuperCluster & cluster, SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal, SEQ_VECTOR < SEQ_VECTOR <double> > & out_primal_solution_parallel, SEQ_VECTOR < SEQ_VECTOR <double> > & out_dual_solution_parallel );
 
+	// *** Solve systems with the same operator and multiple right-hand sides at once
+	void Solve_MultiRHS ( SuperCluster & cluster,
+			SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & in_right_hand_sides_primal,
+			SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & out_primal_solutions_parallel,
+			SEQ_VECTOR < SEQ_VECTOR < SEQ_VECTOR <double> > > & out_dual_solutions_parallel );
+
 
 	// *** Power Method - Estimation of maximum eigenvalue of matrix
 	double Solve_power_method ( SuperCluster & cluster, double tol, eslocal maxit, eslocal method);
@@ -198,6 +224,16 @@ public:
 
 	void Solve_QPCE_singular_dom  ( SuperCluster & cluster, SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal );
 
+	// *** Start from the projected initial guess
+	bool WarmStart ( SuperCluster & cluster, SEQ_VECTOR <double> & x_l );
+
+	// *** Deflation by search directions recycled from previous solves
+	void Recycling_Setup   ( SuperCluster & cluster );
+	void Recycling_Deflate ( SuperCluster & cluster, SEQ_VECTOR <double> & x_l, SEQ_VECTOR <double> & r_l );
+	void Recycling_Correct ( SuperCluster & cluster, SEQ_VECTOR <double> & y_l, SEQ_VECTOR <double> & p_l );
+	void Recycling_Collect ( SEQ_VECTOR <double> & p_l, SEQ_VECTOR <double> & Ap_l, double pAp );
+	void Recycling_Finish  ();
+
 	// *** CG solvers
 	void Solve_RegCG  ( SuperCluster & cluster, SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal );
 	void Solve_RegCG_ConjProj  ( SuperCluster & cluster, SEQ_VECTOR < SEQ_VECTOR <double> > & in_right_hand_side_primal );
@@ -253,6 +289,7 @@ double parallel_norm_compressed( SuperCluster & cluster, SEQ_VECTOR<double> & in
 
 double parallel_ddot_compressed_double( SuperCluster & cluster, double *input_vector1, double *input_vector2 );
 double parallel_ddot_compressed( SuperCluster & cluster, SEQ_VECTOR<double> & input_vector1, SEQ_VECTOR<double> & input_vector2 );
+void   parallel_ddot_compressed_multi( SuperCluster & cluster, SEQ_VECTOR<SEQ_VECTOR<double> > & input_vectors, SEQ_VECTOR<double> & input_vector, SEQ_VECTOR<double> & output );
 
 void parallel_ddot_compressed_non_blocking( SuperCluster & cluster,
 	SEQ_VECTOR<double> & input_vector_1a, SEQ_VECTOR<double> & input_vector_1b,
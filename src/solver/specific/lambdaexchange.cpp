@@ -0,0 +1,241 @@
+
+#include "lambdaexchange.h"
+
+#include "../../basis/utilities/communication.h"
+#include "../../basis/logging/timeeval.h"
+#include "../../config/ecf/environment.h"
+
+#include <algorithm>
+
+using namespace espreso;
+
+LambdaExchange::LambdaExchange()
+: _communicator(MPI_COMM_NULL),
+  _window(MPI_WIN_NULL), _counters(NULL), _data(NULL), _localSize(0),
+  _exchanges(0)
+{
+
+}
+
+LambdaExchange::~LambdaExchange()
+{
+	clear();
+}
+
+void LambdaExchange::clear()
+{
+	int finalized;
+	MPI_Finalized(&finalized);
+	if (finalized) {
+		return;
+	}
+
+	for (size_t i = 0; i < _requests.size(); i++) {
+		MPI_Request_free(&_requests[i]);
+	}
+	_requests.clear();
+
+#if MPI_VERSION >= 3
+	if (_window != MPI_WIN_NULL) {
+		MPI_Win_unlock_all(_window);
+		MPI_Win_free(&_window);
+	}
+#endif
+	_counters = NULL;
+	_data = NULL;
+
+	if (_communicator != MPI_COMM_NULL) {
+		MPI_Comm_free(&_communicator);
+	}
+
+	_indices.clear();
+	_offsets.clear();
+	_remote.clear();
+	_local.clear();
+	_localOffsets.clear();
+	_neighCounters.clear();
+	_neighData.clear();
+	_neighSize.clear();
+	_localSize = 0;
+	_exchanges = 0;
+}
+
+void LambdaExchange::init(const std::vector<eslocal> &neighbours, const std::vector<std::vector<eslocal> > &indices)
+{
+	clear();
+	MPI_Comm_dup(environment->MPICommunicator, &_communicator);
+
+	_offsets.push_back(0);
+	for (size_t n = 0; n < neighbours.size(); n++) {
+		_indices.insert(_indices.end(), indices[n].begin(), indices[n].end());
+		_offsets.push_back(_indices.size());
+	}
+
+	std::vector<int> nodeRank(neighbours.size(), -1);
+#if MPI_VERSION >= 3
+	MPIGroup &node = MPITools::withinNodes();
+	std::vector<int> nodeRanks(node.size);
+	MPI_Allgather(&environment->MPIrank, 1, MPI_INT, nodeRanks.data(), 1, MPI_INT, node.communicator);
+	for (size_t n = 0; n < neighbours.size(); n++) {
+		auto it = std::find(nodeRanks.begin(), nodeRanks.end(), neighbours[n]);
+		if (it != nodeRanks.end()) {
+			nodeRank[n] = it - nodeRanks.begin();
+		}
+	}
+#endif
+
+	for (size_t n = 0; n < neighbours.size(); n++) {
+		if (nodeRank[n] == -1) {
+			_remote.push_back(n);
+		} else {
+			_local.push_back(n);
+		}
+	}
+
+	// buffers are indexed by '_offsets', parts of neighbours within node are unused
+	_sBuffer.resize(_indices.size());
+	_rBuffer.resize(_indices.size());
+	_requests.resize(2 * _remote.size());
+	for (size_t r = 0; r < _remote.size(); r++) {
+		size_t n = _remote[r];
+		MPI_Send_init(_sBuffer.data() + _offsets[n], _offsets[n + 1] - _offsets[n], MPI_DOUBLE, neighbours[n], 0, _communicator, _requests.data() + r);
+		MPI_Recv_init(_rBuffer.data() + _offsets[n], _offsets[n + 1] - _offsets[n], MPI_DOUBLE, neighbours[n], 0, _communicator, _requests.data() + _remote.size() + r);
+	}
+
+#if MPI_VERSION >= 3
+	for (size_t l = 0; l < _local.size(); l++) {
+		_localOffsets.push_back(_localSize);
+		_localSize += _offsets[_local[l] + 1] - _offsets[_local[l]];
+	}
+
+	char *base;
+	MPI_Win_allocate_shared(sizeof(Counters) + 2 * _localSize * sizeof(double), 1, MPI_INFO_NULL, node.communicator, &base, &_window);
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, _window);
+	_counters = reinterpret_cast<Counters*>(base);
+	_counters->published = _counters->consumed = 0;
+	_data = reinterpret_cast<double*>(base + sizeof(Counters));
+
+	// neighbours need to know where their lambdas are in my window
+	std::vector<size_t> sLayout(2 * _local.size()), rLayout(2 * _local.size());
+	std::vector<MPI_Request> requests(2 * _local.size());
+	for (size_t l = 0; l < _local.size(); l++) {
+		sLayout[2 * l] = _localOffsets[l];
+		sLayout[2 * l + 1] = _localSize;
+		MPI_Isend(sLayout.data() + 2 * l, 2 * sizeof(size_t), MPI_BYTE, neighbours[_local[l]], 0, _communicator, requests.data() + l);
+		MPI_Irecv(rLayout.data() + 2 * l, 2 * sizeof(size_t), MPI_BYTE, neighbours[_local[l]], 0, _communicator, requests.data() + _local.size() + l);
+	}
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+	for (size_t l = 0; l < _local.size(); l++) {
+		MPI_Aint size;
+		int unit;
+		char *neighbase;
+		MPI_Win_shared_query(_window, nodeRank[_local[l]], &size, &unit, &neighbase);
+		_neighCounters.push_back(reinterpret_cast<Counters*>(neighbase));
+		_neighData.push_back(reinterpret_cast<const double*>(neighbase + sizeof(Counters)) + rLayout[2 * l]);
+		_neighSize.push_back(rLayout[2 * l + 1]);
+	}
+
+	// counters have to be initialized before the first exchange
+	MPI_Win_sync(_window);
+	MPI_Barrier(node.communicator);
+#endif
+}
+
+void LambdaExchange::exchange(const std::vector<double> &x_in, std::vector<double> &y_out)
+{
+	++_exchanges;
+
+	if (_remote.size()) {
+		#pragma omp parallel for schedule(dynamic)
+		for (size_t r = 0; r < _remote.size(); r++) {
+			for (size_t i = _offsets[_remote[r]]; i < _offsets[_remote[r] + 1]; i++) {
+				_sBuffer[i] = x_in[_indices[i]];
+			}
+		}
+		MPI_Startall(_requests.size(), _requests.data());
+	}
+
+	writeShared(x_in);
+
+	if (&x_in != &y_out) {
+		y_out.resize(x_in.size());
+		#pragma omp parallel for
+		for (size_t i = 0; i < x_in.size(); i++) {
+			y_out[i] = x_in[i];
+		}
+	}
+
+	readShared(y_out);
+
+	if (_remote.size()) {
+		TimeEvent event("MPI wait for neighbours' lambdas");
+		event.startWithoutBarrier();
+		MPI_Waitall(_requests.size(), _requests.data(), MPI_STATUSES_IGNORE);
+		event.endWithoutBarrier();
+
+		// each lambda is shared with only one neighbour
+		#pragma omp parallel for schedule(dynamic)
+		for (size_t r = 0; r < _remote.size(); r++) {
+			for (size_t i = _offsets[_remote[r]]; i < _offsets[_remote[r] + 1]; i++) {
+				y_out[_indices[i]] += _rBuffer[i];
+			}
+		}
+	}
+}
+
+void LambdaExchange::writeShared(const std::vector<double> &x_in)
+{
+#if MPI_VERSION >= 3
+	if (_local.empty()) {
+		return;
+	}
+
+	// the half was read by neighbours two exchanges ago
+	for (size_t l = 0; l < _local.size(); l++) {
+		while (_neighCounters[l]->consumed < _exchanges - 2) {
+			MPI_Win_sync(_window);
+		}
+	}
+
+	double *half = _data + (_exchanges % 2) * _localSize;
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t l = 0; l < _local.size(); l++) {
+		double *data = half + _localOffsets[l];
+		for (size_t i = _offsets[_local[l]]; i < _offsets[_local[l] + 1]; i++) {
+			*data++ = x_in[_indices[i]];
+		}
+	}
+
+	MPI_Win_sync(_window);
+	_counters->published = _exchanges;
+	MPI_Win_sync(_window);
+#endif
+}
+
+void LambdaExchange::readShared(std::vector<double> &y_out)
+{
+#if MPI_VERSION >= 3
+	if (_local.empty()) {
+		return;
+	}
+
+	for (size_t l = 0; l < _local.size(); l++) {
+		while (_neighCounters[l]->published < _exchanges) {
+			MPI_Win_sync(_window);
+		}
+	}
+
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t l = 0; l < _local.size(); l++) {
+		const double *data = _neighData[l] + (_exchanges % 2) * _neighSize[l];
+		for (size_t i = _offsets[_local[l]]; i < _offsets[_local[l] + 1]; i++) {
+			y_out[_indices[i]] += *data++;
+		}
+	}
+
+	MPI_Win_sync(_window);
+	_counters->consumed = _exchanges;
+	MPI_Win_sync(_window);
+#endif
+}
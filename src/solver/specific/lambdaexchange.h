@@ -0,0 +1,68 @@
+
+#ifndef SRC_SOLVER_SPECIFIC_LAMBDAEXCHANGE_H_
+#define SRC_SOLVER_SPECIFIC_LAMBDAEXCHANGE_H_
+
+#include "mpi.h"
+
+#include <vector>
+
+namespace espreso {
+
+/**
+ * Exchange of lambdas shared with neighbouring processes (y = x + neighbours' x).
+ *
+ * The communication pattern is set up once.
+ * Processes on other nodes are reached by persistent requests.
+ * Processes on the same node read lambdas directly from a shared memory window.
+ * Each process writes its lambdas to one half of its window,
+ * while neighbours can still read the other half (filled in the previous exchange).
+ */
+class LambdaExchange {
+
+public:
+	LambdaExchange();
+	~LambdaExchange();
+
+	void init(const std::vector<eslocal> &neighbours, const std::vector<std::vector<eslocal> > &indices);
+	void exchange(const std::vector<double> &x_in, std::vector<double> &y_out);
+
+protected:
+	// the header of a shared window
+	struct Counters {
+		volatile long published; // number of exchanges with written lambdas
+		volatile long consumed; // number of exchanges with read neighbours' lambdas
+		char padding[64 - 2 * sizeof(long)];
+	};
+
+	void clear();
+	void writeShared(const std::vector<double> &x_in);
+	void readShared(std::vector<double> &y_out);
+
+	MPI_Comm _communicator;
+
+	std::vector<eslocal> _indices; // lambdas of all neighbours in one array
+	std::vector<size_t> _offsets; // offsets of neighbours in '_indices'
+
+	// neighbours on other nodes
+	std::vector<size_t> _remote;
+	std::vector<double> _sBuffer, _rBuffer;
+	std::vector<MPI_Request> _requests;
+
+	// neighbours on the same node
+	std::vector<size_t> _local;
+	MPI_Win _window;
+	Counters *_counters;
+	double *_data;
+	size_t _localSize; // size of one half of the window
+	std::vector<size_t> _localOffsets; // offsets to my window of neighbours' lambdas
+	std::vector<Counters*> _neighCounters;
+	std::vector<const double*> _neighData; // the first half of neighbours' windows with my lambdas
+	std::vector<size_t> _neighSize; // size of one half of neighbours' windows
+	long _exchanges;
+};
+
+}
+
+
+
+#endif /* SRC_SOLVER_SPECIFIC_LAMBDAEXCHANGE_H_ */
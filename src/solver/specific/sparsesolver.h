@@ -20,6 +20,15 @@ public:
 
 	virtual int Factorization(const std::string &str) = 0;
 	virtual void Clear() = 0;
+
+	// Factorize matrix A that has the same sparsity pattern as the previously factorized matrix.
+	// Solvers that are not able to reuse the symbolic factorization make the full factorization.
+	virtual int Refactorization(SparseMatrix & A, const std::string &str)
+	{
+		Clear();
+		ImportMatrix_wo_Copy(A);
+		return Factorization(str);
+	}
 	virtual void SetThreaded() = 0;
 
 
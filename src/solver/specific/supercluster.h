@@ -30,6 +30,8 @@ using std::make_pair;
 #include "../generic/SparseMatrix.h"
 #include "sparsesolvers.h"
 #include "clusters.h"
+#include "lambdaexchange.h"
+#include "domainscheduler.h"
 #include "../generic/utils.h"
 
 namespace espreso {
@@ -348,10 +350,58 @@ public:
 	map <eslocal,eslocal> my_lamdas_map_indices;
 
 	SEQ_VECTOR <eslocal>  my_lamdas_ddot_filter;
+	SEQ_VECTOR <double>   my_lamdas_ddot_mask; // the filter converted to doubles for vectorized kernels
 	SEQ_VECTOR <eslocal>  lambdas_filter;
 
 	SEQ_VECTOR <double> compressed_tmp;
 
+	LambdaExchange lambdaExchange;
+
+	// schedulers of per-domain loops (each loop has different costs of domains)
+	DomainScheduler kplus_scheduler, dual_scheduler, prec_scheduler;
+
+	// transposed 'lambda_map_sub_local' of all domains (sorted by domains)
+	// it allows to sum domains' values of a lambda to 'compressed_tmp' without write conflicts
+	SEQ_VECTOR <eslocal> lambda_gather_boundaries;
+	SEQ_VECTOR <eslocal> lambda_gather_domains;
+	SEQ_VECTOR <eslocal> lambda_gather_positions;
+
+	void SetupLambdaGather() {
+		lambda_gather_boundaries.clear();
+		lambda_gather_boundaries.resize(compressed_tmp.size() + 1, 0);
+		for (size_t d = 0; d < domains.size(); d++) {
+			for (size_t i = 0; i < domains[d]->lambda_map_sub_local.size(); i++) {
+				lambda_gather_boundaries[domains[d]->lambda_map_sub_local[i] + 1]++;
+			}
+		}
+		for (size_t l = 1; l < lambda_gather_boundaries.size(); l++) {
+			lambda_gather_boundaries[l] += lambda_gather_boundaries[l - 1];
+		}
+
+		SEQ_VECTOR <eslocal> filled(lambda_gather_boundaries.begin(), lambda_gather_boundaries.end() - 1);
+		lambda_gather_domains.resize(lambda_gather_boundaries.back());
+		lambda_gather_positions.resize(lambda_gather_boundaries.back());
+		for (size_t d = 0; d < domains.size(); d++) {
+			for (size_t i = 0; i < domains[d]->lambda_map_sub_local.size(); i++) {
+				eslocal index = filled[domains[d]->lambda_map_sub_local[i]]++;
+				lambda_gather_domains[index] = d;
+				lambda_gather_positions[index] = i;
+			}
+		}
+	}
+
+	// compressed_tmp[lambda] = sum of domains' compressed_tmp
+	void GatherDomainsLambdas() {
+		#pragma omp parallel for
+		for (size_t l = 0; l < compressed_tmp.size(); l++) {
+			double sum = 0;
+			for (eslocal i = lambda_gather_boundaries[l]; i < lambda_gather_boundaries[l + 1]; i++) {
+				sum += domains[lambda_gather_domains[i]]->compressed_tmp[lambda_gather_positions[i]];
+			}
+			compressed_tmp[l] = sum;
+		}
+	}
+
 	void SetupCommunicationLayer() {
 
 		SEQ_VECTOR <SEQ_VECTOR <eslocal> > & lambda_map_sub = instance->B1clustersMap;
@@ -383,6 +433,7 @@ public:
 				my_lamdas_ddot_filter[i] = 1.0;
 			}
 		}
+		my_lamdas_ddot_mask.assign(my_lamdas_ddot_filter.begin(), my_lamdas_ddot_filter.end());
 
 		ESLOG(MEMORY) << "Setting vectors for lambdas communicators";
 		ESLOG(MEMORY) << "process " << environment->MPIrank << " uses " << Measure::processMemory() << " MB";
@@ -413,10 +464,14 @@ public:
 		}
 		//// *** END - Create a vector of communication pattern needed for AllReduceLambdas function *
 
+		lambdaExchange.init(my_neighs, my_comm_lambdas_indices_comp);
+
 		// Temp buffer for dual buffers
 		compressed_tmp.resize( lambda_map_sub.size(), 0 );
 		dual_size = my_lamdas_indices.size();
 
+		SetupLambdaGather();
+
 	}
 
 	void compress_lambda_vector  ( SEQ_VECTOR <double> & decompressed_vec_lambda )
@@ -569,18 +624,16 @@ public:
 	}
 
 
-	void multKplusFETI(SEQ_VECTOR<SEQ_VECTOR<double> *> & x_in) {
-		#pragma omp parallel for
-		for (size_t d = 0; d < domains.size(); d++) {
+	void multKplusFETI(SEQ_VECTOR<SEQ_VECTOR<double> *> & x_in, TimeEval *eval = NULL) {
+		kplus_scheduler.run(domains.size(), [&] (size_t d) { return domains[d]->K.nnz; }, [&] (size_t d) {
 			domains[d]->multKplusLocal(*x_in[d]);
-		}
+		}, eval);
 	}
 
-	void multKplusFETI(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in) {
-		#pragma omp parallel for
-		for (size_t d = 0; d < domains.size(); d++) {
+	void multKplusFETI(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in, TimeEval *eval = NULL) {
+		kplus_scheduler.run(domains.size(), [&] (size_t d) { return domains[d]->K.nnz; }, [&] (size_t d) {
 			domains[d]->multKplusLocal(x_in[d]);
-		}
+		}, eval);
 	}
 
 	void multKplus(SEQ_VECTOR<SEQ_VECTOR<double> > & x_in) {